@@ -5,6 +5,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 /// Options:
 #include <string>
+#include <array>
 ////////////////////////////////////////////////////////////////////////////////
 #define ENABLE_DBG_ 0
 #include "misc/dbg.hpp"
@@ -162,16 +163,25 @@ template<SInd nd_> struct Implementation {
   ///                              can hold.
   /// \param [in] maxNoGridSolvers maximum number of solver grids that the
   ///                              container can store.
+  /// \param [in] noRootNodes      (optional) #of root nodes along each
+  ///                              direction (a forest of trees), defaults to
+  ///                              a single root node.
+  /// \param [in] periodic         (optional) is the forest periodic along
+  ///                              each direction? defaults to non-periodic.
   explicit Implementation(io::Properties input)
     : noActiveNodes_{0}
     , maxNoNodes_{io::read<Ind>(input, "maxNoGridNodes")}
     , lowerFreeNodeBound_{0}
+    , noRootNodes_{io::read_or<SIndA<nd>>(input, "noRootNodes",
+                                          SIndA<nd>::Constant(1))}
+    , periodic_{io::read_or<std::array<bool, nd>>(input, "periodic",
+                                                  std::array<bool, nd>{})}
     , parentIds_{this, "parents"}
     , childrenIds_{this, "childs"}
     , isFree_{this, "isFree"}
     , node2cells_{maxNoNodes_, io::read<SInd>(input, "maxNoGridSolvers")} {
     TRACE_IN_();
-    initialize_root_node_();
+    initialize_root_nodes_();
     TRACE_OUT();
   }
   Implementation() = delete;
@@ -237,7 +247,6 @@ template<SInd nd_> struct Implementation {
   inline bool active_(const NodeIdx nIdx) const noexcept
   { assert_valid(nIdx); return !isFree_(nIdx()); }
   /// \brief Is the node \p nIdx a root node?
-  /// (right now there is only a single root node)
   inline bool is_root(const NodeIdx nIdx) const noexcept
   { assert_valid(nIdx); return !is_valid(parent(nIdx)); }
   /// \brief Is node \p nIdx a leaf node?
@@ -253,9 +262,14 @@ template<SInd nd_> struct Implementation {
   { assert_valid(nIdx); return parentIds_(nIdx()); }
 
   /// \brief Child of \p nIdx at position \p pos
+  /// (invalid if \p nIdx is a leaf)
   inline NodeIdx child(const NodeIdx nIdx, const SInd pos) const noexcept {
     assert_valid(nIdx); assert_child_position(pos);
-    return childrenIds_(nIdx()) + NodeIdx{pos};
+    const auto firstChildIdx = child_(nIdx);
+    // a leaf's first child is invalid == numeric_limits<Ind>::max
+    // -> adding the position to it would wrap around
+    return is_valid(firstChildIdx) ? firstChildIdx + NodeIdx{pos}
+                                   : invalid<NodeIdx>();
   }
   /// \brief \f$\#\f$ of children of \p nIdx
   inline SInd no_childs(const NodeIdx nIdx) const noexcept
@@ -310,6 +324,76 @@ template<SInd nd_> struct Implementation {
   ///@}
   //////////////////////////////////////////////////////////////////////////////
 
+  //////////////////////////////////////////////////////////////////////////////
+  /// \name Forest of trees
+  ///
+  /// The container stores a Cartesian array of trees: the root nodes are the
+  /// first nodes of the container [0, no_root_nodes()), sorted in
+  /// lexicographic order of their Cartesian coordinates (x fastest).
+  ///@{
+
+  /// \brief \f$\#\f$ of root nodes along each direction
+  inline SIndA<nd> no_root_nodes_per_dir() const noexcept
+  { return noRootNodes_; }
+  /// \brief Total \f$\#\f$ of root nodes
+  inline Ind no_root_nodes() const noexcept
+  { return noRootNodes_.template cast<Ind>().prod(); }
+  /// \brief Range of root nodes
+  inline auto root_nodes() const noexcept -> Range<NodeIdx>
+  { return {node_begin(), NodeIdx{no_root_nodes()}}; }
+
+  /// \brief Cartesian coordinates (i, j, k) of the root node \p rIdx
+  SIndA<nd> root_coordinates(const NodeIdx rIdx) const noexcept {
+    ASSERT(rIdx() < no_root_nodes(), "node " << rIdx << " is not a root node");
+    SIndA<nd> ijk;
+    Ind idx = rIdx();
+    for (SInd d = 0; d != nd; ++d) {
+      ijk(d) = idx % noRootNodes_(d);
+      idx /= noRootNodes_(d);
+    }
+    return ijk;
+  }
+
+  /// \brief Root node at the Cartesian coordinates \p ijk (invalid if out
+  /// of the forest)
+  NodeIdx root_node(const SIndA<nd> ijk) const noexcept {
+    Ind idx = 0;
+    for (SInd d = nd - 1; d >= 0; --d) {
+      if (ijk(d) < 0 || ijk(d) >= noRootNodes_(d)) {
+        return invalid<NodeIdx>();
+      }
+      idx = idx * noRootNodes_(d) + ijk(d);
+    }
+    return NodeIdx{idx};
+  }
+
+  /// \brief Is the forest periodic along direction \p d?
+  inline bool is_periodic(const SInd d) const noexcept {
+    ASSERT(d >= 0 && d < nd, "direction " << d << " out of range!");
+    return periodic_[d];
+  }
+
+  /// \brief Neighbor of the root node \p rIdx at position \p nghbrPos (invalid
+  /// if the root node lies at a non-periodic forest boundary)
+  ///
+  /// Along periodic directions the forest wraps around, i.e. the neighbor
+  /// of the last root node is the first root node (which might be \p rIdx
+  /// itself if there is a single root node along that direction).
+  NodeIdx root_neighbor(const NodeIdx rIdx,
+                        const SInd nghbrPos) const noexcept {
+    assert_neighbor_position(nghbrPos);
+    SIndA<nd> ijk = root_coordinates(rIdx);
+    const auto d = neighbor_direction(nghbrPos);
+    ijk(d) += is_neighbor_at(nghbrPos, pos_dir) ? 1 : -1;
+    if (is_periodic(d)) {
+      ijk(d) = (ijk(d) + noRootNodes_(d)) % noRootNodes_(d);
+    }
+    return root_node(ijk);
+  }
+
+  ///@}
+  //////////////////////////////////////////////////////////////////////////////
+
   //////////////////////////////////////////////////////////////////////////////
   /// \name Modifying algorithms
   ///@{
@@ -325,6 +409,9 @@ template<SInd nd_> struct Implementation {
 
     const auto firstChildIdx = is_compact() ? node_end() : free_spot_();
     const auto lastChildIdx = firstChildIdx + NodeIdx{no_child_positions()};
+    ASSERT(lastChildIdx <= node_last(), "container out of memory!");
+    // slots before node_end() were freed by coarsen_node
+    const auto lastReusedIdx = std::min(lastChildIdx, node_end());
 
     no_nodes_() += no_child_positions();
     lowerFreeNodeBound_ += NodeIdx{no_child_positions()};
@@ -338,17 +425,15 @@ template<SInd nd_> struct Implementation {
     }
 
     ASSERT([&]() {
-      return all_of(Range<NodeIdx>(firstChildIdx, lastChildIdx),
-                    [&](const NodeIdx cIdx) { return !is_free(cIdx); }); }(),
-      "All future childrens must be free!");
-
-    ASSERT([&]() {
-      return all_of(Range<NodeIdx>(firstChildIdx, lastChildIdx),
-                    [&](const NodeIdx cIdx) { return !is_reseted(cIdx);} ); }(),
-      "All future childrens must be reseted!");
+      return firstChildIdx >= lastReusedIdx
+          || all_of(Range<NodeIdx>(firstChildIdx, lastReusedIdx),
+                    [&](const NodeIdx cIdx) {
+                      return is_free(cIdx) && !is_valid(parent(cIdx))
+                          && !is_valid(child_(cIdx)); }); }(),
+      "All reused children slots must be free and reseted!");
 
     child_(nIdx) = firstChildIdx;
-    for (const auto& childIdx : childs(nIdx)) {
+    for (const auto& childIdx : Range<NodeIdx>(firstChildIdx, lastChildIdx)) {
       parent_(childIdx) = nIdx;
       isFree_(childIdx()) = false;
     }
@@ -363,6 +448,36 @@ template<SInd nd_> struct Implementation {
     return firstChildIdx;
   }
 
+  /// \brief Coarsens node \p nIdx by removing all its children, which must be
+  /// leaf nodes, and returns \p nIdx.
+  ///
+  /// The children memory block is freed and reused by a later refine_node.
+  ///
+  /// \complexity O(#of child positions) amortized
+  NodeIdx coarsen_node(const NodeIdx nIdx) noexcept {
+    TRACE_IN((nIdx)); using namespace algorithm;
+    assert_active(nIdx);
+    ASSERT(!is_leaf(nIdx), "node " << nIdx << " has no children!");
+    ASSERT(no_childs(nIdx) == no_child_positions(),
+           "can only coarsen fully refined nodes!");
+    ASSERT(all_of(childs(nIdx), [&](const NodeIdx cIdx) {
+        return is_leaf(cIdx); }), "the children must be leaf nodes!");
+
+    const auto firstChildIdx = child_(nIdx);
+    const auto lastChildIdx = firstChildIdx + NodeIdx{no_child_positions()};
+    for (const auto& childIdx : Range<NodeIdx>(firstChildIdx, lastChildIdx)) {
+      reset_node_(childIdx);
+    }
+    child_(nIdx) = invalid<NodeIdx>();
+    no_nodes_() -= no_child_positions();
+    lowerFreeNodeBound_ = std::min(lowerFreeNodeBound_, firstChildIdx);
+    // shrink the active range past trailing free nodes
+    while (!empty() && is_free(node_end() - NodeIdx{1})) { --size_(); }
+    lowerFreeNodeBound_ = std::min(lowerFreeNodeBound_, node_end());
+    TRACE_OUT();
+    return nIdx;
+  }
+
   /// \brief Inserts a node into parent \p pIdx at position \p pos.
   ///
   /// \complexity O(1) if the tree is_compact()
@@ -453,6 +568,9 @@ template<SInd nd_> struct Implementation {
   /// need to traverse the tree up to the root and back down again).
   /// \todo Improve complexity and profile!
   ///
+  /// Neighbors across the faces of the trees in a forest are found by
+  /// continuing the down traversal in the neighboring tree.
+  ///
   /// \requires a balanced tree that satisfies 2:1 rule.
   NodeIdx find_samelvl_neighbor
   (const NodeIdx nIdx, const SInd nghbrPos) const noexcept {
@@ -460,11 +578,11 @@ template<SInd nd_> struct Implementation {
     DBG("start samelvl_neighbor | nIdx: ", nIdx, " | nghbrPos ", nghbrPos);
     assert_valid(nIdx); assert_active(nIdx); assert_neighbor_position(nghbrPos);
 
-    /// The root cell has no neighbors:
+    /// The neighbors of a root cell are the neighboring roots in the forest:
     if (is_root(nIdx)) {
-      DBG("nIdx ", nIdx, " is a root cell | no nghbr found in pos: ", nghbrPos);
+      DBG("nIdx ", nIdx, " is a root cell | root nghbr in pos: ", nghbrPos);
       TRACE_OUT();
-      return invalid<NodeIdx>();
+      return root_neighbor(nIdx, nghbrPos);
     }
 
     // Vector of traversed positions
@@ -495,23 +613,32 @@ template<SInd nd_> struct Implementation {
 
       if (is_root(pIdx)) {
         /// If the parent is the root and there is no sibling in direction
-        /// "nbghrPos", cell has no neighbor and we are done
-        DBG("parent is root, and no sibling in direction found!",
-            "-> nghbr not found for nIdx: ", nIdx, ", nghbrPos: ", nghbrPos);
-        TRACE_OUT();
-        return invalid<NodeIdx>();
+        /// "nbghrPos", the neighbor is in the neighboring tree. If there is
+        /// no neighboring tree, cell has no neighbor and we are done
+        const auto nghbrRootIdx = root_neighbor(pIdx, nghbrPos);
+        if (!is_valid(nghbrRootIdx)) {
+          DBG("parent is root, and no sibling in direction found!",
+              "-> nghbr not found for nIdx: ", nIdx, ", nghbrPos: ", nghbrPos);
+          TRACE_OUT();
+          return invalid<NodeIdx>();
+        }
+        DBG("parent is root, continuing in the neighboring tree: ",
+            nghbrRootIdx);
+        traversedPositions.emplace_back(posInParent);
+        currentNode = nghbrRootIdx;
+        break;
       } else {
         /// Keep on going up the tree
         traversedPositions.emplace_back(posInParent);
         currentNode = pIdx;
       }
     }
-    ASSERT(commonParentFound, "No common parent has been found!");
-
-    /// This is the opposite node at the common parent:
-    currentNode = child(parent(currentNode),
-                        rel_sibling_position(position_in_parent(currentNode),
-                                             nghbrPos));
+    if (commonParentFound) {
+      /// This is the opposite node at the common parent:
+      currentNode = child(parent(currentNode),
+                          rel_sibling_position(position_in_parent(currentNode),
+                                               nghbrPos));
+    }
 
     DBG("starting down traversal at node: ", currentNode);
     /// Traverse the tree back from the opposite node in opposite order to find
@@ -770,6 +897,9 @@ template<SInd nd_> struct Implementation {
 
   NodeIdx lowerFreeNodeBound_;  ///< Smallest free node id
 
+  SIndA<nd> noRootNodes_;  ///< \f$\#\f$ of root nodes along each direction
+  std::array<bool, nd> periodic_;  ///< Is the forest periodic along each dir.?
+
   //////////////////////////////////////////////////////////////////////////////
   /// \name Node Data
   ///@{
@@ -842,16 +972,20 @@ template<SInd nd_> struct Implementation {
   /// \name Initialization routines
   ///@{
 
-  /// \brief Creates an initial root node
+  /// \brief Creates the initial root nodes
   ///
   /// \warning The container must be empty!
-  void initialize_root_node_() {
+  void initialize_root_nodes_() {
     TRACE_IN_();
     ASSERT(empty(), "Container is not empty!");
-    ++size_(); ++no_nodes_();
-    isFree_(node_begin()()) = false;  // activate node before reseting it
-    reset_node_(node_begin());
-    isFree_(node_begin()()) = false;
+    ASSERT((noRootNodes_.array() > 0).all(), "#of root nodes must be > 0!");
+    ASSERT(no_root_nodes() <= capacity(), "not enough capacity for the roots!");
+    for (const auto rIdx : root_nodes()) {
+      ++size_(); ++no_nodes_();
+      isFree_(rIdx()) = false;  // activate node before reseting it
+      reset_node_(rIdx);
+      isFree_(rIdx()) = false;
+    }
     TRACE_OUT();
   }
 
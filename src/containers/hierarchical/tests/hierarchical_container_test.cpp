@@ -54,6 +54,32 @@ TEST(hierarchical_container_test, test_write_grid_domain_3d) {
   write_domain("grid_3D", small3DGrid);
 }
 
+/// \test coarsened nodes are freed and reused by later refinements
+TEST(hierarchical_container_test, test_coarsen_node) {
+  grid::Grid<2> grid(small_grid<2>(3), grid::initialize);
+  const auto noNodes = grid.no_nodes();
+  const auto size = grid.size();
+
+  const auto nIdx = grid.parent(grid.find_leaf(NumA<2>{0.3, 0.3}));
+  const auto firstChild = grid.child(nIdx, 0);
+  EXPECT_EQ(grid.coarsen_node(nIdx), nIdx);
+  EXPECT_TRUE(grid.is_leaf(nIdx));
+  EXPECT_EQ(grid.no_nodes(), noNodes - grid.no_child_positions());
+  EXPECT_EQ(grid.size(), size);
+  EXPECT_EQ(grid.refine_node(nIdx), firstChild);
+  EXPECT_EQ(grid.no_nodes(), noNodes);
+  consistency_nghbr_check(grid);
+
+  // freeing the last nodes shrinks the container
+  const auto lastIdx = grid.parent(NodeIdx{size - 1});
+  grid.coarsen_node(lastIdx);
+  EXPECT_EQ(grid.size(), size - grid.no_child_positions());
+  EXPECT_EQ(grid.refine_node(lastIdx),
+            NodeIdx{size - grid.no_child_positions()});
+  EXPECT_EQ(grid.size(), size);
+  consistency_nghbr_check(grid);
+}
+
 /// \test tests childs ranges
 TEST(hierarchical_container_test, test_childs_range) {
   // test childs of root node
@@ -278,6 +304,85 @@ TEST(hierarchical_container_test, test_2D_strict_samelvl_nghbrs) {
   }
 }
 
+/// \test forest of trees: a [0,2]x[0,1] domain is covered by two root cells
+/// and same-level neighbors are found across the faces between them
+TEST(hierarchical_container_test, test_2D_forest_samelvl_nghbrs) {
+  using Boundaries = typename grid::Grid<2>::Boundaries;
+  Boundaries boundaries;
+  auto properties  = grid::helpers::cube::properties<2>
+      ({NumA<2>{0., 0.}, NumA<2>{2., 1.}}, 1);
+  io::insert_property<Boundaries>(properties, "boundaries", boundaries);
+  grid::Grid<2> forest(properties, grid::initialize);
+
+  EXPECT_EQ(forest.no_root_nodes(), Ind{2});
+  EXPECT_EQ(forest.size(), Ind{10});
+  EXPECT_EQ(forest.root_node(SIndA<2>{1, 0}), NodeIdx{1});
+  EXPECT_FALSE(is_valid(forest.root_node(SIndA<2>{2, 0})));
+  EXPECT_DOUBLE_EQ(forest.cell_coordinates(NodeIdx{1})(0), 1.5);
+  EXPECT_DOUBLE_EQ(forest.cell_coordinates(NodeIdx{1})(1), 0.5);
+
+  consistency_nghbr_check(forest);
+
+  auto eIdx = invalid<Ind>();
+  auto nodeNghbrs = std::vector<nghbrIds<2>>({
+    { 0, {{ eIdx,    1, eIdx, eIdx }}},
+    { 1, {{    0, eIdx, eIdx, eIdx }}},
+    { 2, {{ eIdx,    3, eIdx,    4 }}},
+    { 3, {{    2,    6, eIdx,    5 }}},
+    { 4, {{ eIdx,    5,    2, eIdx }}},
+    { 5, {{    4,    8,    3, eIdx }}},
+    { 6, {{    3,    7, eIdx,    8 }}},
+    { 7, {{    6, eIdx, eIdx,    9 }}},
+    { 8, {{    5,    9,    6, eIdx }}},
+    { 9, {{    8, eIdx,    7, eIdx }}}
+  });
+
+  for (auto nghbrs : nodeNghbrs) {
+    for (auto pos : forest.neighbor_positions()) {
+      EXPECT_EQ(NodeIdx{nghbrs.nghbrs[pos]},
+                forest.find_samelvl_neighbor(NodeIdx{nghbrs.nId}, pos));
+    }
+  }
+}
+
+/// \test periodic forest: same-level neighbors wrap around the periodic faces
+TEST(hierarchical_container_test, test_2D_periodic_samelvl_nghbrs) {
+  using Boundaries = typename grid::Grid<2>::Boundaries;
+  Boundaries boundaries;
+  auto properties  = grid::helpers::cube::properties<2>
+      ({NumA<2>{0., 0.}, NumA<2>{1., 1.}}, 1, 1, {{true, false}});
+  io::insert_property<Boundaries>(properties, "boundaries", boundaries);
+  grid::Grid<2> periodic(properties, grid::initialize);
+
+  EXPECT_TRUE(periodic.is_periodic(0));
+  EXPECT_FALSE(periodic.is_periodic(1));
+  EXPECT_EQ(periodic.size(), Ind{5});
+
+  consistency_nghbr_check(periodic);
+
+  auto eIdx = invalid<Ind>();
+  auto nodeNghbrs = std::vector<nghbrIds<2>>({
+    { 0, {{    0,    0, eIdx, eIdx }}},
+    { 1, {{    2,    2, eIdx,    3 }}},
+    { 2, {{    1,    1, eIdx,    4 }}},
+    { 3, {{    4,    4,    1, eIdx }}},
+    { 4, {{    3,    3,    2, eIdx }}}
+  });
+
+  for (auto nghbrs : nodeNghbrs) {
+    for (auto pos : periodic.neighbor_positions()) {
+      EXPECT_EQ(NodeIdx{nghbrs.nghbrs[pos]},
+                periodic.find_samelvl_neighbor(NodeIdx{nghbrs.nId}, pos));
+    }
+  }
+
+  // displacements across the periodic faces use the closest periodic image:
+  const NumA<2> dx = periodic.displacement(NumA<2>{0.9, 0.9},
+                                           NumA<2>{0.1, 0.1});
+  EXPECT_NEAR(dx(0),  0.2, 1e-14);
+  EXPECT_NEAR(dx(1), -0.8, 1e-14);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 #undef ENABLE_DBG_
 ////////////////////////////////////////////////////////////////////////////////
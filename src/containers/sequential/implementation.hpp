@@ -252,6 +252,8 @@ template<class Cells> struct Implementation {
   /// \brief Removes last \p i cells from the container
   inline void pop_cell(const cell_size_type i = 1) noexcept
   { pop_cell_(i, container_type()); }
+  /// \brief Removes all cells (and nodes) from the container
+  inline void clear() noexcept { clear_(container_type()); }
   ///@}
 
   /// \name Append/delete nodes
@@ -424,6 +426,14 @@ template<class Cells> struct Implementation {
     size_() -= i;
   }
 
+  void clear_(tag::fixed_nodes) noexcept { size_() = 0; }
+
+  void clear_(tag::variable_nodes) noexcept {
+    size_() = 0;
+    node_size_() = 0;
+    first_node_() = 0;
+  }
+
   /// \brief Shifts node range ["fromNIdx","toNIdx") up "steps" times
   ///
   /// \warning Overwrites nodes in ["fromNIdx-steps","fromNIdx") !
@@ -6,8 +6,11 @@
 /// \todo Replace warnings by compile-time/run-time assertions
 ////////////////////////////////////////////////////////////////////////////////
 /// Includes:
+#include <cmath>
 #include <limits>
 #include <algorithm>
+#include <numeric>
+#include <array>
 #include <vector>
 #include "globals.hpp"
 #include "containers/hierarchical.hpp"
@@ -103,39 +106,49 @@ static constexpr std::array<SInt,8*3> vertex_pos_3d_arr {{
     }};
 ///@}
 
+/// \brief Root cells of the grid
+///
+/// The domain [min, max] is covered by a Cartesian array of square shaped root
+/// cells (a forest of trees). The root cells' length is the smallest extent
+/// of the domain, which must be an integer multiple of it along every other
+/// direction (e.g. a 10:1 channel is covered by 10x1 root cells).
 template<int nd> struct RootCell {
   RootCell(const RootCell<nd>&) = default;
   RootCell(const NumA<nd>& min, const NumA<nd>& max) : length(math::eps) {
-    ASSERT([&](){
-      NumA<nd> lengths = max - min;
-      Num previous_length = lengths(0);
-      for (SInd d = 1; d != nd; ++d) {
-        ASSERT(math::approx(lengths(d), previous_length),
-          "Error length mismatch between dimensions d = "
-          + std::to_string(d - 1) + " (x_min = " + std::to_string(min(d - 1))
-          + ", x_max = " + std::to_string(max(d - 1))
-          + ", length = " + std::to_string(lengths(d - 1)) + "),"
-          + " and d = " + std::to_string(d) + " (x_min = " + std::to_string(min(d))
-          + ", x_max = " + std::to_string(max(d))
-          + ", length = " + std::to_string(lengths(d)) + ")."
-          + " Root cell is not square shaped!");
-        }
-        return true;
-      }(), "Root cell must be square shaped!");
-
+    const NumA<nd> lengths = max - min;
+    ASSERT((lengths.array() > math::eps).all(), "Negative length not allowed!");
+    length = lengths.minCoeff();
     for (SInd d = 0; d != nd; ++d) {
-      const Num lengthD = max(d) - min(d); // move up! length( (max-min).max() )
-      ASSERT(lengthD > math::eps, "Negative length not allowed!");
-      length = std::max(length, lengthD);
-      coordinates(d) = min(d) + 0.5 * lengthD; // move up! coords( min + 0.5 * length)
+      noRoots(d) = std::lround(lengths(d) / length);
+      ASSERT(math::approx(noRoots(d) * length, lengths(d)),
+        "Error length mismatch between dimensions: the length along d = "
+        + std::to_string(d) + " (x_min = " + std::to_string(min(d))
+        + ", x_max = " + std::to_string(max(d))
+        + ", length = " + std::to_string(lengths(d)) + ") is not an integer"
+        + " multiple of the root cell length " + std::to_string(length) + "!");
+      coordinates(d) = min(d) + 0.5 * lengths(d);
     }
   }
 
   static const int nDim = nd;
+  /// Length of each root cell
   Num length;
+  /// Centroid of the domain
   NumA<nd> coordinates;
-  NumA<nd> x_min() const noexcept { return coordinates.array() - 0.5 * length; }
-  NumA<nd> x_max() const noexcept { return coordinates.array() + 0.5 * length; }
+  /// #of root cells along each direction
+  SIndA<nd> noRoots;
+  /// Extent of the domain along each direction
+  NumA<nd> lengths() const noexcept
+  { return noRoots.template cast<Num>() * length; }
+  NumA<nd> x_min() const noexcept
+  { return coordinates.array() - 0.5 * lengths().array(); }
+  NumA<nd> x_max() const noexcept
+  { return coordinates.array() + 0.5 * lengths().array(); }
+  /// Centroid of the root cell at the Cartesian coordinates \p ijk
+  NumA<nd> coordinates_of(const SIndA<nd> ijk) const noexcept {
+    return x_min().array()
+        + (ijk.template cast<Num>().array() + 0.5) * length;
+  }
 };
 
 /// \brief Hierarchical Cartesian Grid data-structure
@@ -170,7 +183,7 @@ template <SInd nd_> struct CartesianHSP : container::Hierarchical<nd_> {
 
   /// \brief Construct a grid from a set of input properties
   CartesianHSP(io::Properties input)
-      : container::Hierarchical<nd>(input)
+      : container::Hierarchical<nd>(with_root_nodes_(input))
       , properties_(input)
       , rootCell_(io::read<RootCell<nd>>(properties_,"rootCell"))
       , ready_(false)
@@ -352,7 +365,7 @@ template <SInd nd_> struct CartesianHSP : container::Hierarchical<nd_> {
 
   /// \brief Centroid coordinates of cell at node \p nIdx
   ///
-  /// Note: the coordinates are computed from the root cell's coordinates.
+  /// Note: the coordinates are computed from the root cells' coordinates.
   /// \complexity O(L) - linear in the number of levels.
   /// \complexity O(logN) - logarithmic in the number of cells.
   NumA<nd> cell_coordinates(const NodeIdx nIdx) const {
@@ -369,7 +382,7 @@ template <SInd nd_> struct CartesianHSP : container::Hierarchical<nd_> {
       return relativePosition;
     } else {
       TRACE_OUT();
-      return rootCell_.coordinates;
+      return rootCell_.coordinates_of(this->root_coordinates(nIdx));
     }
   }
 
@@ -389,6 +402,63 @@ template <SInd nd_> struct CartesianHSP : container::Hierarchical<nd_> {
     return x_nghbr;
   }
 
+  /// \brief Displacement vector from \p x_from to \p x_to
+  ///
+  /// Along periodic directions the shortest displacement across the periodic
+  /// faces of the domain is returned (minimum image convention).
+  NumA<nd> displacement(const NumA<nd>& x_from,
+                        const NumA<nd>& x_to) const noexcept {
+    NumA<nd> dx = x_to - x_from;
+    const NumA<nd> lengths = rootCell_.lengths();
+    for (auto d : dimensions()) {
+      if (!this->is_periodic(d)) { continue; }
+      dx(d) -= lengths(d) * std::round(dx(d) / lengths(d));
+    }
+    return dx;
+  }
+
+  /// \brief Leaf node containing the point \p x (invalid if \p x lies
+  /// outside the domain)
+  ///
+  /// The root cell containing \p x is computed directly from the root cell
+  /// lattice, then the tree is descended choosing at each level the child
+  /// whose octant contains \p x. Along periodic directions \p x is mapped
+  /// back into the domain. Points lying exactly on a face between two cells
+  /// are located in the cell on the positive side.
+  ///
+  /// \complexity O(L) - linear in the number of levels.
+  NodeIdx find_leaf(NumA<nd> x) const noexcept {
+    const NumA<nd> x_min = rootCell_.x_min();
+    const NumA<nd> lengths = rootCell_.lengths();
+    SIndA<nd> ijk;
+    for (auto d : dimensions()) {
+      Num xr = x(d) - x_min(d);
+      if (this->is_periodic(d)) {
+        xr -= lengths(d) * std::floor(xr / lengths(d));
+        x(d) = x_min(d) + xr;
+      }
+      if (xr < 0. || xr > lengths(d)) { return invalid<NodeIdx>(); }
+      ijk(d) = std::min(static_cast<SInd>(std::floor(xr / rootCell_.length)),
+                        rootCell_.noRoots(d) - 1);
+    }
+
+    auto nIdx = this->root_node(ijk);
+    NumA<nd> x_c = rootCell_.coordinates_of(ijk);
+    Num length = rootCell_.length;
+    while (this->has_children(nIdx)) {
+      SInd childPos = 0;
+      for (auto d : dimensions()) {
+        if (x(d) >= x_c(d)) { childPos += 1 << d; }
+      }
+      ASSERT(this->has_all_children(nIdx), "node " << nIdx << " is not"
+             << " completely refined!");
+      nIdx = this->child(nIdx, childPos);
+      x_c += child_rel_pos(childPos).template cast<Num>() * 0.25 * length;
+      length *= 0.5;
+    }
+    return nIdx;
+  }
+
   /// \todo rename cell_id to node_id
   struct CellVertices {
     static constexpr SInd no_vertices() {  /// \todo refactor! (see grid)
@@ -539,6 +609,27 @@ template <SInd nd_> struct CartesianHSP : container::Hierarchical<nd_> {
     return boundaryCells;
   }
 
+  /// \brief Indices of the \p solverIdx 's boundaries within boundaries()
+  ///
+  /// Note: the indices are sorted in the order in which the boundaries were
+  /// appended, i.e. they correspond to the solver's boundary conditions.
+  std::vector<SInd> boundary_ids(const SolverIdx solverIdx) const {
+    std::vector<SInd> ids;
+    for (SInd bIdx = 0, e = boundaries_.size(); bIdx != e; ++bIdx) {
+      if (boundaries_[bIdx].solver_idx() == solverIdx) { ids.push_back(bIdx); }
+    }
+    return ids;
+  }
+
+  /// \brief Filters those nodes cut by the boundary \p boundaryIdx
+  ///
+  /// Note: uses the distance field if the boundary has been sampled
+  inline auto cut_by_boundary(const SInd boundaryIdx) -> RangeFilter<NodeIdx> {
+    return {[&, boundaryIdx](const NodeIdx nIdx) {
+        return is_cut_by_boundary(nIdx, boundaryIdx);
+    }};
+  }
+
   /// \brief Filters those nodes cut by the \p boundary .
   template<class Boundary>
   inline auto cut_by_boundary(Boundary&& boundary) -> RangeFilter<NodeIdx> {
@@ -582,18 +673,113 @@ template <SInd nd_> struct CartesianHSP : container::Hierarchical<nd_> {
   }
 
   /// \brief EXPERIMENTAL
+  ///
+  /// Note: reads the distance field if all boundaries have been sampled, the
+  /// result is then clamped outside of the narrow band (see signed_distance).
   Num level_set(const NodeIdx nIdx) const {
+    if (has_distance_field()) {
+      return distanceField_.row(nIdx()).minCoeff();
+    }
     const NumA<nd> x = cell_coordinates(nIdx);
     return level_set(x);
   }
 
   /// \brief EXPERIMENTAL
   Num level_set(const NumA<nd> x) const {
-    Num tmp = std::numeric_limits<Num>::max();
-    for(const auto& ls : boundaries_) {
-      tmp = std::min(tmp,ls.signed_distance(x));
+    return closest_boundary(x).distance;
+  }
+
+  /// \brief Signed distance to, and index of, the closest boundary
+  struct ClosestBoundary {
+    Num distance;      ///< Minimum signed distance over all boundaries
+    SInd boundaryIdx;  ///< Index of the boundary with minimum distance
+  };
+
+  /// \brief Closest boundary of the subset \p boundaryIds for each point of
+  /// the range \p xs
+  ///
+  /// All boundaries are evaluated for the whole batch of points in a single
+  /// pass (one boundary at a time, such that each boundary's signed-distance
+  /// function stays hot).
+  ///
+  /// \returns for each point the minimum signed distance and the position
+  /// within \p boundaryIds of the boundary that attains it (or
+  /// invalid<SInd>() if \p boundaryIds is empty)
+  template<class Points>
+  std::vector<ClosestBoundary> closest_boundary
+  (const Points& xs, const std::vector<SInd>& boundaryIds) const {
+    std::vector<ClosestBoundary> result
+      (std::distance(std::begin(xs), std::end(xs)),
+       {std::numeric_limits<Num>::max(), invalid<SInd>()});
+    for (SInd i = 0, e = boundaryIds.size(); i != e; ++i) {
+      const auto& signed_distance = boundaries_[boundaryIds[i]].signed_distance;
+      auto r = std::begin(result);
+      for (const auto& x : xs) {
+        const Num distance = signed_distance(x);
+        if (distance < r->distance) { *r = {distance, i}; }
+        ++r;
+      }
     }
-    return tmp;
+    return result;
+  }
+
+  /// \brief Closest boundary of all boundaries for each point of the range
+  /// \p xs
+  template<class Points>
+  std::vector<ClosestBoundary> closest_boundary(const Points& xs) const {
+    return closest_boundary(xs, all_boundary_ids_());
+  }
+
+  /// \brief Closest boundary of all boundaries to the point \p x
+  ClosestBoundary closest_boundary(const NumA<nd>& x) const {
+    return closest_boundary(std::array<NumA<nd>, 1>{{x}}).front();
+  }
+
+  /// \brief Closest boundary of the subset \p boundaryIds to the centroid of
+  /// node \p nIdx
+  ///
+  /// \complexity O(#of boundaries) lookups if the boundaries have been sampled
+  /// in the distance field (the distances are then clamped outside of the
+  /// narrow band, see signed_distance)
+  ClosestBoundary closest_boundary(const NodeIdx nIdx,
+                                   const std::vector<SInd>& boundaryIds) const {
+    auto is_sampled = [&](const SInd bIdx) { return has_distance_field(bIdx); };
+    if (std::all_of(std::begin(boundaryIds), std::end(boundaryIds),
+                    is_sampled)) {
+      ClosestBoundary result{std::numeric_limits<Num>::max(), invalid<SInd>()};
+      for (SInd i = 0, e = boundaryIds.size(); i != e; ++i) {
+        const Num distance = signed_distance(nIdx, boundaryIds[i]);
+        if (distance < result.distance) { result = {distance, i}; }
+      }
+      return result;
+    }
+    return closest_boundary
+      (std::array<NumA<nd>, 1>{{cell_coordinates(nIdx)}}, boundaryIds).front();
+  }
+
+  /// \brief Signed distance from the centroids of all nodes to each boundary:
+  /// (#of nodes, #of boundaries)
+  ///
+  /// The distances are exact, i.e. not clamped to the narrow band of the
+  /// distance field: all boundaries are evaluated in a single pass over the
+  /// nodes.
+  EigenDynColMajor<Num> node_boundary_distances() const {
+    const Ind noNodes = this->size();
+    const SInd noBoundaries = boundaries_.size();
+    EigenDynColMajor<Num> distances(noNodes, noBoundaries);
+    std::vector<NodeIdx> ids;
+    NumAV<nd> xs;
+    for (auto nIdx : nodes()) {
+      ids.push_back(nIdx);
+      xs.push_back(cell_coordinates(nIdx));
+    }
+    for (SInd bIdx = 0; bIdx != noBoundaries; ++bIdx) {
+      const auto& signed_distance = boundaries_[bIdx].signed_distance;
+      for (Ind i = 0, e = ids.size(); i != e; ++i) {
+        distances(ids[i](), bIdx) = signed_distance(xs[i]);
+      }
+    }
+    return distances;
   }
 
   /// \brief EXPERIMENTAL
@@ -632,31 +818,118 @@ template <SInd nd_> struct CartesianHSP : container::Hierarchical<nd_> {
     });
   }
 
+  /// \brief Is node \p nIdx cut by the boundary \p boundaryIdx ?
+  ///
+  /// \complexity O(1) if the boundary has been sampled in the distance field
+  bool is_cut_by_boundary(const NodeIdx nIdx, const SInd boundaryIdx) const {
+    if (has_distance_field(boundaryIdx)) {
+      return isCutField_(nIdx(), boundaryIdx);
+    }
+    return is_cut_by(compute_cell_vertices(nIdx), boundaryIdx);
+  }
+
   /// \brief EXPERIMENTAL
   bool is_cut_by_levelset(const NodeIdx nIdx) {
+    if (has_distance_field()) {
+      // the level set is also 1-Lipschitz: if the distance of its centroid to
+      // the boundary is larger than half its diagonal, the cell can't be cut.
+      const Num phi = level_set(nIdx);
+      if (std::abs(phi) > half_diagonal_(cell_length(nIdx))) { return false; }
+    }
     return is_cut_by(nIdx,[&](const NumA<nd> x){ return level_set(x); });
   }
 
   /// \brief EXPERIMENTAL
   std::vector<SInd> is_cut_by_boundaries(const NodeIdx nIdx) {
     std::vector<SInd> result;
-    SInd i = 0;
-    for(auto b : boundaries()) {
-      if(is_cut_by(nIdx,[&](const NumA<nd> x){ return b.signed_distance(x); })) {
-        result.push_back(i);
-      }
-      ++i;
+    for (SInd bIdx = 0, e = boundaries_.size(); bIdx != e; ++bIdx) {
+      if (is_cut_by_boundary(nIdx, bIdx)) { result.push_back(bIdx); }
     }
     return result;
   }
 
   ///@}
 
+  /// \name Narrow-band signed-distance field
+  ///
+  /// The signed distance of each boundary is sampled once at the centroid of
+  /// every grid node, such that later geometric queries (level set, cut cell
+  /// detection, ghost cell positions) are array lookups.
+  ///
+  /// The field is built by a top-down traversal of the trees starting at the
+  /// root cells: a node is evaluated exactly if its centroid lies within the
+  /// narrow band, i.e. if it is closer to the boundary than half its diagonal
+  /// plus \p bandWidth times its length. The subtrees of nodes outside the band
+  /// are not evaluated: since the signed-distance functions are 1-Lipschitz,
+  /// their distance is larger than their band, and they store the correct sign
+  /// and the band width. All samples outside of a node's band are clamped to
+  /// it, such that distances compare correctly within the band.
+  ///
+  /// \complexity O(#of nodes within the band * #of levels) evaluations of the
+  /// signed-distance functions, O(1) queries.
+  ///
+  /// \warning The field is not updated when the grid is modified, it has to be
+  /// cleared (see clear_distance_field) and sampled again.
+  ///@{
+
+  /// \brief Samples the boundaries that haven't been sampled yet
+  void update_distance_field(const Num bandWidth = 2.) {
+    TRACE_IN((bandWidth));
+    const SInd noSampledBoundaries = distanceField_.cols();
+    const SInd noBoundaries = boundaries_.size();
+    if (noSampledBoundaries == noBoundaries) { TRACE_OUT(); return; }
+    ASSERT(noSampledBoundaries < noBoundaries, "boundaries have been removed!");
+
+    distanceField_.conservativeResize(this->capacity(), noBoundaries);
+    isCutField_.conservativeResize(this->capacity(), noBoundaries);
+    for (SInd bIdx = noSampledBoundaries; bIdx != noBoundaries; ++bIdx) {
+      for (const auto rIdx : this->root_nodes()) {
+        sample_distance_field_(rIdx, cell_coordinates(rIdx), rootCell_.length,
+                               bIdx, bandWidth,
+                               std::numeric_limits<Num>::quiet_NaN());
+      }
+    }
+    TRACE_OUT();
+  }
+
+  /// \brief Removes all samples from the distance field
+  void clear_distance_field() noexcept {
+    distanceField_.resize(0, 0);
+    isCutField_.resize(0, 0);
+  }
+
+  /// \brief Has the boundary \p boundaryIdx been sampled?
+  inline bool has_distance_field(const SInd boundaryIdx) const noexcept {
+    return boundaryIdx < distanceField_.cols();
+  }
+
+  /// \brief Have all boundaries been sampled?
+  inline bool has_distance_field() const noexcept {
+    return !boundaries_.empty()
+        && distanceField_.cols() == static_cast<Ind>(boundaries_.size());
+  }
+
+  /// \brief Signed distance from the centroid of node \p nIdx to the
+  /// boundary \p boundaryIdx
+  ///
+  /// \returns the exact distance within the narrow band of the node, i.e. if
+  /// it is at most half its diagonal plus bandWidth times its length, and that
+  /// band width with the correct sign outside of it
+  ///
+  /// \complexity O(1)
+  inline Num signed_distance(const NodeIdx nIdx,
+                             const SInd boundaryIdx) const noexcept {
+    ASSERT(has_distance_field(boundaryIdx), "boundary hasn't been sampled!");
+    return distanceField_(nIdx(), boundaryIdx);
+  }
+
+  ///@}
+
   /// \brief
   /// \todo unused / deprecate?
   inline bool is_ready() const { return ready_; }
 
-  /// \brief Root cell
+  /// \brief Root cell(s)
   RootCell<nd> root_cell() const noexcept { return rootCell_; }
 
   friend void write_domain(const This& grid) {
@@ -666,6 +939,9 @@ template <SInd nd_> struct CartesianHSP : container::Hierarchical<nd_> {
   /// \todo take grid by const reference instead of pointer (requires changes to
   /// io::Vtk!)
   friend void write_domain(const String fName, const This& grid) {
+    // all boundaries are evaluated in a single pass before writing, the
+    // streams are written when out is destroyed:
+    const auto distances = grid.node_boundary_distances();
     io::Vtk<nd, io::format::ascii> out(&grid, fName, io::precision::standard());
 
     out << io::stream("nodeIds", 1, [](const Ind nIdx, const SInd) {
@@ -681,9 +957,17 @@ template <SInd nd_> struct CartesianHSP : container::Hierarchical<nd_> {
         return grid.has_solver(NodeIdx{nIdx}, SolverIdx{pos}) ?
                pos : invalid<SInd>();
     });
-    for(const auto& i : grid.boundaries()) {
-      out << io::stream(i.name(), 1, [&](const Ind nIdx, const SInd) {
-        return i.signed_distance(grid.cell_coordinates(NodeIdx{nIdx}));
+    for (SInd bIdx = 0, e = grid.boundaries().size(); bIdx != e; ++bIdx) {
+      out << io::stream(grid.boundaries()[bIdx].name(), 1,
+                        [&, bIdx](const Ind nIdx, const SInd) {
+        return distances(nIdx, bIdx);
+      });
+    }
+    if (!grid.boundaries().empty()) {
+      out << io::stream("closestBoundary", 1, [&](const Ind nIdx, const SInd) {
+        Ind bIdx;
+        distances.row(nIdx).minCoeff(&bIdx);
+        return bIdx;
       });
     }
   }
@@ -704,9 +988,73 @@ template <SInd nd_> struct CartesianHSP : container::Hierarchical<nd_> {
   /// Grid generator
   std::function<void(This&)> meshGeneration_;
 
+  /// Narrow-band signed-distance field: (#of nodes, #of sampled boundaries)
+  EigenDynColMajor<Num> distanceField_;
+  /// Is node cut by boundary? (#of nodes, #of sampled boundaries)
+  EigenDynColMajor<bool> isCutField_;
+
   /// Is the grid ready to use ?
   bool ready_;
 
+  /// \brief Adds the #of root nodes along each direction of the properties'
+  /// root cell to the \p input properties
+  static io::Properties with_root_nodes_(io::Properties input) {
+    const auto rootCell = io::read<RootCell<nd>>(input, "rootCell");
+    io::insert<SIndA<nd>>(input, "noRootNodes", rootCell.noRoots);
+    return input;
+  }
+
+  /// \name Distance field: implementation details
+  ///@{
+
+  /// \brief Indices of all boundaries
+  std::vector<SInd> all_boundary_ids_() const {
+    std::vector<SInd> ids(boundaries_.size());
+    std::iota(std::begin(ids), std::end(ids), SInd{0});
+    return ids;
+  }
+
+  /// \brief Half the diagonal of a cell of length \p length
+  static Num half_diagonal_(const Num length) noexcept {
+    return 0.5 * std::sqrt(static_cast<Num>(nd)) * length;
+  }
+
+  /// \brief Samples the boundary \p bIdx at the node \p nIdx (with centroid
+  /// \p x and length \p length) and at its descendants.
+  ///
+  /// If \p farBound is not NaN, an ancestor of the node is outside the band
+  /// and \p farBound is the bound to store for this node.
+  void sample_distance_field_(const NodeIdx nIdx, const NumA<nd> x,
+                              const Num length, const SInd bIdx,
+                              const Num bandWidth, const Num farBound) {
+    const Num halfDiagonal = half_diagonal_(length);
+    const Num band = halfDiagonal + bandWidth * length;
+    const bool isFar = !std::isnan(farBound);
+    const Num phi = isFar ? farBound : boundaries_[bIdx].signed_distance(x);
+    distanceField_(nIdx(), bIdx) = std::copysign(std::min(std::abs(phi), band),
+                                                 phi);
+    isCutField_(nIdx(), bIdx)
+      = !isFar && std::abs(phi) <= halfDiagonal
+        && is_cut_by(CellVertices{nIdx(), cell_vertices_coords(length, x)},
+                     bIdx);
+
+    if (this->is_leaf(nIdx)) { return; }
+
+    // children centroids are half a diagonal of the children away
+    const Num childBound
+      = isFar || std::abs(phi) > band
+        ? std::copysign(std::abs(phi) - 0.5 * halfDiagonal, phi)
+        : std::numeric_limits<Num>::quiet_NaN();
+    for (const auto pos : this->child_positions()) {
+      const NumA<nd> x_child
+        = x + child_rel_pos(pos).template cast<Num>() * 0.25 * length;
+      sample_distance_field_(this->child(nIdx, pos), x_child, 0.5 * length,
+                             bIdx, bandWidth, childBound);
+    }
+  }
+
+  ///@}
+
   /// \name Spatial information: implementation details
   ///@{
 
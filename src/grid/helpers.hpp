@@ -4,6 +4,7 @@
 /// Includes:
 #include <string>
 #include <vector>
+#include <array>
 #include "globals.hpp"
 #include "grid.hpp"
 #include "geometry/geometry.hpp"
@@ -108,16 +109,16 @@ std::tuple<T,T,T,T,T,T> make_conditions(T t) {
   return std::make_tuple(t,t,t,t,t,t);
 }
 
-/// \brief Build boundaries for an unit cube
+/// \brief Build boundaries for the box covered by the root cell(s)
 template<SInd nd> struct make_boundaries {
-  struct BoundaryPosition { Num x_max, x_min, off; };
+  struct BoundaryPosition { NumA<nd> x_max, x_min; Num off; };
   auto boundary_position(RootCell<nd> rootCell) -> BoundaryPosition {
     auto length = rootCell.length;
     BoundaryPosition pos;
     auto eps = length * 1e-15; // std::numeric_limits<Num>::min();
-    pos.x_max = rootCell.x_max()(0) - eps;
-    pos.x_min = rootCell.x_min()(0) + eps;
-    pos.off = pos.x_min + 0.5*length;
+    pos.x_max = rootCell.x_max().array() - eps;
+    pos.x_min = rootCell.x_min().array() + eps;
+    pos.off = pos.x_min(0) + 0.5*length;
     return pos;
   }
 
@@ -128,13 +129,17 @@ template<SInd nd> struct make_boundaries {
 
     typename Solver::Boundaries boundaries;
     boundaries.emplace_back
-    (make_boundary<nd>(edge::xneg<0>(), p.x_min, p.off, "left"  , solver, std::get<0>(bcs)));
+    (make_boundary<nd>(edge::xneg<0>(), p.x_min(0), p.off, "left", solver,
+                       std::get<0>(bcs)));
     boundaries.emplace_back
-    (make_boundary<nd>(edge::xpos<0>(), p.x_max, p.off, "right" , solver, std::get<1>(bcs)));
+    (make_boundary<nd>(edge::xpos<0>(), p.x_max(0), p.off, "right", solver,
+                       std::get<1>(bcs)));
     boundaries.emplace_back
-    (make_boundary<nd>(edge::xneg<1>(), p.x_min, p.off, "bottom", solver, std::get<2>(bcs)));
+    (make_boundary<nd>(edge::xneg<1>(), p.x_min(1), p.off, "bottom", solver,
+                       std::get<2>(bcs)));
     boundaries.emplace_back
-    (make_boundary<nd>(edge::xpos<1>(), p.x_max, p.off, "top"   , solver, std::get<3>(bcs)));
+    (make_boundary<nd>(edge::xpos<1>(), p.x_max(1), p.off, "top", solver,
+                       std::get<3>(bcs)));
     return boundaries;
   }
 
@@ -152,9 +157,11 @@ template<SInd nd> struct make_boundaries {
     auto p = boundary_position(rootCell);
     auto boundaries = two_dim(solver, rootCell, std::forward<BCs>(bcs));
     boundaries.emplace_back
-    (make_boundary<nd>(edge::xneg<2>(), p.x_min, p.off, "front", solver, std::get<4>(bcs)));
+    (make_boundary<nd>(edge::xneg<2>(), p.x_min(2), p.off, "front", solver,
+                       std::get<4>(bcs)));
     boundaries.emplace_back
-    (make_boundary<nd>(edge::xpos<2>(), p.x_max, p.off, "back ", solver, std::get<5>(bcs)));
+    (make_boundary<nd>(edge::xpos<2>(), p.x_max(2), p.off, "back ", solver,
+                       std::get<5>(bcs)));
     return boundaries;
   }
 };
@@ -162,9 +169,12 @@ template<SInd nd> struct make_boundaries {
 
 template<SInd nd, class MeshGen = grid::generation::MinLevel>
 io::Properties properties
-(const RootCell<nd> rootCell, const SInd minRefLvl, const SInd maxNoGridSolvers = 1) {
+(const RootCell<nd> rootCell, const SInd minRefLvl,
+ const SInd maxNoGridSolvers = 1,
+ const std::array<bool, nd> periodic = std::array<bool, nd>{}) {
 
-  const Ind maxNoGridNodes = no_nodes<nd>(minRefLvl);
+  const Ind maxNoGridNodes
+    = no_nodes<nd>(minRefLvl) * rootCell.noRoots.template cast<Ind>().prod();
 
   io::Properties meshGeneration;
   io::insert_property<Ind>(meshGeneration,"level",minRefLvl);
@@ -175,6 +185,7 @@ io::Properties properties
   io::insert_property<Ind>(properties,"maxNoGridNodes",maxNoGridNodes);
   io::insert_property<std::function<void(Grid<nd>&)>>(properties,"meshGeneration", mesh_gen);
   io::insert_property<SInd>(properties,"maxNoGridSolvers",maxNoGridSolvers);
+  io::insert_property<std::array<bool, nd>>(properties,"periodic",periodic);
   return properties;
 }
 
@@ -0,0 +1,122 @@
+/// \file \brief Tests for the geometric queries of the grid
+/// Includes:
+#include <cmath>
+#include "grid/grid.hpp"
+#include "grid/helpers.hpp"
+#include "geometry/geometry.hpp"
+/// External Includes:
+#include "misc/test.hpp"
+/// Options:
+#define ENABLE_DBG_ 0
+#include "misc/dbg.hpp"
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace hom3;
+
+static const SInd nd = 2;  ///< #of spatial dimensions
+
+/// Root cell covering the domain [0,1] in each spatial dimension
+const auto rootCell = grid::RootCell<nd> {
+    NumA<nd>::Constant(0), NumA<nd>::Constant(1)
+};
+
+/// \brief Owner of the boundaries (boundaries only need its index)
+struct BoundarySolver {
+  SolverIdx solver_idx() const noexcept { return SolverIdx{0}; }
+};
+
+/// \brief Appends a boundary with the \p geometry to \p g
+template<class Grid, class Geometry>
+void append_boundary(Grid& g, const String name, Geometry&& geometry) {
+  using G = std::decay_t<Geometry>;
+  g.append_boundary(typename Grid::Boundary {
+    name, geometry::make_geometry<G>(std::forward<Geometry>(geometry)),
+    BoundarySolver{}
+  });
+}
+
+/// \test within the narrow band of each node the distance field holds the
+/// exact distance to a sphere, and outside of it the band width with the
+/// sign of the distance; the cut-cell flags match the exact vertex test and
+/// node_boundary_distances returns the exact distances
+TEST(grid, narrow_band_distance_field) {
+  const Num bandWidth = 2.;
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, 6), grid::initialize
+  };
+  const auto sphere = geometry::implicit::Sphere<nd> {
+    NumA<nd>::Constant(0.5), 0.3
+  };
+  append_boundary(g, "sphere", sphere);
+  g.update_distance_field(bandWidth);
+  ASSERT_TRUE(g.has_distance_field());
+
+  const auto exactDistances = g.node_boundary_distances();
+  Ind noInside = 0, noOutside = 0;
+  for (auto nIdx : g.nodes()) {
+    const Num exact = sphere(g.cell_coordinates(nIdx));
+    const Num length = g.cell_length(nIdx);
+    const Num band = 0.5 * std::sqrt(static_cast<Num>(nd)) * length
+                     + bandWidth * length;
+    if (std::abs(exact) <= band) {
+      EXPECT_NEAR(g.signed_distance(nIdx, 0), exact, 1e-14);
+      ++noInside;
+    } else {
+      EXPECT_EQ(g.signed_distance(nIdx, 0), std::copysign(band, exact));
+      ++noOutside;
+    }
+    EXPECT_NEAR(exactDistances(nIdx(), 0), exact, 1e-14);
+    EXPECT_EQ(g.is_cut_by_boundary(nIdx, 0),
+              g.is_cut_by(g.compute_cell_vertices(nIdx), SInd{0}));
+  }
+  EXPECT_GT(noInside, 0);
+  EXPECT_GT(noOutside, 0);
+}
+
+/// \test at the corner where two boundaries meet, each cut cell is assigned
+/// to the boundary with the smaller signed distance (the nearer one inside
+/// the domain), and the returned distance is the exact distance to it
+TEST(grid, closest_boundary_at_corner) {
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, 5), grid::initialize
+  };
+  // domain x < 0.7 and y < 0.7 (positive inside), corner at (0.7, 0.7)
+  using Edge = geometry::implicit::Edge<nd>;
+  const NumA<nd> corner = NumA<nd>::Constant(0.7);
+  const Edge right{corner, NumA<nd>{-1., 0.}};
+  const Edge top{corner, NumA<nd>{0., -1.}};
+  append_boundary(g, "right", right);
+  append_boundary(g, "top", top);
+  g.update_distance_field();
+  const std::vector<SInd> ids{0, 1};
+
+  Ind noCutCells = 0, noCutByBoth = 0;
+  SInd assigned[] = {0, 0};
+  for (auto nIdx : g.leaf_nodes()) {
+    const bool cutByRight = g.is_cut_by_boundary(nIdx, 0);
+    const bool cutByTop = g.is_cut_by_boundary(nIdx, 1);
+    if (!cutByRight && !cutByTop) { continue; }
+    ++noCutCells;
+    if (cutByRight && cutByTop) { ++noCutByBoth; }
+
+    const NumA<nd> x = g.cell_coordinates(nIdx);
+    const Num dRight = right(x), dTop = top(x);
+    const SInd nearest = dTop < dRight ? 1 : 0;
+    const auto closest = g.closest_boundary(nIdx, ids);
+    EXPECT_EQ(closest.boundaryIdx, nearest);
+    EXPECT_NEAR(closest.distance, std::min(dRight, dTop), 1e-14);
+    // without the distance field:
+    const auto exact = g.closest_boundary(x);
+    EXPECT_EQ(exact.boundaryIdx, nearest);
+    EXPECT_NEAR(exact.distance, closest.distance, 1e-14);
+    ++assigned[nearest];
+  }
+  EXPECT_GT(noCutCells, 0);
+  EXPECT_GT(noCutByBoth, 0);  // the cell containing the corner
+  EXPECT_GT(assigned[0], 0);
+  EXPECT_GT(assigned[1], 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+#undef ENABLE_DBG_
+////////////////////////////////////////////////////////////////////////////////
@@ -55,6 +55,18 @@ T read(const Properties& properties, const String& name) {
   }
 }
 
+/// \brief Reads the optional property of type \p T with \p name from
+/// container \p properties
+///
+/// \returns readed property of type \p T if it exists, \p defaultValue
+/// otherwise
+template<class T>
+T read_or(const Properties& properties, const String& name, T defaultValue) {
+  auto foundIt = properties.find(name);
+  return foundIt != std::end(properties)
+      ? boost::any_cast<T>(foundIt->second) : std::move(defaultValue);
+}
+
 /// \brief Reads property with \p name from property container \p properties
 /// into the \p value.
 template<class T>
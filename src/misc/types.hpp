@@ -67,6 +67,12 @@ template<SInd nRows> using SIntA = EigenStaticVector<SInt, nRows>;
 using EBV = Eigen::Matrix<bool, Eigen::Dynamic, 1>;
 ///@}
 
+/// \name Dynamic arrays of static vectors (Eigen's aligned allocator)
+///@{
+template<SInd nRows>
+using NumAV = std::vector<NumA<nRows>, Eigen::aligned_allocator<NumA<nRows>>>;
+///@}
+
 /// \name Col-major matrix types (dynamic length, static # of columns)
 ///@{
 template<SInd nd = 1> using IntM  = EigenColMajor< Int, nd>;
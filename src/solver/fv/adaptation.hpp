@@ -0,0 +1,332 @@
+#ifndef HOM3_SOLVERS_FV_ADAPTATION_HPP_
+#define HOM3_SOLVERS_FV_ADAPTATION_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Error-estimator-driven grid adaptation of finite volume solvers
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "globals.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Grid adaptation driven by error estimators
+///
+/// An estimator is any callable with signature
+/// Num(const Solver& solver, CellIdx cIdx) that returns a non-negative
+/// refinement indicator of the internal cell cIdx. Cells whose indicator is
+/// above the refinement threshold are refined, and groups of sibling cells
+/// whose indicators are all below the coarsening threshold are coarsened.
+///
+/// The grid is kept balanced as required by the level interfaces of the
+/// solver: the same-level face neighbors of a node with grandchildren are
+/// refined. Refining a cell thus refines its coarser face neighbors (and the
+/// cell itself is refined by a later adaptation if they are two levels
+/// coarser), and cells are not coarsened if a face neighbor would violate it.
+namespace adaptation {
+
+/// \brief Settings of the grid adaptation
+///
+/// Required properties:
+/// - maxRefinementLevel: cells are not refined beyond this level
+///
+/// Optional properties (default values in parentheses):
+/// - adaptationInterval: #of steps between adaptations (10)
+/// - refineThreshold: indicator above which cells are refined (0.1)
+/// - coarsenThreshold: indicator below which cells are coarsened (0.02)
+/// - minRefinementLevel: cells are not coarsened below this level (0)
+/// - maxNoCellsPerLevel: #of cells at each level above which no cells are
+///   refined into that level (unbounded)
+struct Settings {
+  explicit Settings(const io::Properties& properties)
+    : interval(io::read_or<Ind>(properties, "adaptationInterval", 10))
+    , refineThreshold(io::read_or<Num>(properties, "refineThreshold", 0.1))
+    , coarsenThreshold(io::read_or<Num>(properties, "coarsenThreshold", 0.02))
+    , minLevel(io::read_or<SInd>(properties, "minRefinementLevel", 0))
+    , maxLevel(io::read<SInd>(properties, "maxRefinementLevel"))
+    , maxNoCellsPerLevel(io::read_or<Ind>(properties, "maxNoCellsPerLevel",
+                                          std::numeric_limits<Ind>::max())) {
+    ASSERT(interval > 0, "the adaptation interval must be positive!");
+    ASSERT(coarsenThreshold < refineThreshold,
+           "the coarsening threshold must be below the refinement threshold!");
+    ASSERT(minLevel <= maxLevel, "minRefinementLevel > maxRefinementLevel!");
+  }
+
+  Ind interval;
+  Num refineThreshold;
+  Num coarsenThreshold;
+  SInd minLevel;
+  SInd maxLevel;
+  Ind maxNoCellsPerLevel;
+};
+
+/// \brief Largest jump of the variable \p v across the faces of a cell,
+/// relative to the magnitude of the variable
+struct GradientJump {
+  explicit GradientJump(const SInd v = 0) noexcept : variable(v) {}
+
+  template<class Solver>
+  Num operator()(const Solver& s, const CellIdx cIdx) const noexcept {
+    const Num q = s.cells().lhs(cIdx, variable);
+    Num indicator = 0.;
+    for (auto nghbrPos : s.grid().neighbor_positions()) {
+      const auto nghbrIdx = s.cells().neighbors(cIdx, nghbrPos);
+      if (!is_valid(nghbrIdx)) { continue; }
+      const Num qN = s.cells().lhs(nghbrIdx, variable);
+      indicator = std::max(indicator, std::abs(qN - q)
+                           / std::max({std::abs(q), std::abs(qN),
+                                       std::numeric_limits<Num>::min()}));
+    }
+    return indicator;
+  }
+
+  SInd variable;
+};
+
+/// \brief Löhner's normalized second-derivative indicator of the variable
+/// \p v, maximum over the spatial directions:
+///
+///   |q+ - 2 q + q-| / (|q+ - q| + |q - q-| + eps (|q+| + 2 |q| + |q-|))
+///
+/// It is in [0, 1], independent of the cell size, and the filter \p eps
+/// suppresses the refinement of small ripples.
+struct Lohner {
+  explicit Lohner(const SInd v = 0, const Num eps = 0.01) noexcept
+    : variable(v), filter(eps) {}
+
+  template<class Solver>
+  Num operator()(const Solver& s, const CellIdx cIdx) const noexcept {
+    using container::hierarchical::neighbor_position;
+    using container::hierarchical::neg_dir;
+    using container::hierarchical::pos_dir;
+    const Num q = s.cells().lhs(cIdx, variable);
+    Num indicator = 0.;
+    for (auto d : s.grid().dimensions()) {
+      const auto mIdx
+        = s.cells().neighbors(cIdx, neighbor_position(d, neg_dir));
+      const auto pIdx
+        = s.cells().neighbors(cIdx, neighbor_position(d, pos_dir));
+      if (!is_valid(mIdx) || !is_valid(pIdx)) { continue; }
+      const Num qM = s.cells().lhs(mIdx, variable);
+      const Num qP = s.cells().lhs(pIdx, variable);
+      const Num denominator
+        = std::abs(qP - q) + std::abs(q - qM)
+          + filter * (std::abs(qP) + 2. * std::abs(q) + std::abs(qM));
+      if (denominator <= std::numeric_limits<Num>::min()) { continue; }
+      indicator
+        = std::max(indicator, std::abs(qP - 2. * q + qM) / denominator);
+    }
+    return indicator;
+  }
+
+  SInd variable;
+  Num filter;
+};
+
+/// \brief Flags the cells closer than \p width cell lengths to a geometry
+/// (indicator 1, otherwise 0)
+///
+/// The geometry is given by a signed-distance function, and defaults to the
+/// boundaries of the grid.
+template<SInd nd> struct GeometryProximity {
+  using SignedDistance = std::function<Num(const NumA<nd>&)>;
+
+  explicit GeometryProximity(const Num w = 2.,
+                             SignedDistance signedDistance = nullptr)
+    : width(w), distance(std::move(signedDistance)) {}
+
+  template<class Solver>
+  Num operator()(const Solver& s, const CellIdx cIdx) const noexcept {
+    const NumA<nd> x = s.cells().x_center.row(cIdx).transpose();
+    const Num phi = distance ? distance(x) : s.grid().level_set(x);
+    return std::abs(phi) < width * s.cells().length(cIdx) ? 1. : 0.;
+  }
+
+  Num width;
+  SignedDistance distance;
+};
+
+/// \brief Combines the \p estimators into one whose indicator is the
+/// maximum of theirs
+template<class... Estimators> auto max_of(Estimators... estimators) {
+  return [=](const auto& s, const CellIdx cIdx) {
+    return std::max({estimators(s, cIdx)...});
+  };
+}
+
+/// \brief #of refined and coarsened grid nodes of an adaptation
+struct Result {
+  Ind noRefined;
+  Ind noCoarsened;
+};
+
+/// \brief Adapts the grid of the \p solver to the indicators of the
+/// \p estimator (see Solver::adapt)
+///
+/// If the refinements would exceed the cell budget of a level, those with the
+/// smallest indicators are dropped.
+template<class Solver, class Estimator>
+Result adapt(Solver& s, Estimator&& estimator, const Settings& settings) {
+  const auto& g = s.grid();
+  const auto solverIdx = s.solver_idx();
+  auto is_cell = [&](const NodeIdx nIdx) {
+    return g.is_leaf(nIdx) && g.has_solver(nIdx, solverIdx);
+  };
+
+  std::vector<Ind> noCellsAtLevel(g.max_no_levels() + 1, 0);
+  std::vector<std::pair<Num, NodeIdx>> indicators;
+  for (auto cIdx : s.internal_cells()) {
+    const auto nIdx = s.node_idx(cIdx);
+    ++noCellsAtLevel[g.level(nIdx)];
+    indicators.emplace_back(estimator(s, cIdx), nIdx);
+  }
+  std::sort(std::begin(indicators), std::end(indicators),
+            [](const std::pair<Num, NodeIdx>& a,
+               const std::pair<Num, NodeIdx>& b) { return a.first > b.first; });
+
+  // refinement: the level interfaces of the solver require the same-level
+  // face neighbors of a node with grandchildren to be refined. They are
+  // marked too, and if they don't exist yet the coarser leafs there are
+  // marked and the node is refined by a later adaptation.
+  std::unordered_set<Ind> refine;
+  std::vector<NodeIdx> toBalance;
+  auto mark_refine = [&](const NodeIdx nIdx) {
+    if (refine.insert(nIdx()).second) { toBalance.push_back(nIdx); }
+  };
+  for (const auto& i : indicators) {
+    if (i.first <= settings.refineThreshold) { break; }
+    if (g.level(i.second) < settings.maxLevel) { mark_refine(i.second); }
+  }
+  // same-level neighbor of the parent of nIdx, or the coarser leaf there if
+  // it doesn't exist (invalid at the domain boundaries)
+  auto parent_neighbor = [&](const NodeIdx nIdx, const SInd nghbrPos) {
+    const auto pIdx = g.parent(nIdx);
+    const auto nghbrIdx = g.find_samelvl_neighbor(pIdx, nghbrPos);
+    if (is_valid(nghbrIdx) || g.is_root(pIdx)) { return nghbrIdx; }
+    return g.find_samelvl_neighbor(g.parent(pIdx), nghbrPos);
+  };
+  while (!toBalance.empty()) {
+    const auto nIdx = toBalance.back();
+    toBalance.pop_back();
+    if (g.is_root(nIdx)) { continue; }
+    for (auto nghbrPos : g.neighbor_positions()) {
+      const auto nghbrIdx = parent_neighbor(nIdx, nghbrPos);
+      if (is_valid(nghbrIdx) && is_cell(nghbrIdx)) { mark_refine(nghbrIdx); }
+    }
+  }
+
+  // unmark the nodes whose parent neighbors are not marked, and the nodes
+  // with the smallest indicators refining into levels over budget, until
+  // neither happens
+  auto is_balanced = [&](const NodeIdx nIdx) {
+    if (g.is_root(nIdx)) { return true; }
+    for (auto nghbrPos : g.neighbor_positions()) {
+      const auto nghbrIdx = parent_neighbor(nIdx, nghbrPos);
+      if (!is_valid(nghbrIdx) || !is_cell(nghbrIdx)) { continue; }
+      if (g.level(nghbrIdx) + 1 < g.level(nIdx)
+          || !refine.count(nghbrIdx())) { return false; }
+    }
+    return true;
+  };
+  for (bool unmarked = true; unmarked;) {
+    unmarked = false;
+    for (auto it = std::begin(refine); it != std::end(refine);) {
+      if (is_balanced(NodeIdx{*it})) { ++it; continue; }
+      it = refine.erase(it);
+      unmarked = true;
+    }
+    if (unmarked) { continue; }
+
+    auto noCells = noCellsAtLevel;
+    for (auto nIdx : refine) {
+      const SInd l = g.level(NodeIdx{nIdx});
+      --noCells[l];
+      noCells[l + 1] += g.no_child_positions();
+    }
+    for (auto i = indicators.rbegin(), e = indicators.rend(); i != e; ++i) {
+      if (!refine.count(i->second())) { continue; }
+      const SInd l = g.level(i->second);
+      if (noCells[l + 1] <= settings.maxNoCellsPerLevel) { continue; }
+      refine.erase(i->second());
+      ++noCells[l];
+      noCells[l + 1] -= g.no_child_positions();
+      unmarked = true;
+    }
+  }
+  std::vector<NodeIdx> refineIds;
+  for (const auto& i : indicators) {
+    if (refine.count(i.second())) { refineIds.push_back(i.second); }
+  }
+
+  // coarsening: parents whose children are all cells below the threshold and
+  // not refined, and whose same-level face neighbors keep no grandchildren
+  std::unordered_set<Ind> coarsen;
+  std::vector<NodeIdx> coarsenIds;
+  auto can_coarsen = [&](const NodeIdx pIdx) {
+    if (g.level(pIdx) < settings.minLevel) { return false; }
+    for (auto childIdx : g.childs(pIdx)) {
+      if (!is_cell(childIdx) || refine.count(childIdx())) { return false; }
+    }
+    for (auto nghbrPos : g.neighbor_positions()) {
+      const auto nghbrIdx = g.find_samelvl_neighbor(pIdx, nghbrPos);
+      if (!is_valid(nghbrIdx) || g.is_leaf(nghbrIdx)) { continue; }
+      for (auto childIdx : g.childs(nghbrIdx)) {
+        if (!g.is_leaf(childIdx) || refine.count(childIdx())) { return false; }
+      }
+    }
+    return true;
+  };
+  std::unordered_set<Ind> lowIndicator;
+  for (const auto& i : indicators) {
+    if (i.first < settings.coarsenThreshold) {
+      lowIndicator.insert(i.second());
+    }
+  }
+  for (const auto& i : indicators) {
+    const auto nIdx = i.second;
+    if (!lowIndicator.count(nIdx()) || g.is_root(nIdx)) { continue; }
+    const auto pIdx = g.parent(nIdx);
+    if (coarsen.count(pIdx())) { continue; }
+    bool allLow = true;
+    for (auto childIdx : g.childs(pIdx)) {
+      allLow = allLow && lowIndicator.count(childIdx());
+    }
+    if (!allLow || !can_coarsen(pIdx)) { continue; }
+    coarsen.insert(pIdx());
+    coarsenIds.push_back(pIdx);
+  }
+
+  if (!refineIds.empty() || !coarsenIds.empty()) {
+    s.adapt(refineIds, coarsenIds);
+  }
+  return {static_cast<Ind>(refineIds.size()),
+          static_cast<Ind>(coarsenIds.size())};
+}
+
+/// \brief Adapts the initial grid of the \p solver until it doesn't change
+/// anymore (at most maxLevel - minLevel times), imposing the initial condition
+/// on the new cells
+template<class Solver, class Estimator>
+void adapt_initial_grid(Solver& s, Estimator&& estimator,
+                        const Settings& settings) {
+  for (SInd l = settings.minLevel; l < settings.maxLevel; ++l) {
+    const auto result = adapt(s, estimator, settings);
+    s.reset_initial_condition();
+    if (result.noRefined == 0) { break; }
+  }
+}
+
+}  // namespace adaptation
+
+////////////////////////////////////////////////////////////////////////////////
+}  // namespace fv
+}  // namespace solver
+}  // namespace hom3
+////////////////////////////////////////////////////////////////////////////////
+#endif
@@ -101,6 +101,11 @@ template<SInd nd_, class NumFlux, class Solver> struct Physics {
            << ") in cell: " << cIdx << "!\n");
   }
 
+  /// \brief Is the advected quantity of \p cIdx positive?
+  template<class _>
+  inline bool valid_variables(const CellIdx cIdx) const noexcept
+  { return q<_>(cIdx) > 0; }
+
   /// \brief Advection velocity distribution at \p cIdx
   inline NumA<nd> velocity(CellIdx cIdx) const noexcept
   { return u_(b_()->cells().x_center.row(cIdx)); }
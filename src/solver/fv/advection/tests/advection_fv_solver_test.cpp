@@ -1,5 +1,6 @@
 /// \brief Test for the FV solver of the Advection equation.
 /// Includes:
+#include <cmath>
 #include "solver/fv/advection.hpp"
 #include "solver/fv/utilities.hpp"
 #include "geometry/geometry.hpp"
@@ -124,6 +125,331 @@ TEST(advection_fv_solver, one_dimensional_dirichlet) {
   solver::fv::run_solver(test_grid, advSolver, maxNoTimeSteps, outputInterval);
 }
 
+/// \test linear fields are interpolated exactly at the probe points
+TEST(advection_fv_solver, interpolation_at_probes) {
+  using Probes = solver::fv::Probes<nd>;
+  const SInd probeRefLevel = 4;
+  auto probe_grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, probeRefLevel)
+  };
+
+  const NumAV<nd> points = {
+    NumA<nd>{0.3, 0.4}, NumA<nd>{0.71, 0.52}, NumA<nd>{1.5, 0.5}
+  };
+  const std::vector<SInd> variables = {0};
+  auto properties = adv_properties<nd>(&probe_grid, 1);
+  io::insert<std::vector<Probes>>
+      (properties, "probes",
+       {Probes{"advection_probes", points, variables, 1}});
+
+  auto advSolver = AdvSolver<nd> { advSolverIdx, properties };
+  auto linear_ic = [](const NumA<nd> x) {
+    return NumA<AdvSolver<nd>::nvars>::Constant(1. + x(0) + 2. * x(1));
+  };
+  advSolver.set_initial_condition(linear_ic);
+
+  auto cBc = adv_physics::bc::Characteristic<AdvSolver<nd>>{advSolver};
+  auto bcs = std::make_tuple(cBc, cBc, cBc, cBc, cBc, cBc);
+  solver::fv::append_bcs(advSolver, rootCell, bcs);
+
+  solver::fv::initialize(probe_grid, advSolver);
+  write_probes(advSolver);
+
+  const auto values = advSolver.interpolate(points, variables);
+  EXPECT_NEAR(values(0, 0), 1. + 0.30 + 2. * 0.40, 1e-12);
+  EXPECT_NEAR(values(1, 0), 1. + 0.71 + 2. * 0.52, 1e-12);
+  EXPECT_TRUE(std::isnan(values(2, 0)));  // outside of the domain
+}
+
+/// \brief Mesh generator that refines the grid uniformly up to level - 1 and
+/// then once more in the center of the domain (i.e. [0.25, 0.75]^nd)
+struct CenterRefined : grid::generation::Interface<CenterRefined> {
+  const Ind level;
+  explicit CenterRefined(io::Properties input) noexcept
+  : level(io::read<Ind>(input, "level")) {}
+
+  template<class Grid> void generate_mesh(Grid& g) {
+    io::Properties coarse;
+    io::insert_property<Ind>(coarse, "level", level - 1);
+    grid::generation::MinLevel{coarse}(g);
+    std::vector<NodeIdx> centerLeafs;
+    for (auto nIdx : g.leaf_nodes()) {
+      const NumA<nd> x = g.cell_coordinates(nIdx) - NumA<nd>::Constant(0.5);
+      if (x.cwiseAbs().maxCoeff() < 0.25) { centerLeafs.push_back(nIdx); }
+    }
+    for (auto nIdx : centerLeafs) { g.refine_node(nIdx); }
+  }
+};
+
+/// \test local time stepping conserves the advected quantity across the
+/// refinement level interfaces
+TEST(advection_fv_solver, local_time_stepping_conservation) {
+  namespace ti = solver::fv::time_integration;
+  using LtsSolver = adv_physics::Solver<nd, flux, ti::local_time_stepping>;
+  const SInd ltsRefLevel = 4;
+  auto lts_grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd, CenterRefined>
+    (rootCell, ltsRefLevel, 1, std::array<bool, nd>{{true, true}})
+  };
+
+  auto ltsSolver = LtsSolver { advSolverIdx, adv_properties<nd>(&lts_grid, 1) };
+  auto bump_ic = [](const NumA<nd> x) {
+    NumA<nd> x_center = NumA<nd>::Constant(0.5);
+    x_center(1) = 0.3;
+    return NumA<LtsSolver::nvars>::Constant
+        (1. + std::exp(-(x - x_center).squaredNorm() / 0.01));
+  };
+  ltsSolver.set_initial_condition(bump_ic);
+  solver::fv::initialize(lts_grid, ltsSolver);
+
+  auto total = [&]() {
+    Num result = 0.;
+    for (auto cIdx : ltsSolver.internal_cells()) {
+      result += ltsSolver.Q<solver::fv::lhs_tag>(cIdx, 0)
+                * std::pow(ltsSolver.cells().length(cIdx), nd);
+    }
+    return result;
+  };
+
+  const Num initialTotal = total();
+  while (ltsSolver.time() < ltsSolver.final_time()) { ltsSolver.solve(); }
+  EXPECT_NEAR(total(), initialTotal, 1e-12 * initialTotal);
+}
+
+/// \test the cells of a uniform grid are ordered lexicographically, and all
+/// cells but those at the boundaries form uniform spans
+TEST(advection_fv_solver, uniform_spans) {
+  const SInd uniformRefLevel = 5;
+  const Ind n = 1 << uniformRefLevel;
+  auto uniform_grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, uniformRefLevel)
+  };
+  auto uniformSolver = AdvSolver<nd> {
+    advSolverIdx, adv_properties<nd>(&uniform_grid, 0.1)
+  };
+  uniformSolver.set_initial_condition([](const NumA<nd> x) {
+    return NumA<AdvSolver<nd>::nvars>::Constant
+        (1. + std::exp(-(x - NumA<nd>::Constant(0.5)).squaredNorm() / 0.01));
+  });
+  auto cBc = adv_physics::bc::Characteristic<AdvSolver<nd>>{uniformSolver};
+  solver::fv::append_bcs(uniformSolver, rootCell,
+                         std::make_tuple(cBc, cBc, cBc, cBc));
+  solver::fv::initialize(uniform_grid, uniformSolver);
+
+  EXPECT_EQ(uniformSolver.no_uniform_cells(), (n - 2) * (n - 2));
+  const Num dx = uniformSolver.cells().length(CellIdx{0});
+  for (auto cIdx : uniformSolver.internal_cells()) {
+    const NumA<nd> x = uniformSolver.cells().x_center.row(cIdx).transpose();
+    EXPECT_NEAR(x(0), (cIdx() % n + 0.5) * dx, 1e-12);
+    EXPECT_NEAR(x(1), (cIdx() / n + 0.5) * dx, 1e-12);
+  }
+  while (uniformSolver.time() < uniformSolver.final_time()) {
+    uniformSolver.solve();
+  }
+
+  // refinement level interfaces and periodic faces break the spans
+  const SInd refinedLevel = 4;
+  auto refined_grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd, CenterRefined>
+    (rootCell, refinedLevel, 1, std::array<bool, nd>{{true, true}})
+  };
+  auto refinedSolver = AdvSolver<nd> {
+    advSolverIdx, adv_properties<nd>(&refined_grid, 0.1)
+  };
+  refinedSolver.set_initial_condition([](const NumA<nd>) {
+    return NumA<AdvSolver<nd>::nvars>::Constant(1.);
+  });
+  solver::fv::initialize(refined_grid, refinedSolver);
+  EXPECT_GT(refinedSolver.no_uniform_cells(), 0);
+  EXPECT_LT(refinedSolver.no_uniform_cells(),
+            refinedSolver.no_internal_cells());
+}
+
+/// \brief Solution of the RK2 method \p TimeIntegration with tiles of \p
+/// tileSize cells on a grid refined in its center
+template<class TimeIntegration>
+std::vector<Num> center_refined_rk2_solution(const Ind tileSize) {
+  using Solver = adv_physics::Solver<nd, flux, TimeIntegration>;
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd, CenterRefined>(rootCell, 5)
+  };
+  auto properties = adv_properties<nd>(&g, 0.2);
+  io::insert<Ind>(properties, "tileSize", tileSize);
+  auto s = Solver { advSolverIdx, properties };
+  s.set_initial_condition([](const NumA<nd> x) {
+    return NumA<Solver::nvars>::Constant
+        (1. + std::exp(-(x - NumA<nd>::Constant(0.3)).squaredNorm() / 0.01));
+  });
+  auto cBc = adv_physics::bc::Characteristic<Solver>{s};
+  solver::fv::append_bcs(s, rootCell, std::make_tuple(cBc, cBc, cBc, cBc));
+  solver::fv::initialize(g, s);
+  while (s.time() < s.final_time()) { s.solve(); }
+
+  std::vector<Num> result;
+  for (auto cIdx : s.internal_cells()) {
+    result.push_back(s.template Q<solver::fv::lhs_tag>(cIdx, 0));
+  }
+  return result;
+}
+
+/// \test the tiled RK2 method reproduces the RK2 method for tiles smaller
+/// than, across and larger than the refinement level interfaces
+TEST(advection_fv_solver, tiled_runge_kutta_2) {
+  namespace ti = solver::fv::time_integration;
+  const auto reference = center_refined_rk2_solution<ti::runge_kutta_2>(1);
+  for (const Ind tileSize : {1, 16, 64, 100000}) {
+    const auto tiled
+      = center_refined_rk2_solution<ti::tiled_runge_kutta_2>(tileSize);
+    ASSERT_EQ(tiled.size(), reference.size());
+    for (std::size_t i = 0; i != reference.size(); ++i) {
+      EXPECT_NEAR(tiled[i], reference[i], 1e-13);
+    }
+  }
+}
+
+/// \brief Mesh generator that refines the grid uniformly up to level -
+/// noNestedLevels and then noNestedLevels more times in nested boxes around
+/// the center of the domain (each one half as wide as the previous one)
+struct NestedCenterRefined : grid::generation::Interface<NestedCenterRefined> {
+  static const SInd noNestedLevels = 4;
+  const Ind level;
+  explicit NestedCenterRefined(io::Properties input) noexcept
+  : level(io::read<Ind>(input, "level")) {}
+
+  template<class Grid> void generate_mesh(Grid& g) {
+    io::Properties uniform;
+    io::insert_property<Ind>(uniform, "level", level - noNestedLevels);
+    grid::generation::MinLevel{uniform}(g);
+    Num halfWidth = 0.25;
+    for (SInd l = 0; l != noNestedLevels; ++l, halfWidth *= 0.5) {
+      std::vector<NodeIdx> centerLeafs;
+      for (auto nIdx : g.leaf_nodes()) {
+        const NumA<nd> x = g.cell_coordinates(nIdx) - NumA<nd>::Constant(0.5);
+        if (x.cwiseAbs().maxCoeff() < halfWidth) {
+          centerLeafs.push_back(nIdx);
+        }
+      }
+      for (auto nIdx : centerLeafs) { g.refine_node(nIdx); }
+    }
+  }
+};
+
+/// \test pseudo-time stepping with local time-steps reaches the steady state
+/// of a uniform flow much faster than global time stepping
+TEST(advection_fv_solver, pseudo_time_steady_state) {
+  namespace ti = solver::fv::time_integration;
+  using Velocity = std::function<NumA<nd>(NumA<nd>)>;
+  const SInd steadyRefLevel = 8;
+  auto steady_grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd, NestedCenterRefined>
+    (rootCell, steadyRefLevel)
+  };
+  auto properties = adv_properties<nd>(&steady_grid, 100);
+  properties.erase("CFL");
+  io::insert<Num>(properties, "CFL", 0.5);
+  properties.erase("velocity");
+  io::insert<Velocity>(properties, "velocity", [](const NumA<nd>) {
+    return NumA<nd>{1., 0.5};
+  });
+  auto bump_ic = [](const NumA<nd> x) {
+    NumA<nd> x_center = NumA<nd>::Constant(0.5);
+    x_center(0) = 0.3;
+    return NumA<1>::Constant
+        (1. + std::exp(-(x - x_center).squaredNorm() / 0.01));
+  };
+  auto error = [](const auto& s) {
+    Num result = 0.;
+    for (auto cIdx : s.internal_cells()) {
+      const Num q = s.template Q<solver::fv::lhs_tag>(cIdx, 0);
+      result = std::max(result, std::abs(q - 1.));
+    }
+    return result;
+  };
+
+  using SteadySolver = adv_physics::Solver<nd, flux, ti::pseudo_time_stepping>;
+  auto steadySolver = SteadySolver { advSolverIdx, properties };
+  steadySolver.set_initial_condition(bump_ic);
+  auto dBc = adv_physics::bc::Dirichlet<SteadySolver>{steadySolver, 1.};
+  solver::fv::append_bcs(steadySolver, rootCell,
+                         std::make_tuple(dBc, dBc, dBc, dBc));
+  EXPECT_TRUE(solver::fv::run_steady(steady_grid, steadySolver, maxNoTimeSteps,
+                                     maxNoTimeSteps, 1e-8));
+  const Ind steadySteps = steadySolver.step();
+  const Num steadyError = error(steadySolver);
+  EXPECT_LT(steadyError, 1e-6);
+
+  using GlobalSolver = adv_physics::Solver<nd, flux, ti::euler_forward>;
+  auto globalSolver = GlobalSolver { advSolverIdx, properties };
+  globalSolver.set_initial_condition(bump_ic);
+  auto gBc = adv_physics::bc::Dirichlet<GlobalSolver>{globalSolver, 1.};
+  solver::fv::append_bcs(globalSolver, rootCell,
+                         std::make_tuple(gBc, gBc, gBc, gBc));
+  solver::fv::initialize(steady_grid, globalSolver);
+  while (error(globalSolver) > steadyError
+         && globalSolver.step() < maxNoTimeSteps) {
+    globalSolver.solve();
+  }
+  EXPECT_GT(globalSolver.step(), 5 * steadySteps);
+}
+
+/// \test on a grid periodic along x the boundaries along x create no ghost
+/// cells, and the upwind flux at CFL = 1 (an exact shift by one cell per
+/// step) wraps a profile advected along x around the domain, such that it
+/// comes back to its initial state after one period
+TEST(advection_fv_solver, periodic_advection) {
+  using Velocity = std::function<NumA<nd>(NumA<nd>)>;
+  const SInd periodicRefLevel = 5;
+  const Ind n = Ind{1} << periodicRefLevel;  // #of cells along each direction
+  auto periodic_grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>
+    (rootCell, periodicRefLevel, 1, std::array<bool, nd>{{true, false}})
+  };
+  auto properties = adv_properties<nd>(&periodic_grid, 1.);
+  properties.erase("velocity");
+  io::insert<Velocity>(properties, "velocity", [](const NumA<nd>) {
+    return NumA<nd>{1., 0.};
+  });
+  auto s = AdvSolver<nd> { advSolverIdx, properties };
+  s.set_initial_condition([](const NumA<nd> x) {
+    return NumA<AdvSolver<nd>::nvars>::Constant
+        (1. + std::exp(-(x - NumA<nd>{0.8, 0.5}).squaredNorm() / 0.01));
+  });
+  auto dBc = adv_physics::bc::Dirichlet<AdvSolver<nd>>{s, 1.};
+  solver::fv::append_bcs(s, rootCell, std::make_tuple(dBc, dBc, dBc, dBc));
+  solver::fv::initialize(periodic_grid, s);
+
+  // the ghost cells follow the internal cells:
+  EXPECT_EQ(s.cells().size() - s.no_internal_cells(), 2 * n);
+  for (auto gIdx : boost::counting_range(CellIdx{s.no_internal_cells()},
+                                         s.cells().last())) {
+    EXPECT_EQ(container::hierarchical::neighbor_direction
+              (s.boundary_info(gIdx).ghostPos), 1);
+  }
+
+  auto solution = [&]() {
+    std::vector<Num> result;
+    for (auto cIdx : s.internal_cells()) {
+      result.push_back(s.Q<solver::fv::lhs_tag>(cIdx, 0));
+    }
+    return result;
+  };
+  auto max_difference = [](const std::vector<Num>& a,
+                           const std::vector<Num>& b) {
+    Num result = 0.;
+    for (std::size_t i = 0; i != a.size(); ++i) {
+      result = std::max(result, std::abs(a[i] - b[i]));
+    }
+    return result;
+  };
+  const auto initial = solution();
+  while (s.time() < 0.5) { s.solve(); }
+  // the peak crossed the periodic faces at x = 1:
+  EXPECT_GT(max_difference(solution(), initial), 0.5);
+  while (s.time() < s.final_time()) { s.solve(); }
+  EXPECT_EQ(s.step(), n);
+  EXPECT_LT(max_difference(solution(), initial), 1e-12);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 #undef ENABLE_DBG_
 ////////////////////////////////////////////////////////////////////////////////
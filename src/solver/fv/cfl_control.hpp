@@ -0,0 +1,146 @@
+#ifndef HOM3_SOLVERS_FV_CFL_CONTROL_HPP_
+#define HOM3_SOLVERS_FV_CFL_CONTROL_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Adaptive CFL controller: steps whose solution is not valid are
+/// rolled back and retried with a smaller time-step
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <algorithm>
+#include "globals.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Adaptive CFL control
+namespace cfl_control {
+
+/// \brief Settings of the CFL controller
+///
+/// The time-step of the physics (i.e. with the CFL number of the physics'
+/// properties) is scaled by a factor. When the solution of a step is not
+/// valid (see the physics' valid_variables) the step is rolled back, the
+/// factor is multiplied by reduction and the step is retried (coupled
+/// solvers are rolled back and retried together, see solve). After
+/// stableSteps accepted steps in a row the factor is multiplied by growth,
+/// up to maxFactor.
+///
+/// Optional properties (default values in parentheses):
+/// - adaptiveCFL: enables the controller (false)
+/// - cflReduction: (0.5)
+/// - cflGrowth: (1.1)
+/// - cflStableSteps: (10)
+/// - maxCFLFactor: (1)
+/// - minCFLFactor: the run terminates below it (1e-3)
+struct Settings {
+  explicit Settings(const io::Properties& properties)
+    : enabled(io::read_or<bool>(properties, "adaptiveCFL", false))
+    , reduction(io::read_or<Num>(properties, "cflReduction", 0.5))
+    , growth(io::read_or<Num>(properties, "cflGrowth", 1.1))
+    , stableSteps(io::read_or<Ind>(properties, "cflStableSteps", 10))
+    , maxFactor(io::read_or<Num>(properties, "maxCFLFactor", 1.))
+    , minFactor(io::read_or<Num>(properties, "minCFLFactor", 1e-3))
+  {
+    ASSERT(reduction > 0. && reduction < 1.,
+           "the CFL reduction must be in (0, 1)!");
+    ASSERT(growth >= 1., "the CFL growth must be >= 1!");
+    ASSERT(stableSteps > 0, "the #of stable steps must be positive!");
+    ASSERT(minFactor > 0. && minFactor <= maxFactor,
+           "the CFL factors must satisfy 0 < min <= max!");
+  }
+
+  bool enabled;
+  Num reduction;
+  Num growth;
+  Ind stableSteps;
+  Num maxFactor;
+  Num minFactor;
+};
+
+/// \brief State of the CFL controller
+struct Controller {
+  explicit Controller(const io::Properties& properties)
+    : settings(properties), factor(1.), noStableSteps(0), noRejectedSteps(0)
+  { factor = std::min(factor, settings.maxFactor); }
+
+  /// \brief Registers an accepted step
+  void accept() noexcept {
+    if (++noStableSteps >= settings.stableSteps) {
+      factor = std::min(settings.maxFactor, factor * settings.growth);
+      noStableSteps = 0;
+    }
+  }
+
+  /// \brief Registers a rejected step
+  ///
+  /// \returns false if the factor dropped below its minimum
+  bool reject() noexcept {
+    factor *= settings.reduction;
+    noStableSteps = 0;
+    ++noRejectedSteps;
+    return factor >= settings.minFactor;
+  }
+
+  const Settings settings;
+  /// Current factor of the time-step
+  Num factor;
+  /// #of accepted steps since the last change of factor
+  Ind noStableSteps;
+  /// Total #of rejected steps
+  Ind noRejectedSteps;
+};
+
+namespace detail_ {
+
+template<class F> inline void for_each_solver(F&&) noexcept {}
+template<class F, class Solver, class... Solvers>
+inline void for_each_solver(F&& f, Solver& solver,
+                            Solvers&... solvers) noexcept {
+  f(solver);
+  for_each_solver(f, solvers...);
+}
+
+}  // namespace detail_
+
+/// \brief Advances the \p solvers by a step
+///
+/// Each solver takes the time-step of the current step (e.g. the common
+/// time-step forced by coupling::apply). While the solution of any of the
+/// solvers is not valid, all of them are rolled back and retried with their
+/// time-steps multiplied by the same reduction, such that the time-steps of
+/// coupled solvers remain in the same ratio. Terminates if the CFL factor of
+/// any solver drops below its minimum.
+///
+/// \requires the solvers have the same cflReduction.
+template<class... Solvers> void solve(Solvers&... solvers) noexcept {
+  using detail_::for_each_solver;
+  for_each_solver([](auto& s) {
+    s.save_step();
+    s.evolve_step();
+  }, solvers...);
+  auto valid = [&]() {
+    bool result = true;
+    for_each_solver([&](const auto& s) {
+      result = result && s.valid_solution();
+    }, solvers...);
+    return result;
+  };
+  while (!valid()) {
+    bool canRetry = true;
+    for_each_solver([&](auto& s) { canRetry = s.reject_step() && canRetry; },
+                    solvers...);
+    if (!canRetry) {
+      TERMINATE("CFL controller: the CFL factor dropped below its minimum!");
+    }
+    for_each_solver([](auto& s) { s.evolve_step(); }, solvers...);
+  }
+  for_each_solver([](auto& s) { s.accept_step(); }, solvers...);
+}
+
+}  // namespace cfl_control
+
+////////////////////////////////////////////////////////////////////////////////
+}  // namespace fv
+}  // namespace solver
+}  // namespace hom3
+////////////////////////////////////////////////////////////////////////////////
+#endif
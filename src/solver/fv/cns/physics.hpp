@@ -160,12 +160,39 @@ struct Physics : euler::Physics<nd_, NumFlux, Solver> {
         + compute_num_flux_viscous_<_>(lIdx, rIdx, d, dx, dt, NumFlux());
   }
 
+  /// \brief Computes the convective (inviscid) part of the numerical flux at
+  /// the interface between \p lIdx and \p rIdx
+  template<class _>
+  inline NumA<nvars> compute_num_flux
+  (const CellIdx lIdx, const CellIdx rIdx, const SInd d, const Num dx,
+    const Num dt, flux_part::convective) const noexcept {
+    return Euler::template
+        compute_num_flux_<_>(lIdx, rIdx, d, dx, dt, NumFlux());
+  }
+
+  /// \brief Computes the diffusive (viscous) part of the numerical flux at
+  /// the interface between \p lIdx and \p rIdx
+  template<class _>
+  inline NumA<nvars> compute_num_flux
+  (const CellIdx lIdx, const CellIdx rIdx, const SInd d, const Num dx,
+    const Num dt, flux_part::diffusive) const noexcept {
+    return compute_num_flux_viscous_<_>(lIdx, rIdx, d, dx, dt, NumFlux());
+  }
+
   /// \brief computes dt at cell \p lIdx
   ///
   /// $\min_{dt_\mathrm{inviscid}, dt_\mathrm{viscous}}$ where $dt_viscous =
   /// \frac{h^2}{ \mu / \rho }$
+  ///
+  /// Implicit and IMEX time integration methods aren't bounded by the viscous
+  /// limit: their time-step is dt_inviscid.
   template<class _> inline Num compute_dt(const CellIdx cIdx) const noexcept {
     const auto dt_inviscid = Euler::template compute_dt<_>(cIdx);
+    using TI = typename Solver::time_integration_type;
+    if (time_integration::is_implicit<TI>::value
+        || time_integration::is_imex<TI>::value) {
+      return dt_inviscid;
+    }
 
     const Num h = b_()->cells().length(cIdx);
 
@@ -210,9 +237,9 @@ struct Physics : euler::Physics<nd_, NumFlux, Solver> {
   (const Num gamma, const Num p, const Num rho) noexcept
   { return gamma * p / rho; }
   inline Num mu(const Num T) const noexcept
-  { return quantities.sutherlands_law(T); }
+  { return quantities.viscosity(T); }
   template<class _> inline Num mu(const CellIdx cIdx) const noexcept
-  { return quantities.sutherlands_law(this->template T<_>(cIdx)); }
+  { return quantities.viscosity(this->template T<_>(cIdx)); }
 
   /// Numerical fluxes implementation
   ///@{
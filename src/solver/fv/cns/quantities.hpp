@@ -5,6 +5,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "globals.hpp"
 #include "solver/fv/euler/quantities.hpp"
+#include "sutherland_fit.hpp"
 ////////////////////////////////////////////////////////////////////////////////
 namespace hom3 { namespace solver { namespace fv { namespace cns {
 ////////////////////////////////////////////////////////////////////////////////
@@ -20,6 +21,13 @@ struct Quantities : euler::Quantities {
   /// - free-stream Reynoldsh number
   /// - stagnation Prandtl number
   /// - Sutherland's constant
+  ///
+  /// Optional properties (default values in parentheses):
+  /// - sutherlandFit: evaluates the viscosity with a fit of Sutherland's law
+  ///   within the fit's temperature range (false), see SutherlandFit
+  /// - sutherlandFitTmin, sutherlandFitTmax: temperature range of the fit
+  ///   (100 K, 1000 K)
+  /// - sutherlandFitTolerance: bound of the relative error of the fit (1e-8)
   explicit Quantities(io::Properties properties) noexcept
     : euler::Quantities(properties)
     , ReInfty_(io::read<quantity::Dimensionless>(properties, "ReInfty"))
@@ -27,6 +35,14 @@ struct Quantities : euler::Quantities {
     , S0_(io::read<quantity::Temperature>(properties, "Sutherland0"))
     , sOverTref_(S0_ / T0_)
     , sOverTrefP1_(sOverTref_ + 1.0)
+    , fitViscosity_(io::read_or<bool>(properties, "sutherlandFit", false))
+    , sutherlandFit_
+      (sOverTref_,
+       T(io::read_or<quantity::Temperature>
+         (properties, "sutherlandFitTmin", 100. * unit::kelvin)),
+       T(io::read_or<quantity::Temperature>
+         (properties, "sutherlandFitTmax", 1000. * unit::kelvin)),
+       io::read_or<Num>(properties, "sutherlandFitTolerance", 1e-8))
     , Re0_(Re_infinity() * mu_infinity() / (rho_infinity() * u_infinity())) {
     std::cerr << "Free-stream variables: "
               << "ReInfty = " << ReInfty_ << " "
@@ -38,6 +54,12 @@ struct Quantities : euler::Quantities {
               << "Re0 = " << Re0_ << " "
               << "mu0 = " << mu0()
               << "\n";
+    if (fitViscosity_) {
+      std::cerr << "Sutherland's law fit: "
+                << "#intervals = " << sutherlandFit_.no_intervals() << " "
+                << "error bound = " << sutherlandFit_.error_bound()
+                << "\n";
+    }
   }
 
   /// \name Input/Output Variables
@@ -114,6 +136,17 @@ struct Quantities : euler::Quantities {
     return std::pow(T, 1.5) * sOverTrefP1_ / (T + sOverTref_);
   }
 
+  /// \brief Viscosity at the dimensionless temperature \p T: Sutherland's
+  /// law, or its fit if enabled and \p T is within the fit's range
+  inline Num viscosity(const Num T) const noexcept {
+    return fitViscosity_ && sutherlandFit_.in_range(T) ? sutherlandFit_(T)
+                                                       : sutherlands_law(T);
+  }
+
+  /// \brief Fit of Sutherland's law (see viscosity)
+  inline const SutherlandFit& sutherland_fit() const noexcept
+  { return sutherlandFit_; }
+
  private:
   /// Free stream Reynolds' number: \mathrm{Re}_\infty = \frac{
   /// \overline{\rho}_\infty \overline{u}_\infty \overline{L}_\mathrm{ref} }
@@ -129,6 +162,10 @@ struct Quantities : euler::Quantities {
   /// Sutherland's constant over reference temperature plus one: S /
   /// T_\mathrm{ref} + 1
   const quantity::Dimensionless sOverTrefP1_;
+  /// Is the viscosity evaluated with sutherlandFit_?
+  const bool fitViscosity_;
+  /// Fit of Sutherland's law
+  const SutherlandFit sutherlandFit_;
   /// Stagnation Reynold's number: \mathrm{Re}_0 = \frac{ \mathrm{Re}_\infty
   /// \mu_\infty }{ \rho_\infty u_\infty }
   const quantity::Dimensionless Re0_;
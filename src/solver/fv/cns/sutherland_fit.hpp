@@ -0,0 +1,129 @@
+#ifndef HOM3_SOLVERS_FV_CNS_SUTHERLAND_FIT_HPP_
+#define HOM3_SOLVERS_FV_CNS_SUTHERLAND_FIT_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Piecewise-cubic fit of Sutherland's law with an error bound
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <algorithm>
+#include <cmath>
+#include "globals.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv { namespace cns {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Piecewise-cubic Hermite interpolant of Sutherland's law
+///
+///   \mu (T) = (1 + s) T^{3/2} / (T + s),  s = S / T_{\mathrm{ref}}
+///
+/// on the uniform intervals of the dimensionless temperature range [Tmin,
+/// Tmax], which avoids the std::pow of the law.
+///
+/// The number of intervals is chosen such that the interpolation error bound
+/// h^4 / 384 max |\mu''''| of each interval, divided by the minimum of \mu in
+/// the interval, is smaller than the relative tolerance. The derivatives of
+/// \mu are bounded with Leibniz's rule from those of T^{3/2} and 1 / (T + s),
+/// which are monotonic. Round-off errors are not included in the bound.
+struct SutherlandFit {
+  SutherlandFit(const Num sOverTref, const Num Tmin, const Num Tmax,
+                const Num tolerance) noexcept
+    : sOverTref_(sOverTref), Tmin_(Tmin), Tmax_(Tmax)
+  {
+    ASSERT(Tmin > 0. && Tmin < Tmax, "invalid temperature range!");
+    ASSERT(tolerance > 0., "the tolerance must be positive!");
+    Ind noIntervals = 16;
+    errorBound_ = error_bound(noIntervals);
+    while (errorBound_ > tolerance) {
+      noIntervals = std::max(noIntervals + 1, static_cast<Ind>(std::ceil(
+        noIntervals * std::pow(errorBound_ / tolerance, 0.25))));
+      if (noIntervals > maxNoIntervals_) {
+        TERMINATE("Sutherland's law fit: the tolerance is too small!");
+      }
+      errorBound_ = error_bound(noIntervals);
+    }
+
+    const Num h = (Tmax_ - Tmin_) / noIntervals;
+    invH_ = 1. / h;
+    coefficients_.resize(noIntervals);
+    for (Ind i = 0; i != noIntervals; ++i) {
+      const Num a = Tmin_ + i * h;
+      const Num b = i + 1 == noIntervals ? Tmax_ : a + h;
+      const Num f0 = exact(a), f1 = exact(b);
+      const Num d0 = h * derivative(a), d1 = h * derivative(b);
+      coefficients_[i] << f0, d0, 3. * (f1 - f0) - 2. * d0 - d1,
+                          2. * (f0 - f1) + d0 + d1;
+    }
+  }
+
+  /// \brief Is the temperature \p T within the range of the fit?
+  inline bool in_range(const Num T) const noexcept
+  { return T >= Tmin_ && T <= Tmax_; }
+
+  /// \brief Fitted viscosity at the temperature \p T (must be in range)
+  inline Num operator()(const Num T) const noexcept {
+    const Num x = (T - Tmin_) * invH_;
+    const Ind i = std::min(static_cast<Ind>(x), no_intervals() - 1);
+    const Num t = x - i;
+    const auto& c = coefficients_[i];
+    return c(0) + t * (c(1) + t * (c(2) + t * c(3)));
+  }
+
+  /// \brief Sutherland's law at the temperature \p T
+  inline Num exact(const Num T) const noexcept
+  { return T * std::sqrt(T) * (1. + sOverTref_) / (T + sOverTref_); }
+
+  /// \brief Bound of the relative error of the fit
+  inline Num error_bound() const noexcept { return errorBound_; }
+
+  inline Ind no_intervals() const noexcept { return coefficients_.size(); }
+
+ private:
+  const Num sOverTref_;
+  const Num Tmin_;
+  const Num Tmax_;
+  Num invH_;
+  Num errorBound_;
+  /// Coefficients of the cubic of each interval in the local coordinate
+  /// t \in [0, 1]
+  NumAV<4> coefficients_;
+  static const Ind maxNoIntervals_ = 1 << 20;
+
+  /// \brief Derivative of Sutherland's law at \p T
+  inline Num derivative(const Num T) const noexcept {
+    const Num s = sOverTref_;
+    return (1. + s) * std::sqrt(T) * (0.5 * T + 1.5 * s) / std::pow(T + s, 2);
+  }
+
+  /// \brief Relative error bound of the fit with \p noIntervals intervals
+  Num error_bound(const Ind noIntervals) const noexcept {
+    const Num s = sOverTref_;
+    const Num h = (Tmax_ - Tmin_) / noIntervals;
+    Num bound = 0.;
+    for (Ind i = 0; i != noIntervals; ++i) {
+      const Num a = Tmin_ + i * h;
+      const Num b = a + h;
+      // maxima of |d^j T^{3/2} / dT^j| and |d^k (T + s)^{-1} / dT^k| in [a, b]
+      const Num u[] = {b * std::sqrt(b), 1.5 * std::sqrt(b),
+                       0.75 / std::sqrt(a), 0.375 / (a * std::sqrt(a)),
+                       0.5625 / (a * a * std::sqrt(a))};
+      const Num binomial[] = {1., 4., 6., 4., 1.};
+      Num v = 1. / (a + s);
+      Num d4 = 0.;
+      for (SInd k = 0; k != 5; ++k) {
+        d4 += binomial[k] * u[4 - k] * v;
+        v *= (k + 1) / (a + s);
+      }
+      d4 *= 1. + s;
+      // mu is increasing: its minimum in [a, b] is mu(a)
+      bound = std::max(bound, std::pow(h, 4) / 384. * d4 / exact(a));
+    }
+    return bound;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+}  // namespace cns
+}  // namespace fv
+}  // namespace solver
+}  // namespace hom3
+////////////////////////////////////////////////////////////////////////////////
+#endif
@@ -20,6 +20,13 @@ namespace viscous_ { struct three_point {}; }
 
 /// \brief Standard numerical flux for the Navier-Stokes physics
 struct standard : inviscid_::ausm, viscous_::three_point {};
+/// \brief Numerical flux with the HLLC inviscid flux
+struct hllc : inviscid_::hllc, viscous_::three_point {};
+/// \brief Numerical flux with the Roe inviscid flux
+struct roe : inviscid_::roe, viscous_::three_point {};
+/// \brief Numerical flux with the inviscid flux selected at run-time (see
+/// euler::flux::by_property)
+struct by_property : inviscid_::by_property, viscous_::three_point {};
 }  // namespace flux
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1,6 +1,7 @@
 /// \brief Tests for the FV solver of the Compressible Navier-Stokes equations.
 ////////////////////////////////////////////////////////////////////////////////
 /// Includes:
+#include <cmath>
 #include "solver/fv/cns.hpp"
 #include "solver/fv/utilities.hpp"
 #include "geometry/geometry.hpp"
@@ -281,6 +282,138 @@ TEST(cns_fv_solver, flow_past_cube) {
                          outputInterval);
 }
 
+/// \test BDF2 steps beyond the viscous time-step limit conserve mass in a
+/// periodic domain
+TEST(cns_fv_solver, implicit_bdf2_periodic) {
+  using ImplicitSolver = cns_physics::Solver
+                         <nd, flux, solver::fv::time_integration::bdf2>;
+  const auto rootCell = grid::RootCell<nd> {
+    NumA<nd>{0., 0.}, NumA<nd>{1., 1.}
+  };
+  const SInd implicitRefLevel = 4;
+  auto grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>
+    (rootCell, implicitRefLevel, 1, std::array<bool, nd>{{true, true}})
+  };
+
+  /// Low Reynolds number: explicit steps would be bound by the viscous limit
+  auto implicitSolver = ImplicitSolver {
+    cnsSolverIdx,
+    cns_properties<nd>(&grid, 0.05, 1., [&](const NumA<nd>) { return true; })
+  };
+
+  auto bump_ic = [&](const NumA<nd> x) {
+    NumA<nvars> pvars = NumA<nvars>::Zero();
+    pvars(V::rho()) = implicitSolver.quantities.rho_infinity()
+        * (1. + 0.1 * std::exp(-(x - NumA<nd>::Constant(0.5)).squaredNorm()
+                               / 0.01));
+    pvars(V::u(0)) = implicitSolver.quantities.u_infinity();
+    pvars(V::p()) = implicitSolver.quantities.p_infinity();
+    return implicitSolver.cv(pvars);
+  };
+  implicitSolver.set_initial_condition(bump_ic);
+  solver::fv::initialize(grid, implicitSolver);
+
+  auto mass = [&]() {
+    Num result = 0.;
+    for (auto cIdx : implicitSolver.internal_cells()) {
+      result += implicitSolver.Q<solver::fv::lhs_tag>(cIdx, V::rho())
+                * std::pow(implicitSolver.cells().length(cIdx), nd);
+    }
+    return result;
+  };
+
+  const Num initialMass = mass();
+  while (implicitSolver.time() < implicitSolver.final_time()) {
+    implicitSolver.solve();
+  }
+  EXPECT_NEAR(mass(), initialMass, 1e-8 * initialMass);
+  for (auto cIdx : implicitSolver.internal_cells()) {
+    EXPECT_GT(implicitSolver.Q<solver::fv::lhs_tag>(cIdx, V::rho()), 0.);
+  }
+}
+
+TEST(cns_fv_solver, imex_periodic) {
+  using ImexSolver = cns_physics::Solver
+                     <nd, flux, solver::fv::time_integration::imex_runge_kutta_2>;
+  const auto rootCell = grid::RootCell<nd> {
+    NumA<nd>{0., 0.}, NumA<nd>{1., 1.}
+  };
+  const SInd imexRefLevel = 4;
+  auto grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>
+    (rootCell, imexRefLevel, 1, std::array<bool, nd>{{true, true}})
+  };
+
+  /// Low Reynolds number: only the viscous fluxes are stiff
+  auto imexSolver = ImexSolver {
+    cnsSolverIdx,
+    cns_properties<nd>(&grid, 0.05, 1., [&](const NumA<nd>) { return true; })
+  };
+
+  auto bump_ic = [&](const NumA<nd> x) {
+    NumA<nvars> pvars = NumA<nvars>::Zero();
+    pvars(V::rho()) = imexSolver.quantities.rho_infinity()
+        * (1. + 0.1 * std::exp(-(x - NumA<nd>::Constant(0.5)).squaredNorm()
+                               / 0.01));
+    pvars(V::u(0)) = imexSolver.quantities.u_infinity();
+    pvars(V::p()) = imexSolver.quantities.p_infinity();
+    return imexSolver.cv(pvars);
+  };
+  imexSolver.set_initial_condition(bump_ic);
+  solver::fv::initialize(grid, imexSolver);
+
+  auto mass = [&]() {
+    Num result = 0.;
+    for (auto cIdx : imexSolver.internal_cells()) {
+      result += imexSolver.Q<solver::fv::lhs_tag>(cIdx, V::rho())
+                * std::pow(imexSolver.cells().length(cIdx), nd);
+    }
+    return result;
+  };
+
+  const Num initialMass = mass();
+  while (imexSolver.time() < imexSolver.final_time()) {
+    imexSolver.solve();
+  }
+  EXPECT_NEAR(mass(), initialMass, 1e-8 * initialMass);
+  for (auto cIdx : imexSolver.internal_cells()) {
+    EXPECT_GT(imexSolver.Q<solver::fv::lhs_tag>(cIdx, V::rho()), 0.);
+  }
+}
+
+/// \test the fit of Sutherland's law is within its error bound of the exact
+/// law in the fit's temperature range, and equals the exact law outside it
+TEST(cns_fv_solver, sutherland_fit) {
+  using namespace quantity; using namespace unit;
+  auto properties = cns_properties<nd>(nullptr, 1., 100.,
+                                       [](const NumA<nd>) { return true; });
+  io::insert<bool>(properties, "sutherlandFit", true);
+  io::insert<Temperature>(properties, "sutherlandFitTmin", 150. * kelvin);
+  io::insert<Temperature>(properties, "sutherlandFitTmax", 600. * kelvin);
+  io::insert<Num>(properties, "sutherlandFitTolerance", 1e-10);
+  const auto quantities = cns_physics::Quantities{properties};
+  const auto& fit = quantities.sutherland_fit();
+  EXPECT_LE(fit.error_bound(), 1e-10);
+
+  const Num Tmin = quantities.T(150. * kelvin);
+  const Num Tmax = quantities.T(600. * kelvin);
+  const Ind noSamples = 100000;
+  Num maxError = 0.;
+  for (Ind i = 0; i <= noSamples; ++i) {
+    const Num T = Tmin + (Tmax - Tmin) * i / noSamples;
+    const Num exact = quantities.sutherlands_law(T);
+    maxError = std::max(maxError,
+                        std::abs(quantities.viscosity(T) - exact) / exact);
+  }
+  EXPECT_GT(maxError, 0.);
+  EXPECT_LE(maxError, fit.error_bound() + 1e-14);
+
+  for (const Num T : {0.5 * Tmin, 2. * Tmax}) {
+    EXPECT_EQ(quantities.viscosity(T), quantities.sutherlands_law(T));
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 #undef ENABLE_DBG_
 ////////////////////////////////////////////////////////////////////////////////
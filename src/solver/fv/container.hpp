@@ -138,7 +138,7 @@ struct Value : container::sequential::ValueFacade<Container<nd, nvars>> {
   }
 
   template<class Value1, class Value2>
-  static inline void copy_values(Value1& to, Value2& from) noexcept {
+  static inline void copy_values(Value1& from, Value2& to) noexcept {
     to.bc_idx()   = from.bc_idx();
     to.node_idx() = from.node_idx();
     to.length()   = from.length();
@@ -6,6 +6,7 @@
 /// Includes:
 #include <algorithm>
 #include <type_traits>
+#include "solver/fv/cfl_control.hpp"
 #include "solver/fv/heat/tags.hpp"
 #include "solver/fv/cns/tags.hpp"
 ////////////////////////////////////////////////////////////////////////////////
@@ -72,6 +73,25 @@ template<class Solver> inline void apply(Solver& s1, Solver& s2) noexcept {
   s2.dt(dt);
 }
 
+/// \brief Advances the coupled solvers \p s0 and \p s1 by a step with the
+/// time-steps set by apply
+///
+/// With the CFL controller enabled, the decision to reject a step is taken
+/// for both solvers: if the solution of either of them is not valid, both
+/// are rolled back and retried with the same reduced time-step (see
+/// cfl_control::solve).
+template<class Solver0, class Solver1>
+inline void solve(Solver0& s0, Solver1& s1) noexcept {
+  ASSERT(s0.cfl_controlled() == s1.cfl_controlled(),
+         "either both or none of the coupled solvers must be CFL controlled!");
+  if (s0.cfl_controlled()) {
+    cfl_control::solve(s0, s1);
+  } else {
+    s0.solve();
+    s1.solve();
+  }
+}
+
 }  // namespace coupling
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -49,7 +49,7 @@ NumA<nd + 2> isentropic_vortex(const NumA<nd>, const Num) noexcept {
 ///
 /// Can be customized along 2 directions only (x0, y1).
 template<SInd nd>
-auto shock_tube(const Num dir, const Num angle, const Num x0,
+auto shock_tube(const SInd dir, const Num angle, const Num x0,
                 const Num rhoL, const Num umagL, const Num pL,
                 const Num rhoR, const Num umagR, const Num pR) {
   auto ic = [=](const NumA<nd> x) {
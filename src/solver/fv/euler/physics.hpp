@@ -36,9 +36,17 @@ template<SInd nd_, class NumFlux, class Solver> struct Physics {
   ///
   /// Requires property:
   /// - CFL
+  ///
+  /// Optional properties (default values in parentheses):
+  /// - numericalFlux: see flux::by_property (ausm)
+  /// - roeEntropyFix: width of Harten's entropy fix of the Roe flux relative
+  ///   to the speed of sound (0.1)
   explicit Physics(io::Properties properties) noexcept
     : quantities(properties)
     , cfl_(io::read<Num>(properties, "CFL"))
+    , numericalFlux_(numerical_flux_
+                     (io::read_or<String>(properties, "numericalFlux", "ausm")))
+    , roeEntropyFix_(io::read_or<Num>(properties, "roeEntropyFix", 0.1))
   {}
 
   /// \name Variable Access
@@ -177,6 +185,19 @@ template<SInd nd_, class NumFlux, class Solver> struct Physics {
     const Num dt) const noexcept
   { return compute_num_flux_<_>(lIdx, rIdx, d, dx, dt, NumFlux()); }
 
+  /// \brief Fills the flux cache of the \p _ variables of all cells if the
+  /// numerical flux is cached (see flux::cached)
+  ///
+  /// The \p _ variables must not change until release_num_fluxes<_>().
+  template<class _> void prepare_num_fluxes() noexcept
+  { prepare_num_fluxes_<_>(NumFlux()); }
+
+  /// \brief Invalidates the flux cache of the \p _ variables: the cached
+  /// fluxes are evaluated from the cell variables until the next
+  /// prepare_num_fluxes<_>()
+  template<class _> void release_num_fluxes() noexcept
+  { flux_cache_(_()).valid = false; }
+
   /// \brief computes dt at cell \p cIdx
   /// \min_{u_i \in \mathbf{u}} ( \frac{C * h_{cell}}{u_i + a} )
   template<class _> inline Num compute_dt(const CellIdx cIdx) const noexcept {
@@ -238,6 +259,12 @@ template<SInd nd_, class NumFlux, class Solver> struct Physics {
                              << ") in cell: " << cIdx << "!\n");
   }
 
+  /// \brief Are the density, energy, and pressure of \p cIdx positive?
+  template<class _>
+  inline bool valid_variables(const CellIdx cIdx) const noexcept {
+    return rho<_>(cIdx) > 0 && rho_E<_>(cIdx) > 0 && p<_>(cIdx) > 0;
+  }
+
   /// Physical quantities
   const Quantities quantities;
 
@@ -245,6 +272,43 @@ template<SInd nd_, class NumFlux, class Solver> struct Physics {
   /// CFL number
   const Num cfl_;
 
+  /// Numerical fluxes that can be selected at run-time
+  enum class NumericalFlux { ausm, lax_friedrichs, hllc, roe };
+  /// Numerical flux selected at run-time (see flux::by_property)
+  const NumericalFlux numericalFlux_;
+  /// Relative width of the entropy fix of the Roe flux
+  const Num roeEntropyFix_;
+
+  /// \brief Numerical flux named \p name
+  static NumericalFlux numerical_flux_(const String name) noexcept {
+    if (name == "ausm") { return NumericalFlux::ausm; }
+    if (name == "laxFriedrichs") { return NumericalFlux::lax_friedrichs; }
+    if (name == "hllc") { return NumericalFlux::hllc; }
+    if (name == "roe") { return NumericalFlux::roe; }
+    TERMINATE("unknown numerical flux: " + name);
+  }
+
+  /// \brief Cell quantities read by the cached fluxes (see flux::cached)
+  struct FluxCache {
+    bool valid = false;
+    /// lax_friedrichs: F_d(q) of cell cIdx at cIdx * nd + d,
+    /// ausm: theta of cell cIdx at cIdx
+    NumAV<nvars> f;
+    std::vector<Num> p;  ///< ausm: pressure
+    std::vector<Num> a;  ///< ausm: speed of sound
+  };
+  /// Flux caches of the lhs and the rhs variables
+  FluxCache fluxCaches_[2];
+
+  inline       FluxCache& flux_cache_(lhs_tag)       noexcept
+  { return fluxCaches_[0]; }
+  inline const FluxCache& flux_cache_(lhs_tag) const noexcept
+  { return fluxCaches_[0]; }
+  inline       FluxCache& flux_cache_(rhs_tag)       noexcept
+  { return fluxCaches_[1]; }
+  inline const FluxCache& flux_cache_(rhs_tag) const noexcept
+  { return fluxCaches_[1]; }
+
   /// CRTP:
         Solver* b_()       noexcept { return static_cast<Solver*>(this); }
   const Solver* b_() const noexcept { return static_cast<const Solver*>(this); }
@@ -253,17 +317,101 @@ template<SInd nd_, class NumFlux, class Solver> struct Physics {
   /// Numerical fluxes implementation
   ///@{
 
+  /// \brief Computes the \p d -th component of the numerical flux \p Flux at
+  /// the surface between the cells \p lIdx and \p rIdx from their cell values
+  /// (first-order)
+  template<class _, class Flux> inline NumA<nvars> compute_num_flux_
+  (const CellIdx lIdx, const CellIdx rIdx, const SInd d, const Num dx,
+    const Num dt, Flux) const noexcept {
+    return state_num_flux_(cv(_(), lIdx), cv(_(), rIdx), d, dx, dt, Flux());
+  }
+
+  /// \name MUSCL reconstruction (van Leer 1979)
+  ///@{
+
+  /// \brief Computes the \p d -th component of the numerical flux \p Flux at
+  /// the surface between the cells \p lIdx and \p rIdx from the face states
+  /// reconstructed with the slope limiter \p Limiter (second-order)
+  ///
+  /// The primitive variables are reconstructed from the limited one-sided
+  /// surface slopes, which keeps the face pressure positive in strong
+  /// expansions. The slopes are the differences divided by the distances
+  /// between the cell centers (see Solver::center_distance), which are not
+  /// uniform across level interfaces. Cells lacking a neighbor in direction
+  /// \p d (i.e. ghost cells) and faces at which the reconstruction yields a
+  /// non-positive density or pressure fall back to the first-order flux.
+  template<class _, class Flux, class Limiter> inline NumA<nvars>
+  compute_num_flux_(const CellIdx lIdx, const CellIdx rIdx, const SInd d,
+                    const Num dx, const Num dt, flux::muscl<Flux, Limiter>)
+  const noexcept {
+    using namespace container::hierarchical;
+    const NumA<nvars> qL = cv(_(), lIdx);
+    const NumA<nvars> qR = cv(_(), rIdx);
+    const auto llIdx
+      = b_()->cells().neighbors(lIdx, neighbor_position(d, neg_dir));
+    const auto rrIdx
+      = b_()->cells().neighbors(rIdx, neighbor_position(d, pos_dir));
+    const NumA<nvars> wL = pv(qL);
+    const NumA<nvars> wR = pv(qR);
+    const NumA<nvars> slopeLR = (wR - wL) / b_()->center_distance(lIdx, rIdx);
+
+    NumA<nvars> wLf = wL, wRf = wR;
+    if (is_valid(llIdx)) {
+      const NumA<nvars> slopeL
+        = (wL - pv(_(), llIdx)) / b_()->center_distance(llIdx, lIdx);
+      wLf += 0.5 * b_()->cells().length(lIdx)
+             * limit_(slopeL, slopeLR, Limiter());
+    }
+    if (is_valid(rrIdx)) {
+      const NumA<nvars> slopeR
+        = (pv(_(), rrIdx) - wR) / b_()->center_distance(rIdx, rrIdx);
+      wRf -= 0.5 * b_()->cells().length(rIdx)
+             * limit_(slopeLR, slopeR, Limiter());
+    }
+    if (!is_admissible_(wLf) || !is_admissible_(wRf)) {
+      return state_num_flux_(qL, qR, d, dx, dt, Flux());
+    }
+    return state_num_flux_(cv(wLf), cv(wRf), d, dx, dt, Flux());
+  }
+
+  /// \brief Limited slope from the backward and forward slopes \p a and \p b
+  /// (component-wise)
+  template<class Limiter> static inline NumA<nvars> limit_
+  (const NumA<nvars>& a, const NumA<nvars>& b, Limiter) noexcept {
+    NumA<nvars> result;
+    for (SInd v = 0; v != nvars; ++v) {
+      result(v) = a(v) * b(v) > 0. ? limit_(a(v), b(v), Limiter()) : 0.;
+    }
+    return result;
+  }
+  /// \brief Limiters for slopes \p a and \p b with the same sign
+  static inline Num limit_(const Num a, const Num b, limiter::minmod) noexcept
+  { return a > 0. ? std::min(a, b) : std::max(a, b); }
+  static inline Num limit_(const Num a, const Num b, limiter::van_leer)
+  noexcept { return 2. * a * b / (a + b); }
+  static inline Num limit_(const Num a, const Num b, limiter::mc) noexcept {
+    const Num s = a > 0. ? 1. : -1.;
+    return s * std::min({2. * std::abs(a), 2. * std::abs(b),
+                         0.5 * std::abs(a + b)});
+  }
+
+  /// \brief Does the primitive state \p w have a positive density and
+  /// pressure?
+  static inline bool is_admissible_(const NumA<nvars>& w) noexcept
+  { return w(V::rho()) > 0. && w(V::p()) > 0.; }
+
+  ///@}
+
   /// \name Local-Lax-Friedrichs Flux
   ///@{
 
-  /// \brief Computes the \p d -th component of the Local-Lax_Friedrichs flux at
-  /// the surface between the cells \p lIdx and \p rIdx. The distance between
+  /// \brief Computes the \p d -th component of the Local-Lax_Friedrichs flux
+  /// between the conservative states \p qL and \p qR. The distance between
   /// the cell centers is \p dx and the time-step is \p dt
-  template<class _> inline NumA<nvars> compute_num_flux_
-  (const CellIdx lIdx, const CellIdx rIdx, const SInd d, const Num dx,
+  inline NumA<nvars> state_num_flux_
+  (const NumA<nvars>& qL, const NumA<nvars>& qR, const SInd d, const Num dx,
     const Num dt, flux::lax_friedrichs) const noexcept {
-    return 0.5 * (flux<_>(lIdx, d) + flux<_>(rIdx, d)
-                  + dx / dt * (Q(_(), lIdx) - Q(_(), rIdx)));
+    return 0.5 * (flux_(qL, d) + flux_(qR, d) + dx / dt * (qL - qR));
   }
 
   ///@}
@@ -271,28 +419,246 @@ template<SInd nd_, class NumFlux, class Solver> struct Physics {
   /// \name Advection Upstream Splitting Method (Liu-Steffen 1993)
   ///@{
 
-  /// \brief Computes the \p -dth component of the AUSM flux at the surface
-  /// between the cells \p lIdx and \p rIdx.
-  template<class _> inline NumA<nvars> compute_num_flux_
-  (const CellIdx lIdx, const CellIdx rIdx, const SInd d, const Num,
+  /// \brief Computes the \p -dth component of the AUSM flux between the
+  /// conservative states \p qL and \p qR.
+  inline NumA<nvars> state_num_flux_
+  (const NumA<nvars>& qL, const NumA<nvars>& qR, const SInd d, const Num,
     const Num, flux::ausm) const noexcept {
-    const Num ML = u<_>(lIdx, d) / a<_>(lIdx);
-    const Num MR = u<_>(rIdx, d) / a<_>(rIdx);
+    const Num pL = p_(qL);
+    const Num pR = p_(qR);
+    const Num aL = a_(qL, pL);
+    const Num aR = a_(qR, pR);
+    const Num ML = qL(V::rho_u(d)) / qL(V::rho()) / aL;
+    const Num MR = qR(V::rho_u(d)) / qR(V::rho()) / aR;
 
     const Num m_i = m_int_<+1>(ML) + m_int_<-1>(MR);
-    const Num p_i = p_int_<+1>(ML) * p<_>(lIdx) + p_int_<-1>(MR) * p<_>(rIdx);
+    const Num p_i = p_int_<+1>(ML) * pL + p_int_<-1>(MR) * pR;
 
-    NumA<nvars> f_i = m_i >= 0 ? theta_<_>(lIdx) : theta_<_>(rIdx);
+    NumA<nvars> f_i = m_i >= 0 ? theta_(qL, pL, aL) : theta_(qR, pR, aR);
 
     f_i *= m_i;
     f_i(V::rho_u(d)) += p_i;
 
-    DBGV((lIdx)(rIdx)(d)(ML)(MR)(u_mag<_>(lIdx))(u_mag<_>(rIdx))
-         (a<_>(lIdx))(a<_>(rIdx))(m_i)(p_i)(f_i));
+    DBGV((d)(ML)(MR)(aL)(aR)(m_i)(p_i)(f_i));
+    return f_i;
+  }
+
+  ///@}
+
+  /// \name Cached fluxes
+  ///@{
+
+  /// \brief Computes the \p d -th component of the numerical flux \p Flux at
+  /// the surface between the cells \p lIdx and \p rIdx from the flux cache
+  /// of the \p _ variables, or from their cell values if it is not valid
+  template<class _, class Flux> inline NumA<nvars> compute_num_flux_
+  (const CellIdx lIdx, const CellIdx rIdx, const SInd d, const Num dx,
+    const Num dt, flux::cached<Flux>) const noexcept {
+    const auto& c = flux_cache_(_());
+    if (!c.valid) {
+      return compute_num_flux_<_>(lIdx, rIdx, d, dx, dt, Flux());
+    }
+    return cached_num_flux_<_>(c, lIdx, rIdx, d, dx, dt, Flux());
+  }
+
+  /// \brief Numerical fluxes without cache: nothing to prepare
+  template<class _, class Flux> void prepare_num_fluxes_(Flux) noexcept {}
+
+  template<class _, class Flux>
+  void prepare_num_fluxes_(flux::cached<Flux>) noexcept {
+    auto& c = flux_cache_(_());
+    fill_flux_cache_<_>(c, Flux());
+    c.valid = true;
+  }
+
+  /// \brief Local-Lax-Friedrichs: caches F_d(q) of each cell and direction
+  template<class _>
+  void fill_flux_cache_(FluxCache& c, flux::lax_friedrichs) noexcept {
+    c.f.resize(b_()->cells().size() * nd);
+    for (auto cIdx : b_()->cell_ids()) {
+      const NumA<nvars> q = cv(_(), cIdx);
+      const Num pressure = p_(q);
+      for (SInd d = 0; d != nd; ++d) {
+        c.f[cIdx() * nd + d] = flux_(q, pressure, d);
+      }
+    }
+  }
+
+  template<class _> inline NumA<nvars> cached_num_flux_
+  (const FluxCache& c, const CellIdx lIdx, const CellIdx rIdx, const SInd d,
+   const Num dx, const Num dt, flux::lax_friedrichs) const noexcept {
+    return 0.5 * (c.f[lIdx() * nd + d] + c.f[rIdx() * nd + d]
+                  + dx / dt * (cv(_(), lIdx) - cv(_(), rIdx)));
+  }
+
+  /// \brief AUSM: caches the pressure, speed of sound, and theta of each cell
+  template<class _>
+  void fill_flux_cache_(FluxCache& c, flux::ausm) noexcept {
+    const auto noCells = b_()->cells().size();
+    c.f.resize(noCells);
+    c.p.resize(noCells);
+    c.a.resize(noCells);
+    for (auto cIdx : b_()->cell_ids()) {
+      const NumA<nvars> q = cv(_(), cIdx);
+      const Num pressure = p_(q);
+      const Num soundSpeed = a_(q, pressure);
+      c.p[cIdx()] = pressure;
+      c.a[cIdx()] = soundSpeed;
+      c.f[cIdx()] = theta_(q, pressure, soundSpeed);
+    }
+  }
+
+  template<class _> inline NumA<nvars> cached_num_flux_
+  (const FluxCache& c, const CellIdx lIdx, const CellIdx rIdx, const SInd d,
+   const Num, const Num, flux::ausm) const noexcept {
+    const Num ML = u<_>(lIdx, d) / c.a[lIdx()];
+    const Num MR = u<_>(rIdx, d) / c.a[rIdx()];
+
+    const Num m_i = m_int_<+1>(ML) + m_int_<-1>(MR);
+    const Num p_i
+      = p_int_<+1>(ML) * c.p[lIdx()] + p_int_<-1>(MR) * c.p[rIdx()];
+
+    NumA<nvars> f_i = m_i >= 0 ? c.f[lIdx()] : c.f[rIdx()];
+    f_i *= m_i;
+    f_i(V::rho_u(d)) += p_i;
     return f_i;
   }
 
+  ///@}
+
+  /// \name Harten-Lax-van Leer-Contact Flux (Toro-Spruce-Speares 1994)
+  ///@{
+
+  /// \brief Computes the \p d -th component of the HLLC flux between the
+  /// conservative states \p qL and \p qR. The wave speeds are estimated
+  /// from the Roe averages (Einfeldt 1988).
+  inline NumA<nvars> state_num_flux_
+  (const NumA<nvars>& qL, const NumA<nvars>& qR, const SInd d, const Num,
+    const Num, flux::hllc) const noexcept {
+    const Num pL = p_(qL);
+    const Num pR = p_(qR);
+    const Num uL = qL(V::rho_u(d)) / qL(V::rho());
+    const Num uR = qR(V::rho_u(d)) / qR(V::rho());
+    const auto roe = roe_average_(qL, pL, qR, pR);
+    const Num SL = std::min(uL - a_(qL, pL), roe.u(d) - roe.a);
+    const Num SR = std::max(uR + a_(qR, pR), roe.u(d) + roe.a);
+
+    if (SL >= 0.) { return flux_(qL, d); }
+    if (SR <= 0.) { return flux_(qR, d); }
+
+    const Num mL = qL(V::rho()) * (SL - uL);
+    const Num mR = qR(V::rho()) * (SR - uR);
+    const Num SM = (pR - pL + mL * uL - mR * uR) / (mL - mR);
+
+    // star state of the side K with wave speed SK
+    auto star = [&](const NumA<nvars>& qK, const Num pK, const Num uK,
+                    const Num SK, const Num mK) {
+      NumA<nvars> qS = qK * (SK - uK) / (SK - SM);
+      qS(V::rho_u(d)) = qS(V::rho()) * SM;
+      qS(V::rho_E()) += (SM * pK - uK * pK + mK * SM * (SM - uK))
+                        / (SK - SM);
+      return qS;
+    };
+    DBGV((d)(SL)(SM)(SR));
+    if (SM >= 0.) {
+      return flux_(qL, d) + SL * (star(qL, pL, uL, SL, mL) - qL);
+    }
+    return flux_(qR, d) + SR * (star(qR, pR, uR, SR, mR) - qR);
+  }
+
+  ///@}
+
+  /// \name Roe Flux (Roe 1981)
+  ///@{
+
+  /// \brief Computes the \p d -th component of the Roe flux between the
+  /// conservative states \p qL and \p qR
+  ///
+  /// The absolute eigenvalues of the acoustic waves smaller than
+  /// roeEntropyFix times the averaged speed of sound are smoothed (Harten
+  /// 1983) to prevent expansion shocks at sonic points.
+  inline NumA<nvars> state_num_flux_
+  (const NumA<nvars>& qL, const NumA<nvars>& qR, const SInd d, const Num,
+    const Num, flux::roe) const noexcept {
+    const Num pL = p_(qL);
+    const Num pR = p_(qR);
+    const auto roe = roe_average_(qL, pL, qR, pR);
+    const Num a = roe.a;
+    const Num u_d = roe.u(d);
+
+    const Num dRho = qR(V::rho()) - qL(V::rho());
+    const Num dP = pR - pL;
+    const NumA<nd> du = qR.template head<nd>() / qR(V::rho())
+                        - qL.template head<nd>() / qL(V::rho());
+
+    // wave strengths:
+    const Num alphaM = (dP - roe.rho * a * du(d)) / (2. * a * a);
+    const Num alphaP = (dP + roe.rho * a * du(d)) / (2. * a * a);
+    const Num alphaE = dRho - dP / (a * a);
+
+    // acoustic waves:
+    auto acoustic = [&](const Num s) {
+      NumA<nvars> r;
+      r.template head<nd>() = roe.u;
+      r(V::rho_u(d)) += s * a;
+      r(V::rho()) = 1.;
+      r(V::rho_E()) = roe.H + s * u_d * a;
+      return r;
+    };
+    const Num delta = roeEntropyFix_ * a;
+    auto entropy_fix = [delta](const Num lambda) {
+      return std::abs(lambda) >= delta
+          ? std::abs(lambda) : (lambda * lambda + delta * delta) / (2. * delta);
+    };
+    NumA<nvars> dissipation
+      = entropy_fix(u_d - a) * alphaM * acoustic(-1.)
+      + entropy_fix(u_d + a) * alphaP * acoustic(+1.);
+
+    // entropy and shear waves (travel with u_d):
+    NumA<nvars> r = NumA<nvars>::Zero();
+    r.template head<nd>() = alphaE * roe.u;
+    r(V::rho()) = alphaE;
+    r(V::rho_E()) = 0.5 * alphaE * roe.u.squaredNorm();
+    for (auto t : b_()->grid().dimensions()) {
+      if (t == d) { continue; }
+      const Num alphaT = roe.rho * du(t);
+      r(V::rho_u(t)) += alphaT;
+      r(V::rho_E()) += alphaT * roe.u(t);
+    }
+    dissipation += std::abs(u_d) * r;
+
+    DBGV((d)(u_d)(a)(alphaM)(alphaP)(alphaE));
+    return 0.5 * (flux_(qL, d) + flux_(qR, d) - dissipation);
+  }
+
+  ///@}
+
+  /// \name Run-time selected flux
+  ///@{
+
+  /// \brief Computes the \p d -th component of the numerical flux selected
+  /// by the property numericalFlux between the conservative states \p qL and
+  /// \p qR
+  inline NumA<nvars> state_num_flux_
+  (const NumA<nvars>& qL, const NumA<nvars>& qR, const SInd d, const Num dx,
+    const Num dt, flux::by_property) const noexcept {
+    switch (numericalFlux_) {
+      case NumericalFlux::ausm:
+        return state_num_flux_(qL, qR, d, dx, dt, flux::ausm());
+      case NumericalFlux::lax_friedrichs:
+        return state_num_flux_(qL, qR, d, dx, dt, flux::lax_friedrichs());
+      case NumericalFlux::hllc:
+        return state_num_flux_(qL, qR, d, dx, dt, flux::hllc());
+      case NumericalFlux::roe:
+        return state_num_flux_(qL, qR, d, dx, dt, flux::roe());
+    }
+    TERMINATE("unknown numerical flux!");
+  }
+
  private:
+  /// \name AUSM interface functions
+  ///@{
+
   /// \brief Computes the interface Mach number \mathcal{M}^{+-}
   template<int sign> static inline constexpr Num m_int_(const Num M) noexcept {
     static_assert(sign == 1 || sign == -1, "invalid sign!");
@@ -310,17 +676,66 @@ template<SInd nd_, class NumFlux, class Solver> struct Physics {
   }
 
   /// \brief Computes the d-th flux vector component divided by the d-th
-  /// velocity (it is multiplied by the interface speed-of-sound in ausm)
-  template<class _>
-  inline NumA<nvars> theta_(const CellIdx cIdx) const noexcept {
-    NumA<nvars> f = NumA<nvars>::Zero();
-    f(V::rho()) = rho<_>(cIdx);
-    for (auto i : b_()->grid().dimensions()) {
-      f(V::rho_u(i)) = rho_u<_>(cIdx, i);
-    }
-    f(V::rho_E()) = rho_E<_>(cIdx) + p<_>(cIdx);
+  /// velocity (it is multiplied by the interface speed-of-sound in ausm) of
+  /// the conservative state \p q with \p pressure and \p soundSpeed
+  inline NumA<nvars> theta_(const NumA<nvars>& q, const Num pressure,
+                             const Num soundSpeed) const noexcept {
+    NumA<nvars> f = q;
+    f(V::rho_E()) += pressure;
+    f *= soundSpeed;
+    return f;
+  }
+
+  ///@}
+
+  /// \name Conservative state functions
+  ///@{
+
+  /// \brief Pressure of the conservative state \p q
+  inline Num p_(const NumA<nvars>& q) const noexcept {
+    const Num rho_u2 = q.template head<nd>().squaredNorm();
+    return gammaM1() * (q(V::rho_E()) - 0.5 * rho_u2 / q(V::rho()));
+  }
+
+  /// \brief Speed of sound of the conservative state \p q with \p pressure
+  inline Num a_(const NumA<nvars>& q, const Num pressure) const noexcept
+  { return std::sqrt(gamma() * pressure / q(V::rho())); }
+
+  /// \brief Roe averages of the conservative states \p qL and \p qR with
+  /// pressures \p pL and \p pR
+  struct RoeAverage {
+    Num rho;   ///< Density
+    NumA<nd> u;  ///< Velocity
+    Num H;     ///< Specific total enthalpy
+    Num a;     ///< Speed of sound
+  };
+  inline RoeAverage roe_average_(const NumA<nvars>& qL, const Num pL,
+                                 const NumA<nvars>& qR, const Num pR)
+  const noexcept {
+    const Num sL = std::sqrt(qL(V::rho()));
+    const Num sR = std::sqrt(qR(V::rho()));
+    RoeAverage avg;
+    avg.rho = sL * sR;
+    avg.u = (qL.template head<nd>() / sL + qR.template head<nd>() / sR)
+            / (sL + sR);
+    avg.H = ((qL(V::rho_E()) + pL) / sL + (qR(V::rho_E()) + pR) / sR)
+            / (sL + sR);
+    avg.a = std::sqrt(gammaM1() * (avg.H - 0.5 * avg.u.squaredNorm()));
+    return avg;
+  }
 
-    f *= a<_>(cIdx);
+  /// \brief \p d-th component of the Euler flux of the conservative state \p q
+  inline NumA<nvars> flux_(const NumA<nvars>& q, const SInd d) const noexcept
+  { return flux_(q, p_(q), d); }
+
+  /// \brief \p d-th component of the Euler flux of the conservative state \p q
+  /// with \p pressure
+  inline NumA<nvars> flux_(const NumA<nvars>& q, const Num pressure,
+                           const SInd d) const noexcept {
+    const Num u_d = q(V::rho_u(d)) / q(V::rho());
+    NumA<nvars> f = u_d * q;
+    f(V::rho_u(d)) += pressure;
+    f(V::rho_E()) += u_d * pressure;
     return f;
   }
 
@@ -13,8 +13,32 @@ struct type_tag {};
 namespace flux {
 struct ausm {};
 struct lax_friedrichs {};
+struct hllc {};
+struct roe {};  ///< with Harten's entropy fix
+
+/// \brief Numerical flux selected at run-time by the property numericalFlux:
+/// ausm, laxFriedrichs, hllc, or roe (default: ausm)
+struct by_property {};
+
+/// \brief Second-order MUSCL flux: evaluates the numerical flux \p Flux with
+/// the face states reconstructed linearly with the slope limiter \p Limiter
+/// (e.g. muscl<ausm, limiter::van_leer>)
+template<class Flux, class Limiter> struct muscl {};
+
+/// \brief First-order flux \p Flux (ausm or lax_friedrichs) that reads the
+/// cell quantities it needs from a cache filled once per stage (see
+/// Physics::prepare_num_fluxes), e.g. cached<lax_friedrichs> evaluates the
+/// physical flux F_d(q) once per cell and direction instead of once per face
+template<class Flux> struct cached {};
 }  // namespace flux
 
+/// \brief Slope limiters of the MUSCL reconstruction
+namespace limiter {
+struct minmod {};
+struct van_leer {};
+struct mc {};  ///< Monotonized central
+}  // namespace limiter
+
 ////////////////////////////////////////////////////////////////////////////////
 }  // namespace euler
 }  // namespace fv
@@ -54,8 +54,9 @@ const Num h = test_grid.cell_length_at_level(minRefLevel);
 auto cubeD = geometry::make_cube<nd>
              (NumA<nd>::Constant(0.5), NumA<nd>::Constant(length), h, 0.5);
 
-/// \brief Creates properties for the Euler solvers
-template<SInd nd, class InitD> auto euler_properties(InitD&& id) {
+/// \brief Creates properties for the Euler solvers on the grid \p g
+template<SInd nd, class InitD>
+auto euler_properties(InitD&& id, grid::Grid<nd>* g = &test_grid) {
   using namespace grid::helpers::cube; using namespace io;
   using namespace quantity; using namespace unit;
   using InitialDomain = typename EulerSolver<nd>::InitialDomain;
@@ -72,7 +73,7 @@ template<SInd nd, class InitD> auto euler_properties(InitD&& id) {
   InitialDomain initialDomain = id;
 
   Properties p;
-  insert<grid::Grid<nd>*>     (p, "grid"         , &test_grid);
+  insert<grid::Grid<nd>*>     (p, "grid"         , g);
   insert<Ind>                 (p, "maxNoCells"   , maxNoCells);
   insert<bool>                (p, "restart"      , false);
   insert<InitialDomain>       (p, "initialDomain", initialDomain);
@@ -151,8 +152,7 @@ TEST(euler_fv_solver_coupling, euler_euler_coupling) {
     solver::fv::coupling::apply(eulerSolver0, eulerSolver1);
     write_timestep(eulerSolver0, eulerSolver1);
 
-    eulerSolver0.solve();
-    eulerSolver1.solve();
+    solver::fv::coupling::solve(eulerSolver0, eulerSolver1);
 
     write_output(outputInterval, eulerSolver0, eulerSolver1);
 
@@ -164,6 +164,67 @@ TEST(euler_fv_solver_coupling, euler_euler_coupling) {
   write_domains(eulerSolver0, eulerSolver1);
 }
 
+/// \test beyond the stability limit the CFL controller rolls the coupled
+/// solvers back together: they keep the same time, time-step and #of
+/// rejected steps, and their solutions remain valid
+TEST(euler_fv_solver_coupling, adaptive_cfl_euler_euler_coupling) {
+  using namespace grid::helpers::cube;
+  using V = typename EulerSolver<nd>::V;
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, minRefLevel, 2)
+  };
+  auto adaptive_properties = [&](auto&& initialDomain) {
+    auto p = euler_properties<nd>(initialDomain, &g);
+    p.erase("CFL");
+    io::insert<Num>(p, "CFL", 2.0);
+    io::insert<bool>(p, "adaptiveCFL", true);
+    return p;
+  };
+  auto s0 = EulerSolver<nd> {
+    eulerSolverIdx0, adaptive_properties([&](const NumA<nd> x) {
+      return (*std::get<0>(cubeD))(x) > 0.;
+    })
+  };
+  auto s1 = EulerSolver<nd> {
+    eulerSolverIdx1, adaptive_properties([&](const NumA<nd> x) {
+      return (*std::get<0>(cubeD))(x) < 0.;
+    })
+  };
+  auto sod_shock_tube_ic = euler_physics::ic::shock_tube<nd>
+                           (0, 0., 0.3, 1.0, 0.75, 1.0, 0.125, 0.0, 0.1);
+  s0.set_initial_condition(sod_shock_tube_ic);
+  s1.set_initial_condition(sod_shock_tube_ic);
+
+  auto nBc = euler_physics::bc::Neumann<EulerSolver<nd>>(s0);
+  solver::fv::append_bcs(s0, g.root_cell(), make_conditions<nd>(nBc));
+  auto cBc0 = euler_physics::bc::coupling::Euler<EulerSolver<nd>> {s0, s1};
+  s0.append_bc(solver::fv::bc::Interface<nd> {
+      "cube0", std::get<1>(cubeD), s0, cBc0
+  });
+  auto cBc1 = euler_physics::bc::coupling::Euler<EulerSolver<nd>> {s1, s0};
+  s1.append_bc(solver::fv::bc::Interface<nd> {
+      "cube1", std::get<2>(cubeD), s1, cBc1
+  });
+  initialize(g, s0, s1);
+
+  const Ind noSteps = 20;
+  while (!solver_finished(noSteps, s0, s1)) {
+    solver::fv::coupling::apply(s0, s1);
+    solver::fv::coupling::solve(s0, s1);
+    EXPECT_EQ(s0.dt(), s1.dt());
+    EXPECT_EQ(s0.time(), s1.time());
+  }
+  EXPECT_GT(s0.no_rejected_steps(), Ind{0});
+  EXPECT_EQ(s0.no_rejected_steps(), s1.no_rejected_steps());
+  EXPECT_EQ(s0.cfl_factor(), s1.cfl_factor());
+  for (auto&& s : {&s0, &s1}) {
+    for (auto cIdx : s->internal_cells()) {
+      EXPECT_GT(s->template Q<solver::fv::lhs_tag>(cIdx, V::rho()), 0.);
+      EXPECT_GT(s->template p<solver::fv::lhs_tag>(cIdx), 0.);
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 #undef ENABLE_DBG_
 ////////////////////////////////////////////////////////////////////////////////
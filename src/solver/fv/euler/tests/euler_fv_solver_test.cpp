@@ -4,6 +4,7 @@
 #include "solver/fv/euler.hpp"
 #include "solver/fv/utilities.hpp"
 #include "geometry/geometry.hpp"
+#include "solver/fv/tests/helpers.hpp"
 /// External Includes:
 #include "misc/test.hpp"
 /// Options:
@@ -111,6 +112,148 @@ TEST(euler_fv_solver, constant_ic) {
                          outputInterval);
 }
 
+/// \test Tracer particles in a uniform flow move with the flow velocity, stay
+/// sorted by cell, and are removed and recorded once they leave the domain
+TEST(euler_fv_solver, tracer_particles_uniform_flow) {
+  using namespace grid::helpers::cube;
+  auto particle_grid = grid::Grid<nd> { properties<nd>(rootCell, 3) };
+
+  /// Create solver
+  auto eulerSolver = EulerSolver<nd> {
+    eulerSolverIdx, euler_properties<nd>(&particle_grid, 1.0)
+  };
+
+  /// Uniform flow with velocity 0.5 in each direction
+  const Num u = 0.5;
+  auto constant_ic = [&](const NumA<nd>) {
+    NumA<eulerSolver.nvars> pvars = NumA<eulerSolver.nvars>::Zero();
+    pvars(V::rho()) = 1.0;
+    for (SInd d = 0; d < nd; ++d) {
+      pvars(V::u(d)) = u;
+    }
+    pvars(V::p()) = 1.0;
+    return eulerSolver.cv(pvars);
+  };
+  eulerSolver.set_initial_condition(constant_ic);
+
+  auto nBc = euler_physics::bc::Neumann<EulerSolver<nd>>(eulerSolver);
+  solver::fv::append_bcs(eulerSolver, particle_grid.root_cell(),
+                         make_conditions<nd>(nBc));
+  solver::fv::initialize(particle_grid, eulerSolver);
+
+  /// Seed tracers (the last one lies outside of the domain)
+  solver::fv::Particles<EulerSolver<nd>> tracers(eulerSolver);
+  const NumAV<nd> x0 = {
+    NumA<nd>::Constant(0.4), NumA<nd>::Constant(0.2),
+    NumA<nd>::Constant(0.9), NumA<nd>::Constant(1.5)
+  };
+  EXPECT_EQ(tracers.seed(x0), Ind{3});
+
+  /// Advance until the tracer seeded at 0.9 has left the domain
+  while (eulerSolver.time() < 0.25) {
+    solver::fv::solve(eulerSolver, tracers);
+  }
+  EXPECT_EQ(tracers.size(), Ind{2});
+
+  for (auto p : tracers.particles()) {
+    const NumA<nd> x = x0[tracers.id(p)].array() + u * eulerSolver.time();
+    for (SInd d = 0; d < nd; ++d) {
+      EXPECT_NEAR(tracers.x(p)(d), x(d), 1e-10);
+      EXPECT_NEAR(tracers.v(p)(d), u, 1e-10);
+    }
+    const auto cIdx = tracers.cell(p);
+    EXPECT_TRUE(*boost::begin(tracers.particles(cIdx)) <= p);
+    EXPECT_TRUE(p < *boost::end(tracers.particles(cIdx)));
+  }
+  EXPECT_TRUE(tracers.cell(0) < tracers.cell(1));
+
+  /// The tracer seeded at 0.9 left the domain at t = 0.2
+  ASSERT_EQ(tracers.no_exited(), Ind{1});
+  EXPECT_EQ(tracers.exited_id(0), Ind{2});
+  EXPECT_GE(tracers.exited_time(0), 0.2);
+  EXPECT_GT(tracers.exited_x(0).maxCoeff(), 1.);
+}
+
+/// \test Tracer particles in a uniform flow find their host cells again
+/// when the grid is coarsened and refined while they are being tracked
+TEST(euler_fv_solver, tracer_particles_adaptation) {
+  using namespace grid::helpers::cube;
+  auto particle_grid = grid::Grid<nd> { properties<nd>(rootCell, 3) };
+
+  auto eulerSolver = EulerSolver<nd> {
+    eulerSolverIdx, euler_properties<nd>(&particle_grid, 1.0)
+  };
+
+  /// Uniform flow with velocity 0.5 in each direction
+  const Num u = 0.5;
+  auto constant_ic = [&](const NumA<nd>) {
+    NumA<eulerSolver.nvars> pvars = NumA<eulerSolver.nvars>::Zero();
+    pvars(V::rho()) = 1.0;
+    for (SInd d = 0; d < nd; ++d) {
+      pvars(V::u(d)) = u;
+    }
+    pvars(V::p()) = 1.0;
+    return eulerSolver.cv(pvars);
+  };
+  eulerSolver.set_initial_condition(constant_ic);
+
+  auto nBc = euler_physics::bc::Neumann<EulerSolver<nd>>(eulerSolver);
+  solver::fv::append_bcs(eulerSolver, particle_grid.root_cell(),
+                         make_conditions<nd>(nBc));
+  solver::fv::initialize(particle_grid, eulerSolver);
+
+  solver::fv::Particles<EulerSolver<nd>> tracers(eulerSolver);
+  const NumAV<nd> x0 = {
+    NumA<nd>::Constant(0.4), NumA<nd>::Constant(0.2), NumA<nd>::Constant(0.9)
+  };
+  EXPECT_EQ(tracers.seed(x0), Ind{3});
+
+  /// Every 4 steps, alternately coarsen the parent of the first tracer's
+  /// host cell and refine it back (the grid capacity is that of the
+  /// uniform grid)
+  auto coarsened = invalid<NodeIdx>();
+  Ind noAdaptations = 0;
+  while (eulerSolver.time() < 0.25) {
+    solver::fv::solve(eulerSolver, tracers);
+    if (eulerSolver.step() % 4 != 0) { continue; }
+    if (is_valid(coarsened)) {
+      eulerSolver.adapt({coarsened}, {});
+      coarsened = invalid<NodeIdx>();
+    } else {
+      coarsened = particle_grid.parent(particle_grid.find_leaf(tracers.x(0)));
+      eulerSolver.adapt({}, {coarsened});
+    }
+    ++noAdaptations;
+
+    /// The host cells are searched again and contain their particles
+    tracers.update_cells();
+    for (auto p : tracers.particles()) {
+      const auto cIdx = tracers.cell(p);
+      ASSERT_TRUE(is_valid(cIdx));
+      EXPECT_TRUE(is_valid(eulerSolver.node_idx(cIdx)));
+      const NumA<nd> dx = tracers.x(p)
+                          - eulerSolver.cells().x_center.row(cIdx).transpose();
+      EXPECT_LE(dx.cwiseAbs().maxCoeff(),
+                0.5 * eulerSolver.cells().length(cIdx) + 1e-12);
+      EXPECT_TRUE(*boost::begin(tracers.particles(cIdx)) <= p);
+      EXPECT_TRUE(p < *boost::end(tracers.particles(cIdx)));
+    }
+  }
+  EXPECT_GT(noAdaptations, Ind{2});
+
+  /// The flow is not modified by the adaptation: the tracers move with it
+  EXPECT_EQ(tracers.size(), Ind{2});
+  for (auto p : tracers.particles()) {
+    const NumA<nd> x = x0[tracers.id(p)].array() + u * eulerSolver.time();
+    for (SInd d = 0; d < nd; ++d) {
+      EXPECT_NEAR(tracers.x(p)(d), x(d), 1e-10);
+      EXPECT_NEAR(tracers.v(p)(d), u, 1e-10);
+    }
+  }
+  ASSERT_EQ(tracers.no_exited(), Ind{1});
+  EXPECT_EQ(tracers.exited_id(0), Ind{2});
+}
+
 /// \test Modified Sod's test
 ///
 /// This is a really easy problem. If something goes wrong here,
@@ -285,6 +428,317 @@ TEST(euler_fv_solver, isentropic_vortex_ic) {
                          outputInterval);
 }
 
+/// \brief L1-error of the density of the 1D flow with the initial primitive
+/// variables \p pvars(x) w.r.t. the exact density \p rho(x, t) at the time \p
+/// timeEnd on a 2D grid of level \p level using the numerical flux \p Flux
+/// and the time integration method \p TI (with tiles of 64 cells)
+template<class Flux,
+         class TI = solver::fv::time_integration::ssp_runge_kutta_3,
+         class PVars, class Rho>
+Num density_error(const SInd level, const Num timeEnd, PVars&& pvars,
+                  Rho&& rho, const String numericalFlux = "ausm") {
+  static const SInd nd = 2;
+  using Solver = euler_physics::Solver<nd, Flux, TI>;
+  using V = typename Solver::V;
+
+  const auto rootCell_2d = grid::RootCell<nd> {
+    NumA<nd>::Constant(0), NumA<nd>::Constant(1)
+  };
+  auto g = grid::Grid<nd>{grid::helpers::cube::properties<nd>(rootCell_2d,
+                                                              level)};
+  auto properties = euler_properties<nd>(&g, timeEnd);
+  properties.erase("maxNoCells");
+  io::insert<Ind>(properties, "maxNoCells",
+                  grid::helpers::cube::no_solver_cells_with_gc<nd>(level));
+  io::insert<String>(properties, "numericalFlux", numericalFlux);
+  io::insert<Ind>(properties, "tileSize", 64);
+  auto s = Solver{eulerSolverIdx, properties};
+  s.set_initial_condition([&](const NumA<nd> x) {
+    return s.cv(pvars(x(0)));
+  });
+  auto nBc = euler_physics::bc::Neumann<Solver>(s);
+  solver::fv::append_bcs(s, rootCell_2d,
+                         grid::helpers::cube::make_conditions<nd>(nBc));
+  solver::fv::initialize(g, s);
+  while (s.time() < s.final_time()) { s.solve(); }
+
+  Num error = 0.;
+  for (auto cIdx : s.internal_cells()) {
+    const Num rho_h = s.template Q<solver::fv::lhs_tag>(cIdx, V::rho());
+    error += std::abs(rho_h - rho(s.cells().x_center(cIdx, 0), s.time()))
+             * std::pow(s.cells().length(cIdx), nd);
+  }
+  return error;
+}
+
+/// \brief L1-error of the density of a density wave advected by a uniform
+/// flow on a 2D grid of level \p level using the numerical flux \p Flux
+template<class Flux> Num density_wave_error(const SInd level) {
+  using V = euler_physics::Indices<2>;
+  const Num u = 1.0;
+  auto rho = [](const Num x) {
+    return 1. + 0.2 * std::exp(-std::pow(x - 0.3, 2) / 0.01);
+  };
+  auto pvars = [&](const Num x) {
+    NumA<V::nvars> pv = NumA<V::nvars>::Zero();
+    pv(V::rho()) = rho(x);
+    pv(V::u(0)) = u;
+    pv(V::p()) = 1.0;
+    return pv;
+  };
+  return density_error<Flux>(level, 0.2, pvars, [&](const Num x, const Num t) {
+    return rho(x - u * t);
+  });
+}
+
+/// \test MUSCL reconstruction of a density wave: with the minmod limiter it
+/// is more accurate than the first-order flux on a grid with twice as many
+/// cells per dimension, and with the van Leer and MC limiters than on a grid
+/// with four times as many cells per dimension
+TEST(euler_fv_solver, muscl_density_wave) {
+  namespace flux_ = euler_physics::flux;
+  namespace limiter = euler_physics::limiter;
+  using flux_::ausm; using flux_::lax_friedrichs; using flux_::muscl;
+  const SInd level = 5;
+  const Num firstOrderError = density_wave_error<ausm>(level + 1);
+  const Num firstOrderFineError = density_wave_error<ausm>(level + 2);
+
+  using minmod = muscl<ausm, limiter::minmod>;
+  EXPECT_LT(density_wave_error<minmod>(level), firstOrderError);
+  using van_leer = muscl<ausm, limiter::van_leer>;
+  EXPECT_LT(density_wave_error<van_leer>(level), firstOrderFineError);
+  using mc = muscl<ausm, limiter::mc>;
+  EXPECT_LT(density_wave_error<mc>(level), firstOrderFineError);
+  using lf_van_leer = muscl<lax_friedrichs, limiter::van_leer>;
+  EXPECT_LT(density_wave_error<lf_van_leer>(level),
+            density_wave_error<lax_friedrichs>(level + 1));
+}
+
+/// \brief Maximum error of the first-step density increments of a linear
+/// density profile advected by a uniform supersonic flow on a 2D grid refined
+/// in x < 0.5, using MUSCL reconstruction with the limiter \p Limiter
+///
+/// AUSM is the upwind flux at supersonic speeds, such that the increments are
+/// -dt u drho/dx if the reconstructed face states are exact. The cells next
+/// to the domain boundaries in x are not checked.
+template<class Limiter> Num muscl_refined_linear_error() {
+  static const SInd nd = 2;
+  static const SInd level = 5;
+  namespace flux_ = euler_physics::flux;
+  using Solver = euler_physics::Solver
+                 <nd, flux_::muscl<flux_::ausm, Limiter>,
+                  solver::fv::time_integration::euler_forward>;
+  using V = typename Solver::V;
+  const Num u = 3.0;
+  const Num drho_dx = 0.5;
+
+  const auto rootCell_2d = grid::RootCell<nd> {
+    NumA<nd>::Constant(0), NumA<nd>::Constant(1)
+  };
+  auto g = grid::Grid<nd>{grid::helpers::cube::properties
+                          <nd, solver::fv::test::LeftRefined>(rootCell_2d,
+                                                              level)};
+  auto properties = euler_properties<nd>(&g, 1.0);
+  properties.erase("maxNoCells");
+  io::insert<Ind>(properties, "maxNoCells",
+                  grid::helpers::cube::no_solver_cells_with_gc<nd>(level));
+  auto s = Solver{eulerSolverIdx, properties};
+  s.set_initial_condition([&](const NumA<nd> x) {
+    NumA<V::nvars> pv = NumA<V::nvars>::Zero();
+    pv(V::rho()) = 1. + drho_dx * x(0);
+    pv(V::u(0)) = u;
+    pv(V::p()) = 1.0;
+    return s.cv(pv);
+  });
+  auto nBc = euler_physics::bc::Neumann<Solver>(s);
+  solver::fv::append_bcs(s, rootCell_2d,
+                         grid::helpers::cube::make_conditions<nd>(nBc));
+  solver::fv::initialize(g, s);
+
+  std::vector<Num> rho0;
+  for (auto cIdx : s.internal_cells()) {
+    rho0.push_back(s.template Q<solver::fv::lhs_tag>(cIdx, V::rho()));
+  }
+  const Num t0 = s.time();
+  s.solve();
+  const Num dt = s.time() - t0;
+
+  Num error = 0.;
+  Ind i = 0;
+  for (auto cIdx : s.internal_cells()) {
+    const Num x = s.cells().x_center(cIdx, 0);
+    const Num rho = s.template Q<solver::fv::lhs_tag>(cIdx, V::rho());
+    if (x > 0.2 && x < 0.8) {
+      error = std::max(error, std::abs(rho - rho0[i] + dt * u * drho_dx));
+    }
+    ++i;
+  }
+  return error;
+}
+
+/// \test MUSCL reconstructs a linear profile exactly across level
+/// interfaces: the slopes use the distances between the cell centers, which
+/// are 1.5 times the fine cell length across the fine side of the interfaces
+TEST(euler_fv_solver, muscl_refined_grid_linear_profile) {
+  namespace limiter = euler_physics::limiter;
+  EXPECT_LT(muscl_refined_linear_error<limiter::minmod>(), 1e-12);
+  EXPECT_LT(muscl_refined_linear_error<limiter::van_leer>(), 1e-12);
+  EXPECT_LT(muscl_refined_linear_error<limiter::mc>(), 1e-12);
+}
+
+/// \brief Initial primitive variables of Sod's shock tube at \p x
+NumA<4> sod_pvars(const Num x) {
+  using V = euler_physics::Indices<2>;
+  NumA<V::nvars> pv = NumA<V::nvars>::Zero();
+  pv(V::rho()) = x < 0.5 ? 1.0 : 0.125;
+  pv(V::p()) = x < 0.5 ? 1.0 : 0.1;
+  return pv;
+}
+
+/// \brief Exact density of Sod's shock tube at \p x and time \p t
+///
+/// see Riemann Solvers and Numerical Methods for Fluid Dynamics 3rd
+/// Edition p. 129
+Num sod_rho(const Num x, const Num t) {
+  const Num gamma = 1.4;
+  const Num aL = std::sqrt(gamma);
+  const Num uStar = 0.9274526200489497;
+  const Num aStarL = 0.9977254326101332;
+  const Num xi = (x - 0.5) / t;
+  if (xi < -aL) { return 1.0; }  // left state
+  if (xi < uStar - aStarL) {     // rarefaction fan
+    const Num u = 2. / (gamma + 1.) * (aL + xi);
+    const Num a = aL - 0.5 * (gamma - 1.) * u;
+    return std::pow(a / aL, 2. / (gamma - 1.));
+  }
+  if (xi < uStar) { return 0.4263194281784951; }  // left star state
+  if (xi < 1.7521557320301782) { return 0.26557371170530697; }  // right star
+  return 0.125;  // right state
+}
+
+/// \test Sod's shock tube with the approximate Riemann solvers: HLLC and Roe
+/// halve the error of Lax-Friedrichs, resolve a stationary contact
+/// discontinuity exactly, and can be selected at run-time
+TEST(euler_fv_solver, riemann_solvers_sod_shock_tube) {
+  namespace flux_ = euler_physics::flux;
+  using V = euler_physics::Indices<2>;
+  const SInd level = 6;
+  const Num timeEnd = 0.2;
+  const Num hllcError
+    = density_error<flux_::hllc>(level, timeEnd, sod_pvars, sod_rho);
+  const Num roeError
+    = density_error<flux_::roe>(level, timeEnd, sod_pvars, sod_rho);
+  const Num laxFriedrichsError
+    = density_error<flux_::lax_friedrichs>(level, timeEnd, sod_pvars, sod_rho);
+  EXPECT_LT(hllcError, 0.5 * laxFriedrichsError);
+  EXPECT_LT(roeError, 0.5 * laxFriedrichsError);
+
+  EXPECT_EQ(hllcError, density_error<flux_::by_property>
+            (level, timeEnd, sod_pvars, sod_rho, "hllc"));
+  EXPECT_EQ(roeError, density_error<flux_::by_property>
+            (level, timeEnd, sod_pvars, sod_rho, "roe"));
+
+  auto contact_pvars = [](const Num x) {
+    NumA<V::nvars> pv = sod_pvars(x);
+    pv(V::p()) = 1.0;
+    return pv;
+  };
+  auto contact_rho = [](const Num x, const Num) {
+    return x < 0.5 ? 1. : 0.125;
+  };
+  EXPECT_LT(density_error<flux_::hllc>(level, timeEnd, contact_pvars,
+                                       contact_rho), 1e-12);
+  EXPECT_LT(density_error<flux_::roe>(level, timeEnd, contact_pvars,
+                                      contact_rho), 1e-12);
+  EXPECT_GT(density_error<flux_::lax_friedrichs>(level, timeEnd, contact_pvars,
+                                                 contact_rho), 1e-3);
+}
+
+/// \test Sod's shock tube with the cached fluxes: the results equal those of
+/// the fluxes evaluated from the cell variables, also with the tiled RK2
+TEST(euler_fv_solver, cached_fluxes_sod_shock_tube) {
+  namespace flux_ = euler_physics::flux;
+  using flux_::cached;
+  const SInd level = 6;
+  const Num timeEnd = 0.2;
+  EXPECT_DOUBLE_EQ(
+    density_error<flux_::ausm>(level, timeEnd, sod_pvars, sod_rho),
+    density_error<cached<flux_::ausm>>(level, timeEnd, sod_pvars, sod_rho));
+  EXPECT_DOUBLE_EQ(
+    density_error<flux_::lax_friedrichs>(level, timeEnd, sod_pvars, sod_rho),
+    density_error<cached<flux_::lax_friedrichs>>(level, timeEnd, sod_pvars,
+                                                  sod_rho));
+  // the tiled RK2 fills the flux cache of its first stage:
+  namespace ti = solver::fv::time_integration;
+  const Num rk2Error = density_error<flux_::ausm, ti::runge_kutta_2>
+                       (level, timeEnd, sod_pvars, sod_rho);
+  const Num tiledError
+    = density_error<cached<flux_::ausm>, ti::tiled_runge_kutta_2>
+      (level, timeEnd, sod_pvars, sod_rho);
+  EXPECT_NEAR(rk2Error, tiledError, 1e-14);
+}
+
+/// \test the time-step computed in the last update pass of the explicit
+/// methods equals the time-step recomputed from the updated solution
+TEST(euler_fv_solver, cached_time_step) {
+  static const SInd nd = 2;
+  using Solver = euler_physics::Solver
+                 <nd, flux, solver::fv::time_integration::ssp_runge_kutta_3>;
+  const auto rootCell_2d = grid::RootCell<nd> {
+    NumA<nd>::Constant(0), NumA<nd>::Constant(1)
+  };
+  auto g = grid::Grid<nd>{grid::helpers::cube::properties<nd>(rootCell_2d,
+                                                              minRefLevel)};
+  auto s = Solver{eulerSolverIdx, euler_properties<nd>(&g, 0.2)};
+  s.set_initial_condition([&](const NumA<nd> x) {
+    return s.cv(sod_pvars(x(0)));
+  });
+  auto nBc = euler_physics::bc::Neumann<Solver>(s);
+  solver::fv::append_bcs(s, rootCell_2d,
+                         grid::helpers::cube::make_conditions<nd>(nBc));
+  solver::fv::initialize(g, s);
+  for (Ind step = 0; step != 10; ++step) {
+    s.solve();
+    const Num cachedDt = s.min_dt();
+    s.invalidate_dt();
+    EXPECT_DOUBLE_EQ(cachedDt, s.min_dt());
+  }
+}
+
+/// \test Sod's shock tube with a CFL number beyond the stability limit: the
+/// CFL controller rolls back the steps with negative density or pressure and
+/// reduces the time-step until the run completes with a valid solution
+TEST(euler_fv_solver, adaptive_cfl_sod_shock_tube) {
+  static const SInd nd = 2;
+  using Solver = EulerSolver<nd>;
+  using V = typename Solver::V;
+  const auto rootCell_2d = grid::RootCell<nd> {
+    NumA<nd>::Constant(0), NumA<nd>::Constant(1)
+  };
+  auto g = grid::Grid<nd>{grid::helpers::cube::properties<nd>(rootCell_2d,
+                                                              minRefLevel)};
+  auto properties = euler_properties<nd>(&g, 0.2);
+  properties.erase("CFL");
+  io::insert<Num>(properties, "CFL", 2.0);
+  io::insert<bool>(properties, "adaptiveCFL", true);
+  auto s = Solver{eulerSolverIdx, properties};
+  s.set_initial_condition([&](const NumA<nd> x) {
+    return s.cv(sod_pvars(x(0)));
+  });
+  auto nBc = euler_physics::bc::Neumann<Solver>(s);
+  solver::fv::append_bcs(s, rootCell_2d,
+                         grid::helpers::cube::make_conditions<nd>(nBc));
+  solver::fv::initialize(g, s);
+  while (s.time() < s.final_time()) { s.solve(); }
+
+  EXPECT_GT(s.no_rejected_steps(), Ind{0});
+  EXPECT_LT(s.cfl_factor(), 1.);
+  for (auto cIdx : s.internal_cells()) {
+    EXPECT_GT(s.template Q<solver::fv::lhs_tag>(cIdx, V::rho()), 0.);
+    EXPECT_GT(s.template p<solver::fv::lhs_tag>(cIdx), 0.);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 #undef ENABLE_DBG_
 ////////////////////////////////////////////////////////////////////////////////
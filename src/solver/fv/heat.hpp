@@ -8,5 +8,6 @@
 #include "heat/quantities.hpp"
 #include "heat/physics.hpp"
 #include "heat/boundary_conditions.hpp"
+#include "heat/patch_solver.hpp"
 ////////////////////////////////////////////////////////////////////////////////
 #endif
@@ -62,6 +62,51 @@ template<class Solver> struct Neumann : fv::bc::Condition<Neumann<Solver>> {
   Solver& s;
 };
 
+/// \brief Dirichlet boundary condition for the temperature of the patch
+/// layout (see PatchSolver and patches::Patches::exchange_halos)
+template<SInd nd>
+struct PatchDirichlet : fv::bc::Condition<PatchDirichlet<nd>> {
+  /// \brief Imposes a \p temperature distribution: Num(NumA<nd> x)
+  template<class F> explicit PatchDirichlet(F&& temperature) noexcept
+    : T_srfc(temperature) {}
+
+  /// \brief Imposes a constant surface \p temperature
+  explicit PatchDirichlet(const Num temperature) noexcept
+    : T_srfc([=](const NumA<nd>&) { return temperature; }) {}
+
+  /// \brief Temperature of the halo cell at \p xHalo
+  NumA<1> operator()(const NumA<nd>& xHalo, const NumA<1>& TInside,
+                     const Num) const noexcept {
+    return NumA<1>::Constant(this->dirichlet(TInside(0), T_srfc(xHalo)));
+  }
+
+  /// Surface temperature distribution
+  const std::function<Num(NumA<nd>)> T_srfc;
+};
+
+/// \brief Neumann boundary condition for the temperature of the patch layout
+/// (see PatchSolver and patches::Patches::exchange_halos)
+template<SInd nd>
+struct PatchNeumann : fv::bc::Condition<PatchNeumann<nd>> {
+  /// \brief Imposes a \p heatFlux distribution: Num(NumA<nd> x)
+  template<class F> explicit PatchNeumann(F&& heatFlux) noexcept
+    : g_srfc(heatFlux) {}
+
+  /// \brief Imposes a constant surface \p heatFlux
+  explicit PatchNeumann(const Num heatFlux) noexcept
+    : g_srfc([=](const NumA<nd>&) { return heatFlux; }) {}
+
+  /// \brief Temperature of the halo cell at \p xHalo, at the distance \p h
+  /// from the inside cell
+  NumA<1> operator()(const NumA<nd>& xHalo, const NumA<1>& TInside,
+                     const Num h) const noexcept {
+    return NumA<1>::Constant(this->neumann(TInside(0), g_srfc(xHalo), h));
+  }
+
+  /// Surface flux distribution
+  const std::function<Num(NumA<nd>)> g_srfc;
+};
+
 }  // namespace bc
 
 ////////////////////////////////////////////////////////////////////////////////
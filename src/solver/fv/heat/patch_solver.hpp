@@ -0,0 +1,214 @@
+#ifndef HOM3_SOLVERS_FV_HEAT_PATCH_SOLVER_HPP_
+#define HOM3_SOLVERS_FV_HEAT_PATCH_SOLVER_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Heat-conduction solver on block-structured leaf patches
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "globals.hpp"
+#include "solver/fv/patches.hpp"
+#include "solver/fv/heat/boundary_conditions.hpp"
+#include "solver/fv/heat/quantities.hpp"
+/// Options:
+#define ENABLE_DBG_ 0
+#include "misc/dbg.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv { namespace heat {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Heat-conduction on the block-structured cell layout
+///
+/// Alternative cell layout of the heat physics: instead of a solver cell per
+/// grid leaf (heat::Solver), each grid leaf holds a patch of k^nd cells (see
+/// patches::Patches), such that the tree and the neighbor lists are only
+/// stored per patch. It solves the same dimensionless equation as
+/// heat::Physics (i.e. with unit diffusivity, see Quantities) with the
+/// three-point stencil of flux::three_point and Euler-forward, where the
+/// internal cells of a patch are updated row by row from implicit neighbors.
+///
+/// The halo of a fine patch at a coarser neighbor holds the value of the
+/// coarse cell, whose center is 1.5 h away (h being the fine cell length).
+/// The flux across each fine face of a level interface is computed once from
+/// it, and applied to both the fine cell and the coarse cell (refluxing),
+/// such that heat is conserved across level interfaces.
+///
+/// Requires properties:
+/// - diffusivity, T_ref (see Quantities)
+/// - CFL: the time-step is CFL h_min^2 / (2 nd), i.e. the stability limit of
+///   Euler-forward for CFL = 1
+/// - timeEnd
+///
+/// The boundary conditions are bc::PatchDirichlet and bc::PatchNeumann (or
+/// any functor with their signature), passed to solve.
+///
+/// Unsupported (the patches are not solver cells): other time integration
+/// methods, fv::bc::Interface boundaries and coupling, run_solver, output
+/// and probes, adaptation, and domain boundaries other than the faces of
+/// the root cell.
+///
+/// \requires the grid leafs satisfy the 2:1 rule.
+template<SInd nd, SInd k> class PatchSolver {
+ public:
+  using Patches = patches::Patches<nd, k, 1>;
+  static constexpr SInd nvars = 1;
+
+  /// \brief Creates a patch for each leaf node of \p grid
+  template<class Grid>
+  PatchSolver(const Grid& grid, io::Properties properties)
+    : quantities(properties)
+    , patches_(grid, leaf_nodes_(grid))
+    , rhs_(NumV::Zero(patches_.size() * Patches::block_size()))
+    , cfl_(io::read<Num>(properties, "CFL"))
+    , timeEnd_(io::read<Num>(properties, "timeEnd")) {
+    hMin_ = std::numeric_limits<Num>::max();
+    for (Ind p = 0, e = patches_.size(); p != e; ++p) {
+      hMin_ = std::min(hMin_, patches_.cell_length(p));
+    }
+  }
+
+  /// \brief Sets the temperature of each cell to the value of
+  /// \p temperature (Num(NumA<nd>)) at its center
+  template<class F> void set_initial_condition(F&& temperature) {
+    for (Ind p = 0, e = patches_.size(); p != e; ++p) {
+      for_each_cell_([&](const SIndA<nd>& c) {
+        patches_(p, 0, Patches::index(c))
+          = temperature(patches_.x_center(p, c));
+      });
+    }
+    time_ = 0.;
+  }
+
+  /// \brief Block-structured cells
+  const Patches& patches() const noexcept { return patches_; }
+
+  /// \brief Temperature at the cell \p c of the patch \p p
+  Num T(const Ind p, const SIndA<nd>& c) const noexcept {
+    return patches_(p, 0, Patches::index(c));
+  }
+
+  /// \brief Current time-step (limited by timeEnd)
+  Num dt() const noexcept {
+    return std::min(cfl_ * hMin_ * hMin_ / (2. * nd), timeEnd_ - time_);
+  }
+  Num time() const noexcept { return time_; }
+  bool finished() const noexcept { return time_ >= timeEnd_; }
+
+  /// Physical quantities
+  const Quantities quantities;
+
+  /// \brief Performs an Euler-forward time-step
+  ///
+  /// \param [in] boundary computes the halo temperature at the domain
+  /// boundary (see patches::Patches::exchange_halos, bc::PatchDirichlet and
+  /// bc::PatchNeumann)
+  template<class Boundary> void solve(Boundary&& boundary) {
+    const Num timeStep = dt();
+    patches_.exchange_halos(boundary);
+    for (Ind p = 0, e = patches_.size(); p != e; ++p) {
+      const Num* T = patches_(p, 0);
+      Num* rhs = rhs_.data() + p * Patches::block_size();
+      const Num h = patches_.cell_length(p);
+      const Num c = timeStep / (h * h);
+      Patches::for_each_row([&](const Ind first) {
+        for (Ind i = first, ie = first + k; i != ie; ++i) {
+          Num sum = -2. * nd * T[i];
+          for (SInd d = 0; d != nd; ++d) {
+            sum += T[i - Patches::stride(d)] + T[i + Patches::stride(d)];
+          }
+          rhs[i] = T[i] + c * sum;
+        }
+      });
+    }
+    reflux_(timeStep);
+    for (Ind p = 0, e = patches_.size(); p != e; ++p) {
+      Num* T = patches_(p, 0);
+      const Num* rhs = rhs_.data() + p * Patches::block_size();
+      Patches::for_each_row([&](const Ind first) {
+        std::copy(rhs + first, rhs + first + k, T + first);
+      });
+    }
+    time_ = timeStep < timeEnd_ - time_ ? time_ + timeStep : timeEnd_;
+  }
+
+ private:
+  Patches patches_;
+  NumV rhs_;  ///< Updated temperatures (with the layout of the patches)
+  const Num cfl_;
+  const Num timeEnd_;
+  Num hMin_;
+  Num time_ = 0.;
+
+  template<class Grid>
+  static std::vector<NodeIdx> leaf_nodes_(const Grid& grid) {
+    std::vector<NodeIdx> leafs;
+    for (auto nIdx : grid.leaf_nodes()) { leafs.push_back(nIdx); }
+    return leafs;
+  }
+
+  /// \brief Applies \p f to the internal cells c of a patch
+  template<class F> static void for_each_cell_(F&& f) {
+    for (Ind r = 0, e = Patches::no_cells(); r != e; ++r) {
+      SIndA<nd> c;
+      Ind rr = r;
+      for (SInd d = 0; d != nd; ++d, rr /= k) { c(d) = rr % k; }
+      f(c);
+    }
+  }
+
+  /// \brief Replaces the fluxes across the level interfaces by the fluxes
+  /// across their fine faces, applied to the cells at both sides
+  ///
+  /// The rhs holds the update of the three-point stencil with the halos over
+  /// the time-step \p timeStep:
+  /// - coarse side: the contribution of the faces at finer neighbors is
+  ///   removed,
+  /// - fine side: the flux across each face at a coarser neighbor, whose
+  ///   center is 1.5 h away, replaces the contribution of the face, and is
+  ///   subtracted from the coarse cell weighted by the ratio of the face
+  ///   areas (2^(1-nd)) and of the cell lengths (1/2).
+  void reflux_(const Num timeStep) noexcept {
+    const Num fineFaceRatio = std::ldexp(1., 1 - nd);
+    for (Ind p = 0, e = patches_.size(); p != e; ++p) {
+      const Num* T = patches_(p, 0);
+      Num* rhs = rhs_.data() + p * Patches::block_size();
+      const Num h = patches_.cell_length(p);
+      const Num c = timeStep / (h * h);
+      for (SInd pos = 0; pos != 2 * nd; ++pos) {
+        const auto kind = patches_.neighbor(p, pos);
+        if (kind != patches::Neighbor::finer
+            && kind != patches::Neighbor::coarser) {
+          continue;
+        }
+        const SInd d = pos / 2;
+        const bool positive = pos % 2;
+        Patches::for_each_face_cell(d, [&](SIndA<nd> cell) {
+          cell(d) = positive ? k - 1 : 0;
+          const Ind i = Patches::index(cell);
+          const Ind halo = positive ? i + Patches::stride(d)
+                                    : i - Patches::stride(d);
+          rhs[i] -= c * (T[halo] - T[i]);
+          if (kind == patches::Neighbor::finer) { return; }
+          // heat entering the fine cell over the time-step (per h^nd):
+          const Num dQ = c / 1.5 * (T[halo] - T[i]);
+          rhs[i] += dQ;
+          const auto coarse = patches_.coarser_cell(p, pos, cell);
+          rhs_(coarse.first * Patches::block_size() + coarse.second)
+            -= 0.5 * fineFaceRatio * dQ;
+        });
+      }
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+}  // namespace heat
+}  // namespace fv
+}  // namespace solver
+}  // namespace hom3
+////////////////////////////////////////////////////////////////////////////////
+#undef ENABLE_DBG_
+////////////////////////////////////////////////////////////////////////////////
+#endif
@@ -79,8 +79,16 @@ template<SInd nd_, class NumFlux, class Solver> struct Physics {
 
   /// \brief computes dt at cell \p cIdx
   ///  dt_i = \frac{ cfl * h_i^2 }{ 2 * mu_i } but mu_i = 1!
+  ///
+  /// Linear implicit methods are unconditionally stable: their time-step
+  /// dt_i = cfl * h_i balances the O(dt^2) error of Crank-Nicolson with the
+  /// O(h^2) error of the three-point stencil.
   template<class U> inline Num compute_dt(const CellIdx cIdx) const noexcept {
     const Num h = b_()->cells().length(cIdx);
+    if (time_integration::is_linear_implicit
+        <typename Solver::time_integration_type>::value) {
+      return cfl_ * h;
+    }
     return cfl_ * 0.5 * std::pow(h, 2.);
   }
   ///@}
@@ -94,6 +102,11 @@ template<SInd nd_, class NumFlux, class Solver> struct Physics {
                            << ") in cell: " << cIdx << "!\n");
   }
 
+  /// \brief Is the temperature of \p cIdx positive?
+  template<class _>
+  inline bool valid_variables(const CellIdx cIdx) const noexcept
+  { return T<_>(cIdx) > 0; }
+
  private:
   /// CRTP:
         Solver* b_()       noexcept { return static_cast<Solver*>(this); }
@@ -3,6 +3,7 @@
 #include "solver/fv/heat.hpp"
 #include "solver/fv/utilities.hpp"
 #include "geometry/geometry.hpp"
+#include "solver/fv/tests/helpers.hpp"
 /// External Includes:
 #include "misc/test.hpp"
 /// Options:
@@ -11,6 +12,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace hom3;
+using solver::fv::test::LeftRefined;
 
 /// General properties:
 static const Ind outputInterval = 10;
@@ -100,6 +102,442 @@ TEST(heat_fv_solver, one_dimensional_dirichlet) {
   solver::fv::run_solver(test_grid, heatSolver, maxNoTimeSteps, outputInterval);
 }
 
+/// \brief Solves the one dimensional Dirichlet problem with the time
+/// integration method \p TI and returns the temperature at the \p points at
+/// the time \p timeEnd
+///
+/// The \p settings are added to the solver properties (replacing those with
+/// the same name).
+template<class TI>
+EigenDynColMajor<Num> temperature_at(const NumAV<nd>& points,
+                                     const Num timeEnd = 0.05,
+                                     const io::Properties& settings = {}) {
+  using Solver = heat_physics::Solver<nd, flux, TI>;
+  auto grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, minRefLevel)
+  };
+  auto properties = heat_properties<nd>(&grid, timeEnd);
+  for (const auto& setting : settings) {
+    properties[setting.first] = setting.second;
+  }
+  auto heatSolver = Solver { heatSolverIdx, properties };
+  heatSolver.set_initial_condition([](const NumA<nd>) {
+    return NumA<Solver::nvars>::Zero();
+  });
+  auto dBc = heat_physics::bc::Dirichlet<Solver>{heatSolver, 1.0};
+  auto nBc = heat_physics::bc::Neumann<Solver>{heatSolver, 0.0};
+  solver::fv::append_bcs(heatSolver, rootCell,
+                         std::make_tuple(dBc, dBc, nBc, nBc, nBc, nBc));
+  solver::fv::initialize(grid, heatSolver);
+  while (!solver::fv::solver_finished(maxNoTimeSteps, heatSolver)) {
+    heatSolver.solve();
+  }
+  return heatSolver.interpolate(points, {0});
+}
+
+/// \test SSP-RK3 and the 2N-storage RK4 method agree with Euler forward
+TEST(heat_fv_solver, low_storage_runge_kutta) {
+  namespace ti = solver::fv::time_integration;
+  const NumAV<nd> points = {
+    NumA<nd>::Constant(0.5), NumA<nd>{0.1, 0.5, 0.5}, NumA<nd>{0.8, 0.3, 0.6}
+  };
+  const auto t_ef  = temperature_at<ti::euler_forward>(points);
+  const auto t_rk3 = temperature_at<ti::ssp_runge_kutta_3>(points);
+  const auto t_rk4 = temperature_at<ti::runge_kutta_4>(points);
+  for (SInd p = 0; p != 3; ++p) {
+    EXPECT_NEAR(t_rk3(p, 0), t_ef(p, 0), 5e-3);
+    EXPECT_NEAR(t_rk4(p, 0), t_ef(p, 0), 5e-3);
+    EXPECT_NEAR(t_rk4(p, 0), t_rk3(p, 0), 1e-3);
+  }
+}
+
+/// \test SSP-RK3 is stable at a CFL number beyond the stability limit of
+/// Euler forward
+///
+/// The initial error only excites modes along x, whose largest eigenvalue is
+/// close to -4 / h^2, i.e. dt * lambda = -2 CFL. With CFL = 1.2 this lies
+/// outside of the stability interval [-2, 0] of Euler forward but inside
+/// that of SSP-RK3 ([-5.15, 0]).
+TEST(heat_fv_solver, ssp_runge_kutta_3_stability) {
+  namespace ti = solver::fv::time_integration;
+  const NumAV<nd> points = {NumA<nd>{0.1, 0.5, 0.5}, NumA<nd>{0.8, 0.3, 0.6}};
+  io::Properties settings;
+  io::insert<Num>(settings, "CFL", 1.2);
+  const auto t_ef  = temperature_at<ti::euler_forward>(points, 0.2, settings);
+  const auto t_rk3 = temperature_at<ti::ssp_runge_kutta_3>(points, 0.2,
+                                                           settings);
+  // reference: RK4 within its stability limit
+  const auto t_ref = temperature_at<ti::runge_kutta_4>(points, 0.2);
+  for (SInd p = 0; p != 2; ++p) {
+    EXPECT_GT(std::abs(t_ef(p, 0)), 10.);
+    EXPECT_NEAR(t_rk3(p, 0), t_ref(p, 0), 1e-3);
+  }
+}
+
+/// \brief Solves an adiabatic problem with a single hot cell (T = 2, T = 1
+/// elsewhere) with the time integration method \p TI at the CFL number \p
+/// cfl and returns the minimum and maximum temperature over all steps
+template<class TI> std::pair<Num, Num> hot_cell_bounds(const Num cfl) {
+  using Solver = heat_physics::Solver<nd, flux, TI>;
+  auto grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, minRefLevel)
+  };
+  auto properties = heat_properties<nd>(&grid, 0.005);
+  properties["CFL"] = cfl;
+  auto heatSolver = Solver { heatSolverIdx, properties };
+  heatSolver.set_initial_condition([](const NumA<nd> x) {
+    const Num h = 1. / std::pow(2., minRefLevel);
+    const NumA<nd> x_hot = NumA<nd>::Constant(8.5 * h);
+    return NumA<Solver::nvars>::Constant
+        ((x - x_hot).cwiseAbs().maxCoeff() < 0.5 * h ? 2. : 1.);
+  });
+  auto nBc = heat_physics::bc::Neumann<Solver>{heatSolver, 0.0};
+  solver::fv::append_bcs(heatSolver, rootCell,
+                         std::make_tuple(nBc, nBc, nBc, nBc, nBc, nBc));
+  solver::fv::initialize(grid, heatSolver);
+  std::pair<Num, Num> bounds{std::numeric_limits<Num>::max(),
+                             std::numeric_limits<Num>::lowest()};
+  auto update_bounds = [&]() {
+    for (auto cIdx : heatSolver.internal_cells()) {
+      const Num T = heatSolver.template Q<solver::fv::lhs_tag>(cIdx, 0);
+      bounds.first = std::min(bounds.first, T);
+      bounds.second = std::max(bounds.second, T);
+    }
+  };
+  update_bounds();
+  while (!solver::fv::solver_finished(maxNoTimeSteps, heatSolver)) {
+    heatSolver.solve();
+    update_bounds();
+  }
+  return bounds;
+}
+
+/// \test SSP-RK3 creates no new extrema up to twice the time-step of Euler
+/// forward
+///
+/// The hot cell has 2 nd cold neighbors, such that Euler forward preserves
+/// the bounds [1, 2] only for dt <= h^2 / (2 nd), i.e. CFL <= 1 / 3. At CFL =
+/// 0.6 the hot cell undershoots on the first Euler forward step (T = 0.2),
+/// while each stage of SSP-RK3 (C = 2) is a convex combination of Euler
+/// forward steps with CFL = 0.3.
+TEST(heat_fv_solver, ssp_runge_kutta_3_bounds) {
+  namespace ti = solver::fv::time_integration;
+  const auto ef  = hot_cell_bounds<ti::euler_forward>(0.6);
+  const auto rk3 = hot_cell_bounds<ti::ssp_runge_kutta_3>(0.6);
+  EXPECT_LT(ef.first, 0.5);
+  EXPECT_GE(rk3.first, 1. - 1e-12);
+  EXPECT_LE(rk3.second, 2. + 1e-12);
+}
+
+/// \test the linear implicit methods reach the steady state T = 1 with
+/// time-steps far above the explicit limit
+TEST(heat_fv_solver, linear_implicit_steady_state) {
+  namespace ti = solver::fv::time_integration;
+  const NumAV<nd> points = {
+    NumA<nd>::Constant(0.5), NumA<nd>{0.1, 0.5, 0.5}, NumA<nd>{0.8, 0.3, 0.6}
+  };
+  const auto t_be = temperature_at<ti::linear_backward_euler>(points, 2.);
+  const auto t_cn = temperature_at<ti::crank_nicolson>(points, 2.);
+  for (SInd p = 0; p != 3; ++p) {
+    EXPECT_NEAR(t_be(p, 0), 1., 1e-6);
+    // Crank-Nicolson barely damps the stiff modes of the initial jump
+    EXPECT_NEAR(t_cn(p, 0), 1., 1e-3);
+  }
+}
+
+/// \brief Total #of conjugate gradient iterations and final state of the
+/// backward Euler method with the \p linearPreconditioner, for a cold cube
+/// heated by its (Dirichlet) boundaries
+std::pair<Ind, NumV> linear_implicit_run(const String linearPreconditioner) {
+  using TI = solver::fv::time_integration::linear_backward_euler;
+  using Solver = heat_physics::Solver<nd, flux, TI>;
+  auto grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, minRefLevel)
+  };
+  auto properties = heat_properties<nd>(&grid, 0.1);
+  properties["linearPreconditioner"] = linearPreconditioner;
+  auto heatSolver = Solver { heatSolverIdx, properties };
+  heatSolver.set_initial_condition([](const NumA<nd>) {
+    return NumA<Solver::nvars>::Zero();
+  });
+  auto dBc = heat_physics::bc::Dirichlet<Solver>{heatSolver, 1.0};
+  solver::fv::append_bcs(heatSolver, rootCell,
+                         std::make_tuple(dBc, dBc, dBc, dBc, dBc, dBc));
+  solver::fv::initialize(grid, heatSolver);
+  Ind iterations = 0;
+  while (!solver::fv::solver_finished(maxNoTimeSteps, heatSolver)) {
+    heatSolver.solve();
+    EXPECT_GT(heatSolver.no_linear_iterations(), Ind{0});
+    iterations += heatSolver.no_linear_iterations();
+  }
+  return {iterations, heatSolver.state()};
+}
+
+/// \test with homogeneous (Dirichlet) boundaries the multigrid preconditioner
+/// of the linear implicit methods needs much fewer conjugate gradient
+/// iterations than block-Jacobi, and both reach the same solution
+TEST(heat_fv_solver, linear_implicit_multigrid_preconditioner) {
+  const auto blockJacobi = linear_implicit_run("blockJacobi");
+  const auto multigrid = linear_implicit_run("multigrid");
+  EXPECT_LT(2 * multigrid.first, blockJacobi.first);
+  ASSERT_EQ(multigrid.second.size(), blockJacobi.second.size());
+  EXPECT_LT((multigrid.second - blockJacobi.second).cwiseAbs().maxCoeff(),
+            1e-8);
+}
+
+/// \test the coloured finite difference Jacobian of the three-point stencil
+/// is conservative and symmetric
+TEST(heat_fv_solver, sparse_jacobian) {
+  using Solver = heat_physics::Solver<nd, flux,
+                                      solver::fv::time_integration::bdf2>;
+  auto grid = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, minRefLevel)
+  };
+  auto properties = heat_properties<nd>(&grid, 0.05);
+  io::insert<SInd>(properties, "jacobianStencilRadius", 1);
+  auto heatSolver = Solver { heatSolverIdx, properties };
+  heatSolver.set_initial_condition([](const NumA<nd> x) {
+    return NumA<Solver::nvars>::Constant(x(0));
+  });
+  auto dBc = heat_physics::bc::Dirichlet<Solver>{heatSolver, 1.0};
+  auto nBc = heat_physics::bc::Neumann<Solver>{heatSolver, 0.0};
+  solver::fv::append_bcs(heatSolver, rootCell,
+                         std::make_tuple(dBc, dBc, nBc, nBc, nBc, nBc));
+  solver::fv::initialize(grid, heatSolver);
+
+  const auto J = heatSolver.increments_jacobian();
+  const Ind n = J.rows();
+  EXPECT_EQ(n, J.cols());
+  EXPECT_GT(n, 0);
+  const NumV rowSums = J * NumV::Ones(n);
+  const solver::fv::implicit::SparseMatrix Jt = J.transpose();
+  EXPECT_LT((J - Jt).norm(), 1e-6 * J.norm());
+  Ind noInteriorRows = 0;
+  for (Ind i = 0; i != n; ++i) {
+    const Ind nonzeros = J.innerVector(i).nonZeros();  // column i
+    EXPECT_LE(nonzeros, 2 * nd + 1);
+    EXPECT_LT(J.coeff(i, i), 0.);
+    if (nonzeros == 2 * nd + 1) {
+      EXPECT_NEAR(rowSums(i), 0., 1e-6);
+      ++noInteriorRows;
+    } else {  // Dirichlet faces remove heat, Neumann faces are adiabatic
+      EXPECT_LE(rowSums(i), 1e-6);
+    }
+  }
+  EXPECT_GT(noInteriorRows, 0);
+}
+
+/// \test the sparse (incomplete) LU preconditioners of the Newton-Krylov
+/// solver give the same solution as the block-Jacobi one
+TEST(heat_fv_solver, sparse_preconditioners) {
+  namespace ti = solver::fv::time_integration;
+  const NumAV<nd> points = {
+    NumA<nd>::Constant(0.5), NumA<nd>{0.1, 0.5, 0.5}, NumA<nd>{0.8, 0.3, 0.6}
+  };
+  auto settings = [](const String preconditioner) {
+    io::Properties p;
+    io::insert<String>(p, "preconditioner", preconditioner);
+    io::insert<SInd>(p, "jacobianStencilRadius", 1);
+    return p;
+  };
+  const auto t_bj  = temperature_at<ti::backward_euler>(points, 0.05);
+  const auto t_ilu = temperature_at<ti::backward_euler>(points, 0.05,
+                                                        settings("ilu"));
+  const auto t_lu  = temperature_at<ti::backward_euler>(points, 0.05,
+                                                        settings("lu"));
+  for (SInd p = 0; p != 3; ++p) {
+    EXPECT_NEAR(t_ilu(p, 0), t_bj(p, 0), 1e-5);
+    EXPECT_NEAR(t_lu(p, 0), t_bj(p, 0), 1e-5);
+  }
+}
+
+/// \brief Properties of an Euler forward solver on the half-refined grid \p g
+/// advanced until t = 0.01
+io::Properties half_refined_properties(grid::Grid<nd>* g) {
+  auto properties = heat_properties<nd>(g, 0.01);
+  properties["CFL"] = Num{0.3};  // Euler forward is stable in 3D
+  return properties;
+}
+
+/// \test the fluxes across both sides of the level interfaces are the same
+/// without local time stepping: an adiabatic refined domain conserves heat
+TEST(heat_fv_solver, refined_grid_conservation) {
+  using Solver = HeatSolver<nd>;
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd, LeftRefined>(rootCell, minRefLevel)
+  };
+  auto heatSolver = Solver { heatSolverIdx, half_refined_properties(&g) };
+  heatSolver.set_initial_condition([](const NumA<nd> x) {
+    return NumA<Solver::nvars>::Constant
+        (1. + std::exp(-(x - NumA<nd>{0.5, 0.4, 0.6}).squaredNorm() / 0.02));
+  });
+  auto nBc = heat_physics::bc::Neumann<Solver>{heatSolver, 0.0};
+  solver::fv::append_bcs(heatSolver, rootCell,
+                         std::make_tuple(nBc, nBc, nBc, nBc, nBc, nBc));
+  solver::fv::initialize(g, heatSolver);
+  EXPECT_EQ(g.level(g.find_leaf(NumA<nd>::Constant(0.25))), minRefLevel);
+  EXPECT_EQ(g.level(g.find_leaf(NumA<nd>::Constant(0.75))), minRefLevel - 1);
+
+  auto total = [&]() {
+    Num result = 0.;
+    for (auto cIdx : heatSolver.internal_cells()) {
+      result += heatSolver.Q<solver::fv::lhs_tag>(cIdx, 0)
+                * std::pow(heatSolver.cells().length(cIdx), nd);
+    }
+    return result;
+  };
+  auto peak = [&]() {
+    Num result = 0.;
+    for (auto cIdx : heatSolver.internal_cells()) {
+      result = std::max(result, heatSolver.Q<solver::fv::lhs_tag>(cIdx, 0));
+    }
+    return result;
+  };
+  const Num initialTotal = total();
+  const Num initialPeak = peak();
+  while (!solver::fv::solver_finished(maxNoTimeSteps, heatSolver)) {
+    heatSolver.solve();
+  }
+  EXPECT_GT(heatSolver.step(), Ind{10});
+  EXPECT_NEAR(total(), initialTotal, 1e-12 * initialTotal);
+  // the peak, which lies on the interface, diffused
+  EXPECT_LT(peak(), initialPeak);
+}
+
+/// \test a linear temperature profile across the level interfaces is a
+/// steady state: the fine side uses the distance to the coarse cell center
+TEST(heat_fv_solver, refined_grid_linear_steady_state) {
+  using Solver = HeatSolver<nd>;
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd, LeftRefined>(rootCell, minRefLevel)
+  };
+  auto heatSolver = Solver { heatSolverIdx, half_refined_properties(&g) };
+  heatSolver.set_initial_condition([](const NumA<nd> x) {
+    return NumA<Solver::nvars>::Constant(x(0));
+  });
+  auto dBc0 = heat_physics::bc::Dirichlet<Solver>{heatSolver, 0.0};
+  auto dBc1 = heat_physics::bc::Dirichlet<Solver>{heatSolver, 1.0};
+  auto nBc = heat_physics::bc::Neumann<Solver>{heatSolver, 0.0};
+  solver::fv::append_bcs(heatSolver, rootCell,
+                         std::make_tuple(dBc0, dBc1, nBc, nBc, nBc, nBc));
+  solver::fv::initialize(g, heatSolver);
+  while (!solver::fv::solver_finished(maxNoTimeSteps, heatSolver)) {
+    heatSolver.solve();
+  }
+  EXPECT_GT(heatSolver.step(), Ind{10});
+  for (auto cIdx : heatSolver.internal_cells()) {
+    EXPECT_NEAR(heatSolver.Q<solver::fv::lhs_tag>(cIdx, 0),
+                heatSolver.cells().x_center(cIdx, 0), 1e-12);
+  }
+}
+
+/// \brief Properties of the patch layout advanced until \p timeEnd
+io::Properties patch_properties(const Num timeEnd) {
+  using namespace io; using namespace quantity;
+  Properties p;
+  insert<Num>                (p, "CFL", 1.);
+  insert<Num>                (p, "timeEnd", timeEnd);
+  insert<Temperature>        (p, "T_ref", 273.15 * unit::kelvin);
+  insert<ThermalDiffusivity> (p, "diffusivity", (1.0 * unit::meter * unit::meter
+                                                      / unit::second));
+  return p;
+}
+
+/// \brief Maximum error of the patch layout (with patches of 4^nd cells) on
+/// \p g w.r.t. the decay of a sine mode with T = 0 at the boundaries
+template<class Grid> Num patch_sine_error(const Grid& g) {
+  using Solver = heat_physics::PatchSolver<nd, 4>;
+  const Num timeEnd = 0.01;
+  auto heatSolver = Solver { g, patch_properties(timeEnd) };
+  auto sine = [](const NumA<nd>& x) {
+    Num result = 1.;
+    for (SInd d = 0; d != nd; ++d) { result *= std::sin(math::pi * x(d)); }
+    return result;
+  };
+  heatSolver.set_initial_condition(sine);
+  while (!heatSolver.finished()) {
+    heatSolver.solve(heat_physics::bc::PatchDirichlet<nd>{0.});
+  }
+
+  const Num decay = std::exp(-nd * std::pow(math::pi, 2) * timeEnd);
+  const auto& patches = heatSolver.patches();
+  Num error = 0.;
+  for (Ind p = 0, e = patches.size(); p != e; ++p) {
+    for (Ind r = 0, er = Solver::Patches::no_cells(); r != er; ++r) {
+      SIndA<nd> c;
+      for (SInd d = 0; d != nd; ++d) { c(d) = (r >> (2 * d)) % 4; }
+      const Num exact = decay * sine(patches.x_center(p, c));
+      error = std::max(error, std::abs(heatSolver.T(p, c) - exact));
+    }
+  }
+  return error;
+}
+
+/// \test the patch layout converges with second order on uniform grids
+TEST(heat_fv_solver, patch_layout_uniform_grid) {
+  std::vector<Num> errors;
+  for (SInd level : {1, 2}) {
+    auto g = grid::Grid<nd> {
+      grid::helpers::cube::properties<nd>(rootCell, level), grid::initialize
+    };
+    errors.push_back(patch_sine_error(g));
+  }
+  EXPECT_LT(errors[0], 6e-3);
+  EXPECT_LT(errors[1], 0.3 * errors[0]);
+}
+
+/// \test the patch layout converges across level interfaces (with first
+/// order, since the halos are injected and averaged)
+TEST(heat_fv_solver, patch_layout_refined_grid) {
+  std::vector<Num> errors;
+  for (SInd level : {2, 3}) {
+    auto g = grid::Grid<nd> {
+      grid::helpers::cube::properties<nd, LeftRefined>(rootCell, level),
+      grid::initialize
+    };
+    errors.push_back(patch_sine_error(g));
+  }
+  EXPECT_LT(errors[0], 2e-2);
+  EXPECT_LT(errors[1], 0.6 * errors[0]);
+}
+
+/// \test the flux across each level interface is applied to the cells at
+/// both sides: an adiabatic refined domain conserves heat with the patch
+/// layout
+TEST(heat_fv_solver, patch_layout_refined_grid_conservation) {
+  using Solver = heat_physics::PatchSolver<nd, 4>;
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd, LeftRefined>(rootCell, 2),
+    grid::initialize
+  };
+  auto heatSolver = Solver { g, patch_properties(0.01) };
+  heatSolver.set_initial_condition([](const NumA<nd>& x) {
+    return 1. + std::exp(-(x - NumA<nd>{0.5, 0.4, 0.6}).squaredNorm() / 0.02);
+  });
+  const auto& patches = heatSolver.patches();
+  auto total = [&]() {
+    Num result = 0.;
+    for (Ind p = 0, e = patches.size(); p != e; ++p) {
+      for (Ind r = 0, er = Solver::Patches::no_cells(); r != er; ++r) {
+        SIndA<nd> c;
+        for (SInd d = 0; d != nd; ++d) { c(d) = (r >> (2 * d)) % 4; }
+        result += heatSolver.T(p, c) * std::pow(patches.cell_length(p), nd);
+      }
+    }
+    return result;
+  };
+  const auto adiabatic = heat_physics::bc::PatchNeumann<nd>{0.};
+
+  const Num initialTotal = total();
+  Ind noSteps = 0;
+  while (!heatSolver.finished()) {
+    heatSolver.solve(adiabatic);
+    ++noSteps;
+  }
+  EXPECT_GT(noSteps, Ind{10});
+  EXPECT_NEAR(total(), initialTotal, 1e-12 * initialTotal);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 #undef ENABLE_DBG_
 ////////////////////////////////////////////////////////////////////////////////
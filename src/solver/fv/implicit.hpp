@@ -0,0 +1,268 @@
+#ifndef HOM3_SOLVERS_FV_IMPLICIT_HPP_
+#define HOM3_SOLVERS_FV_IMPLICIT_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Building blocks of the implicit time integration methods:
+/// settings, BDF coefficients, matrix-free Krylov solvers, and the graph
+/// colouring used to assemble sparse Jacobians
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <Eigen/Sparse>
+#include "globals.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Implicit time integration
+namespace implicit {
+
+/// \brief Settings of the Newton and Krylov solvers
+///
+/// Optional properties (default values in parentheses):
+/// - newtonTolerance: relative residual reduction (1e-8)
+/// - newtonMaxIterations: (10)
+/// - krylovTolerance: relative residual reduction of each linear solve (1e-3)
+/// - krylovRestart: #of iterations between GMRES restarts (30)
+/// - krylovMaxIterations: (200)
+/// - linearTolerance: relative residual reduction of the linear solves of
+///   linear implicit methods (1e-10)
+/// - linearMaxIterations: (1000)
+/// - linearPreconditioner: of the linear solves of linear implicit methods
+///   (blockJacobi):
+///   - blockJacobi: inverse of the block-diagonal of the operator,
+///   - multigrid: a multigrid cycle (see multigrid::Multigrid, with the
+///     multigrid::Settings) of I - theta dt div(grad()). It requires a
+///     scalar physics with unit diffusivity (e.g. heat), and its boundaries
+///     are homogeneous: all Dirichlet or all Neumann (see multigridDirichlet).
+///     With other boundary conditions (e.g. mixed Dirichlet and Neumann) it
+///     remains a valid but less effective preconditioner.
+/// - multigridDirichlet: Dirichlet (true) or Neumann (false) boundaries of the
+///   multigrid preconditioner (true)
+/// - preconditioner: of the Newton-Krylov linear solves (blockJacobi):
+///   - blockJacobi: inverse of the block-diagonal of the Jacobian,
+///   - ilu: incomplete LU factorization of the sparse Jacobian,
+///   - lu: sparse LU factorization of the Jacobian (direct solver).
+/// - jacobianStencilRadius: #of neighbor layers the increment of a cell
+///   depends on, i.e. 1 for first order and 2 for linear reconstruction (2)
+struct Settings {
+  explicit Settings(const io::Properties& properties)
+    : newtonTolerance(io::read_or<Num>(properties, "newtonTolerance", 1e-8))
+    , newtonMaxIterations
+      (io::read_or<Ind>(properties, "newtonMaxIterations", 10))
+    , krylovTolerance(io::read_or<Num>(properties, "krylovTolerance", 1e-3))
+    , krylovRestart(io::read_or<Ind>(properties, "krylovRestart", 30))
+    , krylovMaxIterations
+      (io::read_or<Ind>(properties, "krylovMaxIterations", 200))
+    , linearTolerance(io::read_or<Num>(properties, "linearTolerance", 1e-10))
+    , linearMaxIterations
+      (io::read_or<Ind>(properties, "linearMaxIterations", 1000))
+    , linearPreconditioner
+      (io::read_or<String>(properties, "linearPreconditioner", "blockJacobi"))
+    , multigridDirichlet
+      (io::read_or<bool>(properties, "multigridDirichlet", true))
+    , preconditioner
+      (io::read_or<String>(properties, "preconditioner", "blockJacobi"))
+    , jacobianStencilRadius
+      (io::read_or<SInd>(properties, "jacobianStencilRadius", 2))
+  {
+    ASSERT(preconditioner == "blockJacobi" || preconditioner == "ilu"
+           || preconditioner == "lu",
+           "unknown preconditioner: " + preconditioner);
+    ASSERT(linearPreconditioner == "blockJacobi"
+           || linearPreconditioner == "multigrid",
+           "unknown linear preconditioner: " + linearPreconditioner);
+    ASSERT(jacobianStencilRadius > 0, "the stencil radius must be positive!");
+  }
+
+  Num newtonTolerance;
+  Ind newtonMaxIterations;
+  Num krylovTolerance;
+  Ind krylovRestart;
+  Ind krylovMaxIterations;
+  Num linearTolerance;
+  Ind linearMaxIterations;
+  String linearPreconditioner;
+  bool multigridDirichlet;
+  String preconditioner;
+  SInd jacobianStencilRadius;
+};
+
+/// \brief Sparse matrix type of the assembled Jacobians
+using SparseMatrix = Eigen::SparseMatrix<Num>;
+
+/// \brief Coefficients of the variable step-size BDF methods:
+///
+///   q^{n+1} - a1 q^n + a2 q^{n-1} = beta dt L(q^{n+1})
+struct BdfCoefficients {
+  Num a1;
+  Num a2;
+  Num beta;
+};
+
+/// \brief BDF coefficients of order \p order for the time-step \p dt given
+/// the previous time-step \p dtPrevious (only used if order == 2)
+inline BdfCoefficients bdf_coefficients(const SInd order, const Num dt,
+                                        const Num dtPrevious) noexcept {
+  if (order == 1) { return {1., 0., 1.}; }
+  ASSERT(order == 2, "only BDF1 and BDF2 are implemented!");
+  const Num w = dt / dtPrevious;
+  const Num den = 1. + 2. * w;
+  return {(1. + w) * (1. + w) / den, w * w / den, (1. + w) / den};
+}
+
+/// \brief Solves A x = b with the right-preconditioned restarted GMRES method
+///
+/// \p A(v, Av) and \p M(v, Mv) evaluate the products of the operator and the
+/// (approximate inverse) preconditioner with the vector \p v. The iteration
+/// starts from the initial guess \p x and stops when the residual has been
+/// reduced by \p tolerance relative to |b|, or after \p maxIterations.
+///
+/// \returns the number of iterations performed
+template<class Operator, class Preconditioner>
+Ind gmres(Operator&& A, Preconditioner&& M, const NumV& b, NumV& x,
+          const Num tolerance, const Ind restart,
+          const Ind maxIterations) noexcept {
+  const Ind n = b.size();
+  const Num bNorm = b.norm();
+  if (bNorm == 0.) { x.setZero(); return 0; }
+  const Num absTolerance = tolerance * bNorm;
+
+  EigenDynColMajor<Num> V(n, restart + 1);
+  EigenDynColMajor<Num> H(restart + 1, restart);
+  NumV cs(restart), sn(restart), g(restart + 1), w(n), z(n);
+
+  Ind iteration = 0;
+  while (iteration < maxIterations) {
+    A(x, w);
+    w = b - w;
+    const Num rNorm = w.norm();
+    if (rNorm <= absTolerance) { break; }
+    V.col(0) = w / rNorm;
+    H.setZero();
+    g.setZero();
+    g(0) = rNorm;
+
+    Ind k = 0;
+    while (k < restart && iteration < maxIterations) {
+      M(V.col(k), z);
+      A(z, w);
+      for (Ind j = 0; j <= k; ++j) {  // modified Gram-Schmidt
+        H(j, k) = V.col(j).dot(w);
+        w -= H(j, k) * V.col(j);
+      }
+      H(k + 1, k) = w.norm();
+      if (H(k + 1, k) > 0.) { V.col(k + 1) = w / H(k + 1, k); }
+
+      for (Ind j = 0; j < k; ++j) {  // apply the previous Givens rotations
+        const Num h = cs(j) * H(j, k) + sn(j) * H(j + 1, k);
+        H(j + 1, k) = -sn(j) * H(j, k) + cs(j) * H(j + 1, k);
+        H(j, k) = h;
+      }
+      const Num r = std::hypot(H(k, k), H(k + 1, k));
+      if (r == 0.) { break; }  // breakdown: A M^{-1} is singular
+      cs(k) = H(k, k) / r;
+      sn(k) = H(k + 1, k) / r;
+      H(k, k) = r;
+      H(k + 1, k) = 0.;
+      g(k + 1) = -sn(k) * g(k);
+      g(k) = cs(k) * g(k);
+
+      ++k;
+      ++iteration;
+      if (std::abs(g(k)) <= absTolerance) { break; }
+    }
+    if (k == 0) { break; }
+
+    const NumV y = H.topLeftCorner(k, k).template triangularView<Eigen::Upper>()
+                   .solve(g.head(k));
+    M(V.leftCols(k) * y, z);
+    x += z;
+    if (std::abs(g(k)) <= absTolerance) { break; }
+  }
+  return iteration;
+}
+
+/// \brief Solves the symmetric positive definite system A x = b with the
+/// preconditioned conjugate gradient method
+///
+/// \p A(v, Av) and \p M(v, Mv) evaluate the products of the operator and the
+/// (symmetric positive definite) preconditioner with the vector \p v. The
+/// iteration starts from the initial guess \p x and stops when the residual
+/// has been reduced by \p tolerance relative to |b|, or after \p
+/// maxIterations.
+///
+/// \returns the number of iterations performed
+template<class Operator, class Preconditioner>
+Ind conjugate_gradient(Operator&& A, Preconditioner&& M, const NumV& b,
+                       NumV& x, const Num tolerance,
+                       const Ind maxIterations) noexcept {
+  const Ind n = b.size();
+  const Num bNorm = b.norm();
+  if (bNorm == 0.) { x.setZero(); return 0; }
+  const Num absTolerance = tolerance * bNorm;
+
+  NumV r(n), z(n), p(n), Ap(n);
+  A(x, Ap);
+  r = b - Ap;
+  M(r, z);
+  p = z;
+  Num rz = r.dot(z);
+
+  Ind iteration = 0;
+  for (; iteration != maxIterations && r.norm() > absTolerance; ++iteration) {
+    A(p, Ap);
+    const Num alpha = rz / p.dot(Ap);
+    x += alpha * p;
+    r -= alpha * Ap;
+    M(r, z);
+    const Num rzNew = r.dot(z);
+    p = z + (rzNew / rz) * p;
+    rz = rzNew;
+  }
+  return iteration;
+}
+
+/// \brief Greedy colouring of the columns of a sparse matrix such that no
+/// two columns of the same colour have a nonzero in the same row
+///
+/// \p rows[j] are the rows with nonzeros in column j and \p columns[i] the
+/// columns with nonzeros in row i. The columns of the same colour are
+/// structurally orthogonal: they can be approximated by finite differences
+/// simultaneously.
+///
+/// \returns the colour of each column (the #of colours is max + 1)
+inline std::vector<Ind> greedy_coloring
+(const std::vector<std::vector<Ind>>& rows,
+ const std::vector<std::vector<Ind>>& columns) noexcept {
+  const Ind n = rows.size();
+  std::vector<Ind> colors(n, invalid<Ind>());
+  // forbidden[c] == j: colour c is used by a column conflicting with j
+  std::vector<Ind> forbidden;
+  for (Ind j = 0; j != n; ++j) {
+    for (auto i : rows[j]) {
+      for (auto k : columns[i]) {
+        if (is_valid(colors[k])) { forbidden[colors[k]] = j; }
+      }
+    }
+    Ind c = 0;
+    while (c != static_cast<Ind>(forbidden.size()) && forbidden[c] == j) {
+      ++c;
+    }
+    if (c == static_cast<Ind>(forbidden.size())) {
+      forbidden.push_back(invalid<Ind>());
+    }
+    colors[j] = c;
+  }
+  return colors;
+}
+
+}  // namespace implicit
+
+////////////////////////////////////////////////////////////////////////////////
+}  // namespace fv
+}  // namespace solver
+}  // namespace hom3
+////////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,515 @@
+#ifndef HOM3_SOLVERS_FV_MULTIGRID_HPP_
+#define HOM3_SOLVERS_FV_MULTIGRID_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Geometric multigrid solver for elliptic problems on the grid
+/// hierarchy
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "globals.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Geometric multigrid
+namespace multigrid {
+
+/// \brief Settings of the multigrid solver
+///
+/// Optional properties (default values in parentheses):
+/// - preSmoothing: #of Gauss-Seidel sweeps before the coarse-grid correction
+///   (2)
+/// - postSmoothing: #of Gauss-Seidel sweeps after the coarse-grid correction
+///   (2)
+/// - coarsestSmoothing: #of symmetric Gauss-Seidel sweeps on the coarsest
+///   level (50)
+/// - cycleIndex: #of coarse-grid corrections per level, i.e. 1 = V-cycle,
+///   2 = W-cycle (1)
+/// - multigridTolerance: relative residual reduction of solve (1e-8)
+/// - multigridMaxCycles: (50)
+struct Settings {
+  explicit Settings(const io::Properties& properties)
+    : preSmoothing(io::read_or<Ind>(properties, "preSmoothing", 2))
+    , postSmoothing(io::read_or<Ind>(properties, "postSmoothing", 2))
+    , coarsestSmoothing(io::read_or<Ind>(properties, "coarsestSmoothing", 50))
+    , cycleIndex(io::read_or<Ind>(properties, "cycleIndex", 1))
+    , tolerance(io::read_or<Num>(properties, "multigridTolerance", 1e-8))
+    , maxCycles(io::read_or<Ind>(properties, "multigridMaxCycles", 50))
+  {}
+
+  Ind preSmoothing;
+  Ind postSmoothing;
+  Ind coarsestSmoothing;
+  Ind cycleIndex;
+  Num tolerance;
+  Ind maxCycles;
+};
+
+/// \brief Elliptic operator
+///
+///   A u = alpha u - beta div(grad(u))
+///
+/// with homogeneous Dirichlet (u = 0) or Neumann (du/dn = 0) boundary
+/// conditions, e.g.:
+/// - the implicit heat conduction system u - theta dt div(grad(u)) = b:
+///   alpha = 1, beta = theta dt,
+/// - a pressure Poisson equation -div(grad(p)) = f: alpha = 0, beta = 1 (with
+///   Neumann boundaries f must have zero mean, and p is determined up to a
+///   constant).
+struct Operator {
+  Num alpha;
+  Num beta;
+  bool dirichlet;
+};
+
+/// \brief Geometric multigrid solver for the Operator on the grid hierarchy
+///
+/// The finest level contains the given (leaf) cells. Level k + 1 replaces
+/// the cells of level k at the tree level L_k = maxLevel - k by their parent
+/// nodes, such that coarse levels are made of the grid nodes kept above the
+/// leafs, down to the root level. Each level is discretized with the
+/// conservative cell-centered two-point stencil (also across the faces
+/// between cells of different size). The corrections are prolongated
+/// linearly (see assemble_prolongation) and the residuals are restricted with
+/// its transpose: with piecewise-constant injection the convergence rate of
+/// the cycles degrades with the resolution, since the order of the transfer
+/// operators has to exceed that of the (second-order) operator. The smoother
+/// is Gauss-Seidel: the pre-smoothing sweeps run forward and the
+/// post-smoothing sweeps backward, such that with equal #of sweeps a cycle is
+/// a symmetric preconditioner (e.g. for implicit::conjugate_gradient).
+///
+/// The values of the cells are stored in the order of the given cells, and
+/// the right-hand sides are given per unit volume.
+class Multigrid {
+  /// \brief Discretization of the Operator at a level of the hierarchy
+  struct Level {
+    std::vector<NodeIdx> nodes;  ///< Grid node of each cell
+    NumV volume;                 ///< Volume of each cell
+    NumV diagonal;               ///< Diagonal of the operator
+    std::vector<Ind> firstNeighbor;  ///< Neighbors of i: [first(i), first(i+1))
+    std::vector<Ind> neighbors;      ///< Neighbor cells of each cell
+    std::vector<Num> coefficients;   ///< Off-diagonal coefficients (negated)
+    std::vector<Ind> coarseCell;     ///< Cell of the next level containing
+                                     ///< each cell
+    std::vector<Ind> firstWeight;    ///< Weights of i: [first(i), first(i+1))
+    std::vector<Ind> weightCells;    ///< Cell of the next level of each weight
+    std::vector<Num> weights;        ///< Prolongation weights
+    NumV u;  ///< Solution (correction at the coarse levels)
+    NumV f;  ///< Volume-integrated right-hand side
+    NumV r;  ///< Volume-integrated residual
+
+    Ind size() const noexcept { return nodes.size(); }
+  };
+
+  /// \brief Face between the cells i and j of a level, j is at the neighbor
+  /// position pos of i
+  struct Face {
+    Ind i, j;
+    SInd pos;
+    Num distance;  ///< Distance between the cell centers
+    Num coefficient;
+  };
+
+ public:
+  /// \brief Builds the hierarchy of the \p cellNodes (leaf nodes) of \p grid
+  template<class Grid>
+  Multigrid(const Grid& grid, const std::vector<NodeIdx>& cellNodes,
+            const Operator op, const Settings& settings)
+    : op_(op), settings_(settings) {
+    ASSERT(!cellNodes.empty(), "multigrid without cells!");
+    SInd maxLevel = 0;
+    for (auto nIdx : cellNodes) {
+      maxLevel = std::max(maxLevel, grid.level(nIdx));
+    }
+
+    levels_.emplace_back();
+    levels_.back().nodes = cellNodes;
+    for (SInd treeLevel = maxLevel; treeLevel > 0; --treeLevel) {
+      auto& fine = levels_.back();
+      Level coarse;
+      std::unordered_map<Ind, Ind> coarseIds;
+      fine.coarseCell.resize(fine.size());
+      for (Ind i = 0, e = fine.size(); i != e; ++i) {
+        auto nIdx = fine.nodes[i];
+        if (grid.level(nIdx) == treeLevel) { nIdx = grid.parent(nIdx); }
+        const auto it = coarseIds.find(nIdx());
+        if (it != coarseIds.end()) {
+          fine.coarseCell[i] = it->second;
+        } else {
+          fine.coarseCell[i] = coarse.size();
+          coarseIds[nIdx()] = coarse.size();
+          coarse.nodes.push_back(nIdx);
+        }
+      }
+      levels_.push_back(std::move(coarse));
+    }
+
+    std::vector<std::vector<Face>> faces;
+    for (auto& level : levels_) { faces.push_back(assemble(grid, level)); }
+    for (Ind k = 0, e = no_levels() - 1; k != e; ++k) {
+      assemble_prolongation(grid, k, faces[k + 1]);
+    }
+    // the volumes of the coarse cells are those of the covered fine cells
+    levels_.front().volume = NumV::Zero(levels_.front().size());
+    for (Ind i = 0, e = levels_.front().size(); i != e; ++i) {
+      levels_.front().volume(i)
+        = std::pow(grid.cell_length(levels_.front().nodes[i]), Grid::nd);
+    }
+    for (Ind k = 0, e = no_levels() - 1; k != e; ++k) {
+      auto& coarse = levels_[k + 1];
+      coarse.volume.setZero();
+      for (Ind i = 0, ei = levels_[k].size(); i != ei; ++i) {
+        coarse.volume(levels_[k].coarseCell[i]) += levels_[k].volume(i);
+      }
+    }
+    for (auto& level : levels_) { level.diagonal += op_.alpha * level.volume; }
+  }
+
+  /// \brief #of levels of the hierarchy
+  Ind no_levels() const noexcept { return levels_.size(); }
+
+  /// \brief #of cells of the finest level
+  Ind size() const noexcept { return levels_.front().size(); }
+
+  /// \brief #of cells of the level \p k (0 is the finest level)
+  Ind size(const Ind k) const noexcept { return levels_[k].size(); }
+
+  /// \brief Evaluates \p result = A \p u (per unit volume)
+  void apply(const NumV& u, NumV& result) const noexcept {
+    const auto& level = levels_.front();
+    result.resize(level.size());
+    for (Ind i = 0, e = level.size(); i != e; ++i) {
+      result(i) = row_product(level, u, i) / level.volume(i);
+    }
+  }
+
+  /// \brief Norm of the volume-integrated residual of \p u
+  Num residual_norm(const NumV& f, const NumV& u) noexcept {
+    auto& level = levels_.front();
+    level.f = f.cwiseProduct(level.volume);
+    residual(level, u);
+    return level.r.norm();
+  }
+
+  /// \brief Performs a multigrid cycle for A \p u = \p f starting from \p u
+  void cycle(const NumV& f, NumV& u) noexcept {
+    auto& level = levels_.front();
+    level.f = f.cwiseProduct(level.volume);
+    level.u = u;
+    cycle_(0);
+    u = level.u;
+  }
+
+  /// \brief Solves A \p u = \p f with multigrid cycles starting from \p u
+  ///
+  /// \returns the number of cycles performed
+  Ind solve(const NumV& f, NumV& u) noexcept {
+    auto& level = levels_.front();
+    level.f = f.cwiseProduct(level.volume);
+    level.u = u;
+    const Num absTolerance = settings_.tolerance * level.f.norm();
+    residual(level, level.u);
+    Ind iteration = 0;
+    for (; iteration != settings_.maxCycles && level.r.norm() > absTolerance;
+         ++iteration) {
+      cycle_(0);
+      residual(level, level.u);
+    }
+    u = level.u;
+    return iteration;
+  }
+
+  /// \brief Full multigrid: solves A \p u = \p f on the coarsest level and
+  /// uses the prolongated solution of each level as the initial guess of a
+  /// cycle on the next finer level
+  void fmg(const NumV& f, NumV& u) noexcept {
+    levels_.front().f = f.cwiseProduct(levels_.front().volume);
+    for (Ind k = 0, e = no_levels() - 1; k != e; ++k) {
+      restrict_values(levels_[k].f, k);
+    }
+    levels_.back().u.setZero();
+    smooth_coarsest(levels_.back());
+    for (Ind k = no_levels() - 1; k > 0; --k) {
+      levels_[k - 1].u.setZero();
+      prolongate(k - 1, levels_[k - 1].u);
+      cycle_(k - 1);
+    }
+    u = levels_.front().u;
+  }
+
+  /// \brief Applies a cycle with zero initial guess as the preconditioner
+  /// \p result ~ A^{-1} \p v
+  void operator()(const NumV& v, NumV& result) noexcept {
+    result.setZero(v.size());
+    cycle(v, result);
+  }
+
+ private:
+  std::vector<Level> levels_;
+  const Operator op_;
+  const Settings settings_;
+
+  /// \brief Assembles the stencil of the cells of \p level (except the
+  /// alpha term)
+  ///
+  /// A face between two cells of different size is assembled from the side
+  /// of the fine cell, and faces with nodes which are neither in the level
+  /// nor covered by it are domain boundaries.
+  ///
+  /// \returns the faces between the cells of the level
+  template<class Grid>
+  std::vector<Face> assemble(const Grid& grid, Level& level) {
+    const SInd nd = Grid::nd;
+    const Ind n = level.size();
+    std::unordered_map<Ind, Ind> ids;
+    std::unordered_set<Ind> covered;  // nodes with descendants in the level
+    for (Ind i = 0; i != n; ++i) {
+      ids[level.nodes[i]()] = i;
+      for (auto pIdx = grid.parent(level.nodes[i]); is_valid(pIdx);
+           pIdx = grid.parent(pIdx)) {
+        if (!covered.insert(pIdx()).second) { break; }
+      }
+    }
+    auto cell_of = [&](const NodeIdx nIdx) {
+      const auto it = ids.find(nIdx());
+      return it != ids.end() ? it->second : invalid<Ind>();
+    };
+
+    std::vector<Face> faces;
+    level.diagonal = NumV::Zero(n);
+    for (Ind i = 0; i != n; ++i) {
+      const auto nIdx = level.nodes[i];
+      const Num h = grid.cell_length(nIdx);
+      const Num area = std::pow(h, nd - 1);
+      for (auto pos : grid.neighbor_positions()) {
+        const auto nghbrIdx = grid.find_samelvl_neighbor(nIdx, pos);
+        Ind j = invalid<Ind>();
+        Num distance = h;
+        if (is_valid(nghbrIdx)) {
+          j = cell_of(nghbrIdx);
+          if (!is_valid(j) && covered.count(nghbrIdx())) { continue; }
+          if (is_valid(j) && j < i) { continue; }  // assembled from j
+        } else {  // the neighbor might be a coarser cell
+          for (auto pIdx = nIdx; !grid.is_root(pIdx);) {
+            pIdx = grid.parent(pIdx);
+            const auto coarseIdx = grid.find_samelvl_neighbor(pIdx, pos);
+            if (!is_valid(coarseIdx)) { continue; }
+            j = cell_of(coarseIdx);
+            distance = 0.5 * (h + grid.cell_length(coarseIdx));
+            break;
+          }
+        }
+        if (is_valid(j)) {
+          faces.push_back({i, j, pos, distance, op_.beta * area / distance});
+        } else if (op_.dirichlet) {  // boundary value at the face
+          level.diagonal(i) += op_.beta * area / (0.5 * h);
+        }
+      }
+    }
+
+    level.firstNeighbor.assign(n + 1, 0);
+    for (const auto& face : faces) {
+      ++level.firstNeighbor[face.i + 1];
+      ++level.firstNeighbor[face.j + 1];
+    }
+    for (Ind i = 0; i != n; ++i) {
+      level.firstNeighbor[i + 1] += level.firstNeighbor[i];
+    }
+    level.neighbors.resize(level.firstNeighbor[n]);
+    level.coefficients.resize(level.firstNeighbor[n]);
+    std::vector<Ind> next(level.firstNeighbor.begin(),
+                          level.firstNeighbor.end() - 1);
+    auto insert = [&](const Ind i, const Ind j, const Num coefficient) {
+      level.neighbors[next[i]] = j;
+      level.coefficients[next[i]] = coefficient;
+      ++next[i];
+      level.diagonal(i) += coefficient;
+    };
+    for (const auto& face : faces) {
+      insert(face.i, face.j, face.coefficient);
+      insert(face.j, face.i, face.coefficient);
+    }
+    level.volume = NumV::Zero(n);
+    level.u = NumV::Zero(n);
+    level.f = NumV::Zero(n);
+    level.r = NumV::Zero(n);
+    return faces;
+  }
+
+  /// \brief Assembles the prolongation from level \p k + 1 to level \p k
+  ///
+  /// A cell whose parent is in level k + 1 gets the value of its parent plus,
+  /// in each direction, the one-sided difference of the parent towards the
+  /// cell (to the parent neighbors across the \p coarseFaces, or to the
+  /// boundary value) times the distance between their centers, i.e.
+  /// 3/4 u_parent + 1/4 u_neighbor per direction within a uniform level. The
+  /// cells that are also in level k + 1 are copied.
+  template<class Grid>
+  void assemble_prolongation(const Grid& grid, const Ind k,
+                             const std::vector<Face>& coarseFaces) {
+    using namespace container::hierarchical;
+    const SInd nd = Grid::nd;
+    const SInd noPositions = 2 * nd;
+    auto& fine = levels_[k];
+    const auto& coarse = levels_[k + 1];
+    // neighbors (and their distance) of the coarse cells at each position
+    std::vector<std::vector<std::pair<Ind, Num>>> neighbors(coarse.size()
+                                                            * noPositions);
+    for (const auto& face : coarseFaces) {
+      neighbors[face.i * noPositions + face.pos]
+        .emplace_back(face.j, face.distance);
+      neighbors[face.j * noPositions
+                + grid.opposite_neighbor_position(face.pos)]
+        .emplace_back(face.i, face.distance);
+    }
+
+    fine.firstWeight.assign(1, 0);
+    fine.weightCells.clear();
+    fine.weights.clear();
+    auto insert = [&](const Ind c, const Num weight) {
+      fine.weightCells.push_back(c);
+      fine.weights.push_back(weight);
+    };
+    for (Ind i = 0, e = fine.size(); i != e; ++i) {
+      const Ind c = fine.coarseCell[i];
+      const auto pIdx = coarse.nodes[c];
+      Num parentWeight = 1.;
+      if (grid.level(fine.nodes[i]) != grid.level(pIdx)) {
+        const NumA<nd> offset = grid.cell_coordinates(fine.nodes[i])
+                                - grid.cell_coordinates(pIdx);
+        for (SInd d = 0; d != nd; ++d) {
+          const SInd pos = offset(d) > 0. ? neighbor_position(d, pos_dir)
+                                          : neighbor_position(d, neg_dir);
+          const auto& nghbrs = neighbors[c * noPositions + pos];
+          for (const auto& nghbr : nghbrs) {
+            const Num weight
+              = std::abs(offset(d)) / (nghbr.second * nghbrs.size());
+            insert(nghbr.first, weight);
+            parentWeight -= weight;
+          }
+          if (nghbrs.empty() && op_.dirichlet) {  // boundary value at the face
+            parentWeight
+              -= std::abs(offset(d)) / (0.5 * grid.cell_length(pIdx));
+          }
+        }
+      }
+      insert(c, parentWeight);
+      fine.firstWeight.push_back(fine.weights.size());
+    }
+  }
+
+  /// \brief (A \p u)_i (volume-integrated)
+  static Num row_product(const Level& level, const NumV& u,
+                         const Ind i) noexcept {
+    Num result = level.diagonal(i) * u(i);
+    for (Ind n = level.firstNeighbor[i], e = level.firstNeighbor[i + 1];
+         n != e; ++n) {
+      result -= level.coefficients[n] * u(level.neighbors[n]);
+    }
+    return result;
+  }
+
+  /// \brief Computes the residual r = f - A u of \p level
+  static void residual(Level& level, const NumV& u) noexcept {
+    for (Ind i = 0, e = level.size(); i != e; ++i) {
+      level.r(i) = level.f(i) - row_product(level, u, i);
+    }
+  }
+
+  /// \brief Gauss-Seidel update of the cell \p i of \p level
+  static void relax(Level& level, const Ind i) noexcept {
+    Num sum = level.f(i);
+    for (Ind n = level.firstNeighbor[i], e = level.firstNeighbor[i + 1];
+         n != e; ++n) {
+      sum += level.coefficients[n] * level.u(level.neighbors[n]);
+    }
+    level.u(i) = sum / level.diagonal(i);
+  }
+
+  /// \brief Performs \p sweeps Gauss-Seidel sweeps over \p level forward
+  /// (or backward if \p forward is false)
+  static void smooth(Level& level, const Ind sweeps,
+                     const bool forward) noexcept {
+    const Ind n = level.size();
+    for (Ind s = 0; s != sweeps; ++s) {
+      for (Ind i = 0; i != n; ++i) { relax(level, forward ? i : n - 1 - i); }
+    }
+  }
+
+  /// \brief Approximately solves the coarsest level
+  void smooth_coarsest(Level& level) noexcept {
+    for (Ind s = 0; s != settings_.coarsestSmoothing; ++s) {
+      smooth(level, 1, true);
+      smooth(level, 1, false);
+    }
+  }
+
+  /// \brief Restricts the volume-integrated \p values of level \p k into the
+  /// right-hand side of level k + 1 (transpose of the prolongation)
+  void restrict_values(const NumV& values, const Ind k) noexcept {
+    const auto& fine = levels_[k];
+    auto& coarse = levels_[k + 1];
+    coarse.f.setZero();
+    for (Ind i = 0, e = fine.size(); i != e; ++i) {
+      for (Ind n = fine.firstWeight[i], en = fine.firstWeight[i + 1]; n != en;
+           ++n) {
+        coarse.f(fine.weightCells[n]) += fine.weights[n] * values(i);
+      }
+    }
+  }
+
+  /// \brief Adds the prolongated solution of level \p k + 1 to \p u of
+  /// level \p k
+  void prolongate(const Ind k, NumV& u) noexcept {
+    const auto& fine = levels_[k];
+    const auto& coarse = levels_[k + 1];
+    for (Ind i = 0, e = fine.size(); i != e; ++i) {
+      for (Ind n = fine.firstWeight[i], en = fine.firstWeight[i + 1]; n != en;
+           ++n) {
+        u(i) += fine.weights[n] * coarse.u(fine.weightCells[n]);
+      }
+    }
+  }
+
+  /// \brief Multigrid cycle on level \p k with initial guess level.u
+  void cycle_(const Ind k) noexcept {
+    auto& level = levels_[k];
+    if (k == no_levels() - 1) {
+      smooth_coarsest(level);
+      return;
+    }
+    smooth(level, settings_.preSmoothing, true);
+    residual(level, level.u);
+    restrict_values(level.r, k);
+    levels_[k + 1].u.setZero();
+    for (Ind c = 0; c != settings_.cycleIndex; ++c) { cycle_(k + 1); }
+    prolongate(k, level.u);
+    smooth(level, settings_.postSmoothing, false);
+  }
+};
+
+/// \brief Builds a multigrid solver for the internal cells of \p solver
+///
+/// The values of the cells are indexed by their cell index.
+template<class Solver>
+Multigrid make_multigrid(const Solver& solver, const Operator op,
+                         const Settings& settings) {
+  std::vector<NodeIdx> cellNodes;
+  for (auto cIdx : solver.internal_cells()) {
+    cellNodes.push_back(solver.node_idx(cIdx));
+  }
+  return Multigrid(solver.grid(), cellNodes, op, settings);
+}
+
+}  // namespace multigrid
+
+////////////////////////////////////////////////////////////////////////////////
+}  // namespace fv
+}  // namespace solver
+}  // namespace hom3
+////////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,149 @@
+#ifndef HOM3_SOLVERS_FV_PARAREAL_HPP_
+#define HOM3_SOLVERS_FV_PARAREAL_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Parareal: parallel-in-time integration over time slices
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+#include "globals.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Parareal parallel-in-time integration
+///
+/// The time interval is split into slices [t_n, t_{n+1}). A cheap coarse
+/// propagator G and an accurate fine propagator F map a state at t_n to a
+/// state at t_{n+1}. Each iteration k runs the fine propagators of all slices
+/// concurrently and then sweeps over the slices with the correction
+///
+///   U_{n+1}^{k+1} = G(U_n^{k+1}) + F(U_n^k) - G(U_n^k).
+///
+/// After k iterations the first k slices match the serial fine solution, so
+/// the iteration converges at the latest after #of slices iterations.
+///
+/// A propagator is any callable with signature
+/// NumV(const NumV& u, Num t0, Num t1) (see SolverPropagator).
+namespace parareal {
+
+/// \brief Settings of the Parareal iteration
+///
+/// Optional properties (default values in parentheses):
+/// - pararealTolerance: max relative change of the slice states between
+///   iterations (1e-8)
+/// - pararealMaxIterations: (10)
+struct Settings {
+  explicit Settings(const io::Properties& properties)
+    : tolerance(io::read_or<Num>(properties, "pararealTolerance", 1e-8))
+    , maxIterations(io::read_or<Ind>(properties, "pararealMaxIterations", 10))
+  {}
+
+  Num tolerance;
+  Ind maxIterations;
+};
+
+/// \brief Propagates the state of a finite volume solver over a time interval
+/// (see Solver::state)
+///
+/// If the time-step \p dt is positive, it is forced at every step (e.g. large
+/// time-steps of an implicit coarse propagator), otherwise the solver computes
+/// its own time-step.
+template<class Solver> struct SolverPropagator {
+  explicit SolverPropagator(Solver& solver, const Num dt = 0.) noexcept
+    : solver_(solver), dt_(dt) {}
+
+  NumV operator()(const NumV& u, const Num t0, const Num t1) noexcept {
+    solver_.state(u, t0);
+    solver_.final_time(t1);
+    // the last step is clipped to t1 up to round-off
+    while (t1 - solver_.time() > 1e-12 * std::abs(t1)) {
+      if (dt_ > 0.) { solver_.dt(dt_); }
+      solver_.solve();
+    }
+    return solver_.state();
+  }
+
+ private:
+  Solver& solver_;
+  const Num dt_;
+};
+
+/// \brief Makes a propagator of the \p solver with the time-step \p dt (see
+/// SolverPropagator)
+template<class Solver>
+SolverPropagator<Solver> make_propagator(Solver& solver, const Num dt = 0.)
+noexcept { return SolverPropagator<Solver>{solver, dt}; }
+
+/// \brief Result of the Parareal iteration
+struct Result {
+  std::vector<NumV> states;  ///< States at the slice boundaries
+  Ind iterations;            ///< #of iterations performed
+  Num change;                ///< Max relative change at the last iteration
+};
+
+/// \brief Integrates the state \p u0 over the slices [times[n], times[n + 1])
+///
+/// The propagators \p fine[n] of the slices run concurrently (one thread each),
+/// so each one must own its solver. The \p coarse propagator runs sequentially.
+template<class Coarse, class Fine>
+Result solve(Coarse&& coarse, std::vector<Fine>& fine, const NumV& u0,
+             const std::vector<Num>& times, const Settings& settings) noexcept {
+  const Ind noSlices = times.size() - 1;
+  ASSERT(noSlices > 0, "no time slices!");
+  ASSERT(static_cast<Ind>(fine.size()) == noSlices,
+         "one fine propagator per time slice is required!");
+
+  Result result;
+  auto& u = result.states;
+  std::vector<NumV> coarseU(noSlices), fineU(noSlices);
+  u.resize(noSlices + 1);
+  u[0] = u0;
+  for (Ind n = 0; n != noSlices; ++n) {
+    coarseU[n] = coarse(u[n], times[n], times[n + 1]);
+    u[n + 1] = coarseU[n];
+  }
+
+  result.iterations = 0;
+  result.change = std::numeric_limits<Num>::max();
+  // the slices before first are converged: their states are those of the
+  // serial fine solution
+  for (Ind first = 0; first != noSlices
+         && result.iterations != settings.maxIterations
+         && result.change > settings.tolerance;
+       ++first, ++result.iterations) {
+    std::vector<std::thread> threads;
+    for (Ind n = first; n != noSlices; ++n) {
+      threads.emplace_back([&, n]() {
+        fineU[n] = fine[n](u[n], times[n], times[n + 1]);
+      });
+    }
+    for (auto& thread : threads) { thread.join(); }
+
+    result.change = 0.;
+    for (Ind n = first; n != noSlices; ++n) {
+      // u[first] didn't change: its coarse propagation neither
+      NumV g = n == first ? coarseU[n] : coarse(u[n], times[n], times[n + 1]);
+      NumV uNew = g + fineU[n] - coarseU[n];
+      result.change
+        = std::max(result.change,
+                   (uNew - u[n + 1]).norm()
+                   / std::max(uNew.norm(), std::numeric_limits<Num>::min()));
+      u[n + 1] = std::move(uNew);
+      coarseU[n] = std::move(g);
+    }
+  }
+  return result;
+}
+
+}  // namespace parareal
+
+////////////////////////////////////////////////////////////////////////////////
+}  // namespace fv
+}  // namespace solver
+}  // namespace hom3
+////////////////////////////////////////////////////////////////////////////////
+#endif
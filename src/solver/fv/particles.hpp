@@ -0,0 +1,412 @@
+#ifndef HOM3_SOLVERS_FV_PARTICLES_HPP_
+#define HOM3_SOLVERS_FV_PARTICLES_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Lagrangian particles advected by the flow field of a solver
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <iterator>
+#include <vector>
+#include "globals.hpp"
+#include "solver/fv/tags.hpp"
+/// Options:
+#define ENABLE_DBG_ 0
+#include "misc/dbg.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Lagrangian (tracer or inertial) particles binned by the leaf cells
+/// of a FV solver
+///
+/// Storage is a structure of arrays (positions, velocities, host cells, and
+/// particle ids) that is kept sorted by host cell index. The particles of a
+/// cell are thus contiguous and are accessed through a bin offset per cell.
+///
+/// The fluid velocity at a particle is reconstructed linearly from the
+/// velocity of its host cell and the velocity slopes computed with the same
+/// (same-level) cell neighbors used by the flux stencil. After each stage
+/// particles are relocated by walking through the neighbors of their
+/// previous host cell, which is O(1) per particle for CFL <= 1. Only if the
+/// walk fails (e.g. at a refinement jump) the grid is searched from the root.
+/// Particles leaving the solver domain are removed, and their id, last
+/// position, and time are recorded (see exited_id).
+///
+/// The particles are advanced with Heun's method synchronized with the
+/// solver step: the first stage uses the velocity field at the beginning of
+/// the step (see begin_step) and the second one the field at its end (see
+/// utilities::solve). After the solver cells are rebuilt (see Solver::adapt)
+/// the host cells of all particles are searched again from the root.
+///
+/// Particles are either tracers (relaxationTime = 0) that move with the fluid
+/// velocity, or inertial particles that follow dv/dt = (u(x) - v) / tau
+/// where tau is the particle relaxation time.
+///
+/// Requirements on Solver:
+/// - template<class _> NumA<nd> u(CellIdx cIdx) const; (fluid velocity)
+template<class Solver> struct Particles {
+  static const SInd nd = Solver::nd;
+
+  /// \brief Creates an empty set of particles advected by the \p solver
+  /// velocity field with the relaxation time \p relaxationTime
+  explicit Particles(const Solver& solver, const Num relaxationTime = 0.)
+    : solver_(solver), tau_(relaxationTime), noParticles_(0), nextId_(0)
+    , noAdaptations_(solver.no_adaptations()), stepBegun_(false) {
+    ASSERT(tau_ >= 0., "negative particle relaxation time!");
+  }
+
+  /// \name Particle access
+  ///@{
+
+  /// \brief \f$\#\f$ of particles
+  inline Ind size() const noexcept { return noParticles_; }
+  /// \brief Range of all particles
+  inline Range<Ind> particles() const noexcept { return {Ind{0}, size()}; }
+  /// \brief Range of the particles in cell \p cIdx
+  inline Range<Ind> particles(const CellIdx cIdx) const noexcept {
+    if (cIdx() + 1 >= static_cast<Ind>(binOffsets_.size())) {
+      return {Ind{0}, Ind{0}};
+    }
+    return {binOffsets_[cIdx()], binOffsets_[cIdx() + 1]};
+  }
+  /// \brief Position of particle \p p
+  inline NumA<nd> x(const Ind p) const noexcept { return x_.row(p); }
+  /// \brief Velocity of particle \p p
+  inline NumA<nd> v(const Ind p) const noexcept { return v_.row(p); }
+  /// \brief Host cell of particle \p p
+  inline CellIdx cell(const Ind p) const noexcept { return cells_[p]; }
+  /// \brief Unique id of particle \p p (stable under re-sorting)
+  inline Ind id(const Ind p) const noexcept { return ids_[p]; }
+
+  ///@}
+
+  /// \name Particles that left the domain
+  ///@{
+
+  /// \brief \f$\#\f$ of particles that left the domain since the last
+  /// clear_exited
+  inline Ind no_exited() const noexcept { return exitedIds_.size(); }
+  /// \brief Unique id of the \p i-th particle that left the domain
+  inline Ind exited_id(const Ind i) const noexcept { return exitedIds_[i]; }
+  /// \brief Last position of the \p i-th particle that left the domain
+  inline NumA<nd> exited_x(const Ind i) const noexcept { return exitedX_[i]; }
+  /// \brief Solver time at which the \p i-th particle left the domain
+  inline Num exited_time(const Ind i) const noexcept
+  { return exitedTimes_[i]; }
+  /// \brief Discards the records of the particles that left the domain
+  void clear_exited() noexcept {
+    exitedIds_.clear();
+    exitedX_.clear();
+    exitedTimes_.clear();
+  }
+
+  ///@}
+
+  /// \name Seeding
+  ///@{
+
+  /// \brief Seeds a particle at each point of \p xs lying inside the solver
+  /// domain, with the local fluid velocity as initial velocity
+  ///
+  /// \returns #of seeded particles
+  template<class Points> Ind seed(const Points& xs) {
+    update_cells();
+    stepBegun_ = false;
+    const Ind noNew = std::distance(std::begin(xs), std::end(xs));
+    resize_(size() + noNew);
+    Ind p = size();
+    for (const auto& x : xs) {
+      const auto cIdx = locate_(x);
+      if (!is_valid(cIdx)) { continue; }
+      x_.row(p) = x.transpose();
+      cells_[p] = cIdx;
+      v_.row(p) = fluid_velocity(x, cIdx).transpose();
+      ids_[p] = nextId_++;
+      ++p;
+    }
+    const Ind noSeeded = p - size();
+    noParticles_ = p;
+    sort();
+    return noSeeded;
+  }
+
+  ///@}
+
+  /// \name Time integration
+  ///@{
+
+  /// \brief Fluid velocity at \p x (which lies inside the host cell \p cIdx)
+  ///
+  /// The velocity gradient is the central (one-sided at the domain boundary)
+  /// difference over the distance between the neighbor centers, which differs
+  /// from the cell length next to level interfaces.
+  NumA<nd> fluid_velocity(const NumA<nd>& x, const CellIdx cIdx) const noexcept {
+    const auto& cells = solver_.cells();
+    const NumA<nd> x_c = cells.x_center.row(cIdx).transpose();
+    const NumA<nd> dx = solver_.grid().displacement(x_c, x);
+    NumA<nd> u = solver_.template u<lhs_tag>(cIdx);
+    for (SInd d = 0; d != nd; ++d) {
+      auto nghbrM = internal_nghbr_(cIdx, 2 * d);
+      auto nghbrP = internal_nghbr_(cIdx, 2 * d + 1);
+      if (!is_valid(nghbrM) && !is_valid(nghbrP)) { continue; }
+      if (!is_valid(nghbrM)) { nghbrM = cIdx; }
+      if (!is_valid(nghbrP)) { nghbrP = cIdx; }
+      const NumA<nd> x_M = cells.x_center.row(nghbrM).transpose();
+      const NumA<nd> x_P = cells.x_center.row(nghbrP).transpose();
+      const Num h = solver_.grid().displacement(x_M, x_P)(d);
+      u += (solver_.template u<lhs_tag>(nghbrP)
+            - solver_.template u<lhs_tag>(nghbrM)) / h * dx(d);
+    }
+    return u;
+  }
+
+  /// \brief Evaluates the first stage of the next particle step in the
+  /// velocity field of the current solution (call before the solver's
+  /// solve())
+  void begin_step() {
+    update_cells();
+    resize_buffer_(x0_); resize_buffer_(v0_);
+    resize_buffer_(dxdt0_); resize_buffer_(dvdt0_);
+    for (auto p : particles()) {
+      x0_.row(p) = x_.row(p);
+      v0_.row(p) = v_.row(p);
+      rhs_(p, dxdt0_, dvdt0_);
+    }
+    stepBegun_ = true;
+  }
+
+  /// \brief Advances all particles by the time-step \p dt
+  ///
+  /// Uses the 2nd-order Runge-Kutta (Heun) method: the first stage is the
+  /// one evaluated by begin_step at the beginning of the solver step, and the
+  /// second stage is evaluated in the velocity field of the current solution
+  /// (i.e. call after the solver's solve()). If begin_step was not called
+  /// (or the solver was adapted since) both stages use the current field.
+  /// The velocity of tracers is their mean velocity over the step.
+  void evolve(const Num dt) {
+    if (!stepBegun_ || noAdaptations_ != solver_.no_adaptations()) {
+      begin_step();
+    }
+    stepBegun_ = false;
+    // stage 1: x* = x0 + dt * rhs(x0, v0)
+    for (auto p : particles()) {
+      x_.row(p) = x0_.row(p) + dt * dxdt0_.row(p);
+      v_.row(p) = v0_.row(p) + dt * dvdt0_.row(p);
+    }
+    relocate_();
+    // stage 2: x = x0 + dt/2 * (rhs(x0, v0) + rhs(x*, v*))
+    resize_buffer_(dxdt1_); resize_buffer_(dvdt1_);
+    for (auto p : particles()) {
+      rhs_(p, dxdt1_, dvdt1_);
+      const auto p0 = origin_[p];
+      x_.row(p) = x0_.row(p0) + 0.5 * dt * (dxdt0_.row(p0) + dxdt1_.row(p));
+      if (tau_ > 0.) {
+        v_.row(p) = v0_.row(p0) + 0.5 * dt * (dvdt0_.row(p0) + dvdt1_.row(p));
+      } else {  // tracers: mean velocity over the step
+        v_.row(p) = 0.5 * (dxdt0_.row(p0) + dxdt1_.row(p));
+      }
+    }
+    relocate_();
+    sort();
+  }
+
+  /// \brief Searches the host cells of all particles from the root if the
+  /// solver cells have been rebuilt since the last update (see
+  /// Solver::adapt), and sorts the particles
+  ///
+  /// \complexity O(1) if the solver was not adapted, O(#of particles * log
+  /// #of cells + #of cells) otherwise
+  void update_cells() {
+    if (noAdaptations_ == solver_.no_adaptations()) { return; }
+    noAdaptations_ = solver_.no_adaptations();
+    stepBegun_ = false;
+    relocate_(false);
+    sort();
+  }
+
+  ///@}
+
+  /// \brief Sorts the particles by host cell index (counting sort) and
+  /// updates the cell bins
+  ///
+  /// \complexity O(#of particles + #of cells)
+  void sort() {
+    const Ind noCells = solver_.cells().size();
+    binOffsets_.assign(noCells + 1, 0);
+    for (auto p : particles()) { ++binOffsets_[cells_[p]() + 1]; }
+    for (Ind c = 0; c != noCells; ++c) { binOffsets_[c + 1] += binOffsets_[c]; }
+
+    next_.assign(std::begin(binOffsets_), std::end(binOffsets_) - 1);
+    order_.resize(size());
+    for (auto p : particles()) { order_[next_[cells_[p]()]++] = p; }
+    permute_();
+  }
+
+ private:
+  const Solver& solver_;
+  /// Particle relaxation time (0 for tracers)
+  const Num tau_;
+  /// \f$\#\f$ of particles
+  Ind noParticles_;
+  /// Next unused particle id
+  Ind nextId_;
+  /// Solver::no_adaptations at the last update of the host cells
+  Ind noAdaptations_;
+  /// Has the first stage of the step been evaluated by begin_step?
+  bool stepBegun_;
+
+  /// \name Particle data (structure of arrays)
+  ///@{
+  NumM<nd> x_;                 ///< Positions
+  NumM<nd> v_;                 ///< Velocities
+  std::vector<CellIdx> cells_;  ///< Host cells
+  std::vector<Ind> ids_;        ///< Unique particle ids
+  ///@}
+
+  /// Offset of the first particle of each cell (#of cells + 1)
+  std::vector<Ind> binOffsets_;
+  /// Index of each particle before the last compaction (see relocate_)
+  std::vector<Ind> origin_;
+
+  /// \name Particles that left the domain
+  ///@{
+  std::vector<Ind> exitedIds_;
+  NumAV<nd> exitedX_;
+  std::vector<Num> exitedTimes_;
+  ///@}
+
+  /// \name Buffers reused between steps
+  ///@{
+  NumM<nd> x0_, v0_;        ///< State at the beginning of the step
+  NumM<nd> dxdt0_, dvdt0_;  ///< First stage
+  NumM<nd> dxdt1_, dvdt1_;  ///< Second stage
+  NumM<nd> xTmp_, vTmp_;    ///< Permutation buffers (see permute_)
+  std::vector<CellIdx> cellsTmp_;
+  std::vector<Ind> idsTmp_;
+  std::vector<Ind> order_;  ///< Sorting permutation
+  std::vector<Ind> next_;   ///< Next free slot of each bin while sorting
+  ///@}
+
+  void resize_(const Ind capacity) {
+    if (capacity <= x_.rows()) { return; }
+    x_.conservativeResize(capacity, nd);
+    v_.conservativeResize(capacity, nd);
+    cells_.resize(capacity, invalid<CellIdx>());
+    ids_.resize(capacity, invalid<Ind>());
+  }
+
+  /// \brief Resizes the per-particle buffer \p m to the capacity of the
+  /// particle data (only reallocates if the capacity changed)
+  void resize_buffer_(NumM<nd>& m) const {
+    if (m.rows() != x_.rows()) { m.resize(x_.rows(), nd); }
+  }
+
+  /// \brief Neighbor of \p cIdx at \p pos if it is an internal cell
+  CellIdx internal_nghbr_(const CellIdx cIdx, const SInd pos) const noexcept {
+    const auto nghbrIdx = solver_.cells().neighbors(cIdx, pos);
+    return is_valid(nghbrIdx) && is_valid(solver_.node_idx(nghbrIdx))
+        ? nghbrIdx : invalid<CellIdx>();
+  }
+
+  /// \brief Solver cell containing \p x (searching the grid from the root)
+  CellIdx locate_(const NumA<nd>& x) const noexcept {
+    const auto nIdx = solver_.grid().find_leaf(x);
+    return is_valid(nIdx) ? solver_.grid().cell_idx(nIdx, solver_.solver_idx())
+                          : invalid<CellIdx>();
+  }
+
+  /// \brief Time derivatives of the position and the velocity of particle \p p
+  void rhs_(const Ind p, NumM<nd>& dxdt, NumM<nd>& dvdt) const noexcept {
+    const NumA<nd> u = fluid_velocity(x(p), cells_[p]);
+    if (tau_ > 0.) {
+      dxdt.row(p) = v_.row(p);
+      dvdt.row(p) = (u.transpose() - v_.row(p)) / tau_;
+    } else {
+      dxdt.row(p) = u.transpose();
+      dvdt.row(p).setZero();
+    }
+  }
+
+  /// \brief Moves particle \p p into the cell containing its position by
+  /// walking through the neighbors of its current host cell (if \p walk)
+  /// or by searching the grid from the root
+  ///
+  /// \returns the new host cell (invalid if the particle left the domain)
+  CellIdx walk_(const Ind p, const bool walk = true) noexcept {
+    const auto& cells = solver_.cells();
+    auto cIdx = cells_[p];
+    NumA<nd> x_p = x_.row(p);
+    for (Ind noSteps = 0; walk && noSteps != maxNoWalkSteps_; ++noSteps) {
+      const NumA<nd> x_c = cells.x_center.row(cIdx);
+      const NumA<nd> dx = solver_.grid().displacement(x_c, x_p);
+      const Num halfLength = 0.5 * cells.length(cIdx);
+      SInd d;
+      const Num dist = dx.cwiseAbs().maxCoeff(&d);
+      if (dist <= halfLength) {
+        x_.row(p) = (x_c + dx).transpose();  // wraps periodic directions
+        return cIdx;
+      }
+      const auto nghbrIdx = internal_nghbr_(cIdx, 2 * d + (dx(d) > 0. ? 1 : 0));
+      if (!is_valid(nghbrIdx)) { break; }
+      cIdx = nghbrIdx;
+    }
+    // fallback: the walk failed, search the grid from the root
+    cIdx = locate_(x_p);
+    if (is_valid(cIdx)) {
+      const NumA<nd> x_c = cells.x_center.row(cIdx);
+      x_.row(p) = (x_c + solver_.grid().displacement(x_c, x_p)).transpose();
+    }
+    return cIdx;
+  }
+
+  /// \brief Relocates all particles (see walk_) and removes those that left
+  /// the domain (keeping track of the particles' original index in origin_)
+  void relocate_(const bool walk = true) {
+    origin_.resize(size());
+    Ind q = 0;
+    for (auto p : particles()) {
+      const auto cIdx = walk_(p, walk);
+      if (!is_valid(cIdx)) {
+        exitedIds_.push_back(ids_[p]);
+        exitedX_.push_back(x(p));
+        exitedTimes_.push_back(solver_.time());
+        continue;
+      }
+      if (p != q) {
+        x_.row(q) = x_.row(p);
+        v_.row(q) = v_.row(p);
+        ids_[q] = ids_[p];
+      }
+      cells_[q] = cIdx;
+      origin_[q] = p;
+      ++q;
+    }
+    noParticles_ = q;
+  }
+
+  /// \brief Applies the permutation order_ to the particle data
+  void permute_() {
+    resize_buffer_(xTmp_); resize_buffer_(vTmp_);
+    cellsTmp_.resize(cells_.size());
+    idsTmp_.resize(ids_.size());
+    for (auto p : particles()) {
+      xTmp_.row(p) = x_.row(order_[p]);
+      vTmp_.row(p) = v_.row(order_[p]);
+      cellsTmp_[p] = cells_[order_[p]];
+      idsTmp_[p] = ids_[order_[p]];
+    }
+    x_.swap(xTmp_); v_.swap(vTmp_);
+    cells_.swap(cellsTmp_); ids_.swap(idsTmp_);
+  }
+
+  /// Max #of neighbor steps in a walk before falling back to a global search
+  static constexpr Ind maxNoWalkSteps_ = 8;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+}  // namespace fv
+}  // namespace solver
+}  // namespace hom3
+////////////////////////////////////////////////////////////////////////////////
+#undef ENABLE_DBG_
+////////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,293 @@
+#ifndef HOM3_SOLVERS_FV_PATCHES_HPP_
+#define HOM3_SOLVERS_FV_PATCHES_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Block-structured leaf patches: a uniform block of cells per
+/// grid leaf node
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <array>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "globals.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Block-structured leaf patches
+namespace patches {
+
+/// \brief Kind of the neighbor of a patch across one of its faces
+enum class Neighbor : SInd { boundary, samelevel, coarser, finer };
+
+/// \brief Patches of k^nd cells with \p nvars variables, one per grid leaf
+///
+/// Each patch covers a grid leaf node with a uniform block of k cells along
+/// each direction, surrounded by a one-cell halo (i.e. (k + 2)^nd values per
+/// variable). The cells of a block are stored contiguously, variable by
+/// variable, with the x index running fastest, such that the neighbors of the
+/// cell at index i along d are at i -/+ stride(d): the grid only stores one
+/// node per patch, and kernels are regular stencils over the rows of a block
+/// (see for_each_row) that the compiler can vectorize.
+///
+/// The face halos are filled by exchange_halos from the neighboring patches:
+/// - same level: copy of the neighbor's cells,
+/// - coarser neighbor: injection of the coarse cell containing the halo cell,
+/// - finer neighbors: average of the 2^nd fine cells covering the halo cell,
+/// - domain boundary: from a boundary functor.
+/// Edge and corner halo cells are not filled (stencils must be face-based).
+///
+/// The patches are the cell layout of heat::PatchSolver.
+///
+/// \requires the grid leafs satisfy the 2:1 rule.
+template<SInd nd, SInd k, SInd nvars> class Patches {
+  static_assert(k > 1 && k % 2 == 0, "the patch size must be even");
+  static constexpr SInd no_faces = 2 * nd;
+  static constexpr SInd no_childs = math::ct::ipow(2u, nd);
+
+  /// \brief Connectivity of a patch across one of its faces
+  struct Face {
+    Neighbor kind = Neighbor::boundary;
+    Ind patch = 0;        ///< Same level or coarser neighbor
+    SInd childPos = 0;    ///< Position of the patch in its parent (coarser)
+    std::array<Ind, no_childs> finePatches;  ///< Neighbor children (finer)
+  };
+
+ public:
+  /// \brief #of cells along each direction of a patch (with halo)
+  static constexpr Ind width() noexcept { return k + 2; }
+  /// \brief #of (internal) cells of a patch
+  static constexpr Ind no_cells() noexcept { return math::ct::ipow(k, nd); }
+  /// \brief #of values per variable of a patch (with halo)
+  static constexpr Ind block_size() noexcept {
+    return math::ct::ipow(k + 2, nd);
+  }
+  /// \brief Distance between neighboring cells along \p d
+  static constexpr Ind stride(const SInd d) noexcept {
+    return math::ct::ipow(k + 2, d);
+  }
+  /// \brief Index of the cell \p c of a patch, with c(d) in [-1, k] (-1 and
+  /// k being the halo)
+  static Ind index(const SIndA<nd>& c) noexcept {
+    Ind i = 0;
+    for (SInd d = 0; d != nd; ++d) { i += (c(d) + 1) * stride(d); }
+    return i;
+  }
+
+  /// \brief Applies \p f to the index of the first cell of each row of
+  /// internal cells, i.e. the cells of the row are [i, i + k)
+  template<class F> static void for_each_row(F&& f) {
+    for (Ind r = 0, e = math::ct::ipow(k, nd - 1); r != e; ++r) {
+      Ind i = 1;
+      for (SInd d = 1, rr = r; d != nd; ++d, rr /= k) {
+        i += (rr % k + 1) * stride(d);
+      }
+      f(i);
+    }
+  }
+
+  /// \brief Applies \p f to the cells c of a face normal to \p d, with c(d)
+  /// set to 0
+  template<class F> static void for_each_face_cell(const SInd d, F&& f) {
+    for (Ind r = 0, e = math::ct::ipow(k, nd - 1); r != e; ++r) {
+      SIndA<nd> c;
+      c(d) = 0;
+      for (SInd dd = 0, rr = r; dd != nd; ++dd) {
+        if (dd == d) { continue; }
+        c(dd) = rr % k;
+        rr /= k;
+      }
+      f(c);
+    }
+  }
+
+  /// \brief Creates a patch for each of the \p leafs of \p grid
+  template<class Grid>
+  Patches(const Grid& grid, const std::vector<NodeIdx>& leafs)
+    : nodes_(leafs)
+    , faces_(leafs.size())
+    , xMin_(leafs.size(), nd)
+    , h_(leafs.size())
+    , values_(NumV::Zero(leafs.size() * nvars * block_size())) {
+    std::unordered_map<Ind, Ind> patchIds;
+    for (Ind p = 0, e = size(); p != e; ++p) {
+      ASSERT(grid.is_leaf(nodes_[p]), "node " << nodes_[p] << " is no leaf!");
+      patchIds[nodes_[p]()] = p;
+      h_(p) = grid.cell_length(nodes_[p]) / k;
+      xMin_.row(p) = grid.cell_coordinates(nodes_[p]).transpose().array()
+                     - 0.5 * k * h_(p);
+    }
+    auto patch_of = [&](const NodeIdx nIdx) {
+      const auto it = patchIds.find(nIdx());
+      ASSERT(it != patchIds.end(), "node " << nIdx << " has no patch!");
+      return it->second;
+    };
+
+    for (Ind p = 0, e = size(); p != e; ++p) {
+      const auto nIdx = nodes_[p];
+      for (SInd pos = 0; pos != no_faces; ++pos) {
+        auto& face = faces_[p][pos];
+        const auto nghbr = grid.find_samelvl_neighbor(nIdx, pos);
+        if (is_valid(nghbr) && grid.is_leaf(nghbr)) {
+          face.kind = Neighbor::samelevel;
+          face.patch = patch_of(nghbr);
+        } else if (is_valid(nghbr)) {
+          face.kind = Neighbor::finer;
+          const SInd d = pos / 2;
+          for (SInd cPos = 0; cPos != no_childs; ++cPos) {
+            // children of the neighbor adjacent to the face:
+            if (((cPos >> d) & 1) == pos % 2) { continue; }
+            const auto cIdx = grid.child(nghbr, cPos);
+            ASSERT(is_valid(cIdx) && grid.is_leaf(cIdx),
+                   "patches require a 2:1 balanced grid!");
+            face.finePatches[cPos] = patch_of(cIdx);
+          }
+        } else if (!grid.is_root(nIdx)) {
+          const auto coarse
+            = grid.find_samelvl_neighbor(grid.parent(nIdx), pos);
+          if (is_valid(coarse)) {
+            ASSERT(grid.is_leaf(coarse),
+                   "patches require a 2:1 balanced grid!");
+            face.kind = Neighbor::coarser;
+            face.patch = patch_of(coarse);
+            face.childPos = grid.position_in_parent(nIdx);
+          }
+        }
+      }
+    }
+  }
+
+  /// \brief #of patches
+  Ind size() const noexcept { return nodes_.size(); }
+  /// \brief Grid node of patch \p p
+  NodeIdx node(const Ind p) const noexcept { return nodes_[p]; }
+  /// \brief Kind of neighbor of patch \p p at the neighbor position \p pos
+  Neighbor neighbor(const Ind p, const SInd pos) const noexcept {
+    return faces_[p][pos].kind;
+  }
+  /// \brief Length of the cells of patch \p p
+  Num cell_length(const Ind p) const noexcept { return h_(p); }
+  /// \brief Center coordinates of the cell \p c of patch \p p
+  NumA<nd> x_center(const Ind p, const SIndA<nd>& c) const noexcept {
+    return xMin_.row(p).transpose()
+           + ((c.template cast<Num>().array() + 0.5) * h_(p)).matrix();
+  }
+
+  /// \brief Patch and index of the cell of the coarser neighbor of patch
+  /// \p p at the neighbor position \p pos that is adjacent to the face cell
+  /// \p c of patch \p p
+  std::pair<Ind, Ind> coarser_cell(const Ind p, const SInd pos,
+                                   const SIndA<nd>& c) const noexcept {
+    const auto& face = faces_[p][pos];
+    ASSERT(face.kind == Neighbor::coarser, "the neighbor is not coarser!");
+    const SInd d = pos / 2;
+    SIndA<nd> cc;
+    for (SInd dd = 0; dd != nd; ++dd) {
+      cc(dd) = ((face.childPos >> dd) & 1) * (k / 2) + c(dd) / 2;
+    }
+    cc(d) = pos % 2 ? 0 : k - 1;
+    return std::make_pair(face.patch, index(cc));
+  }
+
+  /// \brief Values of variable \p v of patch \p p (see index)
+  Num* operator()(const Ind p, const SInd v) noexcept {
+    return values_.data() + (p * nvars + v) * block_size();
+  }
+  const Num* operator()(const Ind p, const SInd v) const noexcept {
+    return values_.data() + (p * nvars + v) * block_size();
+  }
+  /// \brief Value of variable \p v at index \p i of patch \p p
+  Num& operator()(const Ind p, const SInd v, const Ind i) noexcept {
+    return (*this)(p, v)[i];
+  }
+  Num operator()(const Ind p, const SInd v, const Ind i) const noexcept {
+    return (*this)(p, v)[i];
+  }
+
+  /// \brief Fills the face halos of all patches
+  ///
+  /// \param [in] boundary computes the value of a halo cell at the domain
+  /// boundary: NumA<nvars>(const NumA<nd>& xHalo, const NumA<nvars>& qInside,
+  /// Num h), h being the distance between the halo and the inside cell
+  template<class Boundary> void exchange_halos(Boundary&& boundary) {
+    for (Ind p = 0, e = size(); p != e; ++p) {
+      for (SInd pos = 0; pos != no_faces; ++pos) {
+        fill_halo_(p, pos, boundary);
+      }
+    }
+  }
+
+ private:
+  std::vector<NodeIdx> nodes_;
+  std::vector<std::array<Face, no_faces>> faces_;
+  NumM<nd> xMin_;  ///< Lower corner of each patch
+  NumV h_;         ///< Cell length of each patch
+  NumV values_;
+
+  template<class Boundary>
+  void fill_halo_(const Ind p, const SInd pos, Boundary& boundary) {
+    const auto& face = faces_[p][pos];
+    const SInd d = pos / 2;
+    const bool positive = pos % 2;
+    const SInd haloLayer = positive ? k : -1;
+    const SInd adjacentLayer = positive ? 0 : k - 1;  ///< in the neighbor
+    for_each_face_cell(d, [&](SIndA<nd> c) {
+      c(d) = haloLayer;
+      const Ind i = index(c);
+      switch (face.kind) {
+        case Neighbor::samelevel: {
+          c(d) = adjacentLayer;
+          const Ind j = index(c);
+          for (SInd v = 0; v != nvars; ++v) {
+            (*this)(p, v, i) = (*this)(face.patch, v, j);
+          }
+          break;
+        }
+        case Neighbor::coarser: {
+          const auto coarse = coarser_cell(p, pos, c);
+          for (SInd v = 0; v != nvars; ++v) {
+            (*this)(p, v, i) = (*this)(coarse.first, v, coarse.second);
+          }
+          break;
+        }
+        case Neighbor::finer: {
+          SInd cPos = positive ? 0 : (1 << d);
+          for (SInd dd = 0; dd != nd; ++dd) {
+            if (dd != d && c(dd) >= k / 2) { cPos |= (1 << dd); }
+          }
+          const Ind q = face.finePatches[cPos];
+          for (SInd v = 0; v != nvars; ++v) { (*this)(p, v, i) = 0.; }
+          for (SInd t = 0; t != no_childs; ++t) {
+            SIndA<nd> fc;
+            for (SInd dd = 0; dd != nd; ++dd) {
+              fc(dd) = 2 * (c(dd) % (k / 2)) + ((t >> dd) & 1);
+            }
+            fc(d) = positive ? ((t >> d) & 1) : k - 1 - ((t >> d) & 1);
+            const Ind j = index(fc);
+            for (SInd v = 0; v != nvars; ++v) {
+              (*this)(p, v, i) += (*this)(q, v, j) / no_childs;
+            }
+          }
+          break;
+        }
+        case Neighbor::boundary: {
+          const NumA<nd> xHalo = x_center(p, c);
+          c(d) = positive ? k - 1 : 0;
+          const Ind j = index(c);
+          NumA<nvars> qInside;
+          for (SInd v = 0; v != nvars; ++v) { qInside(v) = (*this)(p, v, j); }
+          const NumA<nvars> qHalo = boundary(xHalo, qInside, h_(p));
+          for (SInd v = 0; v != nvars; ++v) { (*this)(p, v, i) = qHalo(v); }
+          break;
+        }
+      }
+    });
+  }
+};
+
+}  // namespace patches
+
+////////////////////////////////////////////////////////////////////////////////
+}}}  // namespace hom3::solver::fv
+////////////////////////////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,102 @@
+#ifndef HOM3_SOLVERS_FV_PROBES_HPP_
+#define HOM3_SOLVERS_FV_PROBES_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Probes: sample a solver at fixed points as a time series
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "globals.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Set of probe points at which some variables of a solver are sampled
+/// every \p interval solution steps
+///
+/// A solver reads its probe sets from the optional property "probes" of type
+/// std::vector<Probes<nd>>. Each set is written to the file "name.dat" as a
+/// compact ASCII time series: a header listing the probe points and the
+/// sampled variables, followed by a line per sample containing the step, the
+/// time, and the value of each variable at each point (points outside of the
+/// solver domain are written as NaN).
+///
+/// The output file is opened once by write_header, and each sample is
+/// appended to it by write_sample. Copies of a probe set share its file.
+template<SInd nd> struct Probes {
+  Probes(String name_, NumAV<nd> points_, std::vector<SInd> variables_,
+         const Ind interval_)
+    : name(name_), points(points_), variables(variables_)
+    , interval(interval_) {}
+
+  String name;                  ///< Name of the probe set (and output file)
+  NumAV<nd> points;             ///< Probe locations
+  std::vector<SInd> variables;  ///< Sampled variables
+  Ind interval;                 ///< Sampling interval (in solution steps)
+  std::shared_ptr<std::ofstream> file;  ///< Output file (see write_header)
+
+  /// \brief Name of the probe set output file
+  String file_name() const { return name + ".dat"; }
+
+  /// \brief Is the probe set to be sampled at solution step \p step?
+  bool sample_at(const Ind step) const noexcept
+  { return interval > 0 && step % interval == 0; }
+};
+
+/// \brief Opens the output file of the \p probes, overwriting an existing
+/// one, and writes the header of their time series
+///
+/// \p variable_name(v) returns the name of the variable \p v
+template<SInd nd, class VariableName>
+void write_header(Probes<nd>& probes, VariableName&& variable_name) {
+  probes.file
+    = std::make_shared<std::ofstream>(probes.file_name(), std::ios::trunc);
+  if (!*probes.file) {
+    TERMINATE("can't open probe file " + probes.file_name());
+  }
+  auto& file = *probes.file;
+  file << "# probe set: " << probes.name << "\n";
+  for (Ind p = 0, e = probes.points.size(); p != e; ++p) {
+    file << "# point " << p << ":";
+    for (SInd d = 0; d != nd; ++d) { file << " " << probes.points[p](d); }
+    file << "\n";
+  }
+  file << "# step time";
+  for (Ind p = 0, e = probes.points.size(); p != e; ++p) {
+    for (auto v : probes.variables) {
+      file << " " << variable_name(v) << "@" << p;
+    }
+  }
+  file << "\n";
+}
+
+/// \brief Appends the \p values sampled at \p step and \p time to the time
+/// series of the \p probes
+///
+/// \p values is a (#of points, #of variables) matrix
+///
+/// \requires the output file has been opened by write_header
+template<SInd nd>
+void write_sample(Probes<nd>& probes, const Ind step, const Num time,
+                  const EigenDynColMajor<Num>& values) {
+  ASSERT(probes.file, "probe file " + probes.file_name() + " not opened!");
+  auto& file = *probes.file;
+  file << std::setprecision(std::numeric_limits<Num>::digits10 + 2)
+       << step << " " << time;
+  for (Ind p = 0, ep = values.rows(); p != ep; ++p) {
+    for (Ind v = 0, ev = values.cols(); v != ev; ++v) {
+      file << " " << values(p, v);
+    }
+  }
+  file << "\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+}  // namespace fv
+}  // namespace solver
+}  // namespace hom3
+////////////////////////////////////////////////////////////////////////////////
+#endif
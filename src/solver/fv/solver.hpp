@@ -2,13 +2,23 @@
 #define HOM3_SOLVERS_FV_SOLVER_HPP_
 ////////////////////////////////////////////////////////////////////////////////
 /// Includes:
+#include <array>
+#include <cmath>
 #include <limits>
 #include <vector>
 #include <algorithm>
+#include <utility>
+#include <functional>
+#include <memory>
+#include <type_traits>
 #include "grid/grid.hpp"
 #include "solver/fv/boundary_condition.hpp"
 #include "solver/fv/container.hpp"
 #include "solver/fv/tags.hpp"
+#include "solver/fv/probes.hpp"
+#include "solver/fv/implicit.hpp"
+#include "solver/fv/multigrid.hpp"
+#include "solver/fv/cfl_control.hpp"
 #include "geometry/algorithms.hpp"
 #include "quadrature/quadrature.hpp"
 /// Options:
@@ -57,12 +67,19 @@ namespace fv {
 ///
 /// Optional requirements on physics component:
 /// - template<class _> bool check_variables(CellIdx cIdx) const;
+/// - template<class _> bool valid_variables(CellIdx cIdx) const; (read by
+///   the CFL controller, see cfl_control::Settings; without it only the
+///   finiteness of the variables is checked)
+/// - template<class _> void prepare_num_fluxes();
+///   template<class _> void release_num_fluxes(); (precompute cell quantities
+///   read by compute_num_flux from the _ variables, see prepare_num_fluxes)
 template<template <class> class PhysicsTT, class TimeIntegration>
 struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
   /// \name Type traits
   ///@{
   using Physics           = PhysicsTT<Solver<PhysicsTT, TimeIntegration>>;
   using physics_type      = typename Physics::physics_type;
+  using time_integration_type = TimeIntegration;
   static const SInd nd    = Physics::nd;
   static const SInd nvars = Physics::nvars;
 
@@ -74,6 +91,7 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
   using Boundaries        = std::vector<Boundary>;
 
   using Grid              = grid::CartesianHSP<nd>;
+  using ProbeSets         = std::vector<Probes<nd>>;
   ///@}
 
   /// \name Solver interface
@@ -85,12 +103,21 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
   /// - grid
   /// - maxNoCells
   /// - any extra properties required by the Physics class
+  ///
+  /// Optional properties are:
+  /// - probes (see Probes)
+  /// - settings of implicit time integration methods (see implicit::Settings)
+  /// - settings of the CFL controller (see cfl_control::Settings)
   Solver(SolverIdx solverId, io::Properties input)
     : Physics(input)
     , solverIdx_(SolverIdx{solverId})
     , properties_(input)
     , grid_(*(io::read<Grid*>(input, "grid")))
     , cells_(io::read<Ind>(input, "maxNoCells"))
+    , probes_(io::read_or<ProbeSets>(input, "probes", ProbeSets{}))
+    , implicitSettings_(input)
+    , cflController_(input)
+    , noAdaptations_(0)
     , firstGC_(invalid<CellIdx>())
     {}
   ~Solver() {}
@@ -105,18 +132,142 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
   /// \complexity O(1)
   inline Num time() const noexcept { return time_; }
   /// \brief Returns the min required time-step
-  /// \complexity O(N)
-  inline Num min_dt() const noexcept { return compute_dt(); }
+  ///
+  /// The explicit Runge-Kutta methods compute it while updating the
+  /// solution, and the cached value is returned until the lhs is modified
+  /// through the solver interface.
+  /// \warning modifying the lhs directly (e.g. via Q) between steps requires
+  /// calling invalidate_dt.
+  /// \complexity O(1) after an explicit Runge-Kutta step, O(N) otherwise
+  inline Num min_dt() const noexcept {
+    return cflController_.factor
+           * (std::isnan(nextDt_) ? compute_dt() : nextDt_);
+  }
+  /// \brief Returns the factor of the CFL controller, by which the time-step
+  /// of the physics is scaled (see cfl_control::Settings)
+  /// \complexity O(1)
+  inline Num cfl_factor() const noexcept { return cflController_.factor; }
+  /// \brief Returns the #of steps rolled back by the CFL controller
+  /// \complexity O(1)
+  inline Ind no_rejected_steps() const noexcept
+  { return cflController_.noRejectedSteps; }
+  /// \brief Is the CFL controller enabled (see cfl_control::Settings)?
+  /// \complexity O(1)
+  inline bool cfl_controlled() const noexcept
+  { return cflController_.settings.enabled; }
+  /// \brief Discards the time-step cached by min_dt (the lhs has been
+  /// modified)
+  /// \complexity O(1)
+  inline void invalidate_dt() noexcept
+  { nextDt_ = std::numeric_limits<Num>::quiet_NaN(); }
   /// \brief Returns the current dimensionless solution time-step
   /// \complexity O(1)
   inline Num dt() const noexcept { return dt_; }
   /// \brief Specifies the dimensionless solution time-step to be used
   /// \complexity O(1)
   inline void dt(const Num dt__) noexcept { return force_dt(dt__); }
+  /// \brief Returns the RMS norm over the internal cells of the steady
+  /// residual dQ/dt of the last solution step
+  /// \warning only computed by the pseudo_time_stepping time integration
+  /// \complexity O(1)
+  inline Num residual_norm() const noexcept { return residualNorm_; }
+  /// \brief Returns the #of conjugate gradient iterations of the last step
+  /// \warning only computed by the linear implicit time integration methods
+  /// \complexity O(1)
+  inline Ind no_linear_iterations() const noexcept
+  { return linearIterations_; }
+  /// \brief Returns the #of times the solver cells have been rebuilt by adapt
+  /// (cell indices obtained before an adaptation are invalid)
+  /// \complexity O(1)
+  inline Ind no_adaptations() const noexcept { return noAdaptations_; }
   /// \brief Returns the maximum dimensionless solution time allowed
   /// \warning executing solve for time >= final_time is undefined
   /// \complexity O(1)
   inline Num final_time() const noexcept { return tEnd_; }
+  /// \brief Specifies the maximum dimensionless solution time allowed
+  /// \complexity O(1)
+  inline void final_time(const Num tEnd) noexcept { tEnd_ = tEnd; }
+  /// \brief Returns the lhs variables of the internal cells (stored cell by
+  /// cell)
+  /// \complexity O(N)
+  NumV state() const noexcept {
+    NumV q(no_internal_cells() * nvars);
+    Ind i = 0;
+    for (auto cIdx : internal_cells()) {
+      q.segment(i++ * nvars, nvars) = Q<lhs_tag>(cIdx);
+    }
+    return q;
+  }
+  /// \brief Sets the lhs variables of the internal cells to \p q (see
+  /// state()) and the solution time to \p t
+  ///
+  /// Multi-step methods restart with their first step.
+  /// \complexity O(N)
+  void state(const NumV& q, const Num t) noexcept {
+    ASSERT(q.size() == no_internal_cells() * nvars, "wrong state size!");
+    Ind i = 0;
+    for (auto cIdx : internal_cells()) {
+      Q(lhs, cIdx) = q.segment(i++ * nvars, nvars).transpose();
+    }
+    invalidate_dt();
+    time_ = t;
+    previousQ_.resize(0);
+    previousDt_ = 0;
+  }
+  /// \brief Coarsens the grid nodes \p coarsenIds, whose children must be
+  /// leafs of this solver, then refines the leaf nodes \p refineIds, and
+  /// rebuilds the solver cells
+  ///
+  /// Coarsened cells get the average of their children (conservative), refined
+  /// cells inherit the value of their parent. Multi-step methods restart with
+  /// their first step.
+  ///
+  /// \warning the cells of other solvers on the grid are not rebuilt: the
+  /// grid nodes of other solvers must not be modified.
+  /// \complexity O(N)
+  void adapt(const std::vector<NodeIdx>& refineIds,
+             const std::vector<NodeIdx>& coarsenIds) noexcept {
+    NumM<nvars> nodeQ(grid().capacity(), nvars);
+    for (auto cIdx : internal_cells()) {
+      nodeQ.row(node_idx(cIdx)()) = Q(lhs, cIdx);
+      grid().cell_idx(node_idx(cIdx), solver_idx()) = invalid<CellIdx>();
+    }
+    for (auto nIdx : coarsenIds) {
+      nodeQ.row(nIdx()).setZero();
+      for (auto childIdx : grid().childs(nIdx)) {
+        nodeQ.row(nIdx()) += nodeQ.row(childIdx());
+      }
+      nodeQ.row(nIdx()) /= grid().no_child_positions();
+      grid().coarsen_node(nIdx);
+    }
+    for (auto nIdx : refineIds) {
+      grid().refine_node(nIdx);
+      for (auto childIdx : grid().childs(nIdx)) {
+        nodeQ.row(childIdx()) = nodeQ.row(nIdx());
+      }
+    }
+
+    grid().clear_distance_field();
+    cells().clear();
+    firstGC_ = invalid<CellIdx>();
+    create_local_cells();
+    for (auto cIdx : internal_cells()) {
+      Q(lhs, cIdx) = nodeQ.row(node_idx(cIdx)());
+      Q(rhs, cIdx) = Q(lhs, cIdx);
+    }
+    previousQ_.resize(0);
+    previousDt_ = 0;
+    invalidate_dt();
+    apply_bcs(lhs);
+    ++noAdaptations_;
+  }
+  /// \brief Imposes the initial condition again, e.g. after adapting the
+  /// initial grid
+  /// \complexity O(N)
+  void reset_initial_condition() noexcept {
+    impose_initial_condition();
+    apply_bcs(lhs);
+  }
   /// \brief Maps a local id to a global id
   /// \complexity O(1)
   const NodeIdx node_idx(const CellIdx cIdx) const noexcept {
@@ -135,17 +286,81 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
     create_local_cells();
     impose_initial_condition();
     set_dt();
+    for (auto& probes : probes_) {
+      write_header(probes, [](const SInd v) { return Solver::V::cv_names(v); });
+    }
   }
   /// \brief Advances the solution by a single step
+  ///
+  /// With the CFL controller enabled, invalid steps are rolled back and
+  /// retried with a smaller time-step (see cfl_control::solve).
+  /// \warning coupled solvers must be advanced with coupling::solve instead,
+  /// such that they retry their steps together with the same time-step.
   void solve() noexcept {
+    if (cflController_.settings.enabled) {
+      cfl_control::solve(*this);
+    } else {
+      evolve_step();
+      advance();
+    }
+  }
+  ///@}
+
+  // Following members are public but not part of the solver interface
+
+  /// \name Step control (see cfl_control::solve)
+  ///@{
+
+  /// \brief Saves the solution at the beginning of the step (see
+  /// reject_step)
+  void save_step() noexcept {
+    stepQ_ = state();
+    stepPreviousQ_ = previousQ_;
+    stepPreviousDt_ = previousDt_;
+  }
+  /// \brief Updates the solution with the time-step of the current step,
+  /// without advancing the solution time (see accept_step)
+  void evolve_step() noexcept {
     apply_bcs(lhs);
     set_dt();
     evolve();
+  }
+  /// \brief Rolls the solution back to the one saved by save_step and
+  /// forces the time-step reduced by the CFL controller for the retry
+  ///
+  /// \returns false if the CFL factor dropped below its minimum
+  bool reject_step() noexcept {
+    const bool canRetry = cflController_.reject();
+    std::cerr << "CFL controller | " << domain_name() << " | step " << step()
+              << " rejected | CFL factor: " << cflController_.factor << "\n";
+    Ind i = 0;
+    for (auto cIdx : internal_cells()) {
+      Q(lhs, cIdx) = stepQ_.segment(i++ * nvars, nvars).transpose();
+    }
+    previousQ_ = stepPreviousQ_;
+    previousDt_ = stepPreviousDt_;
+    invalidate_dt();
+    force_dt(dt_ * cflController_.settings.reduction);
+    return canRetry;
+  }
+  /// \brief Accepts the step and advances the solution time
+  void accept_step() noexcept {
+    cflController_.accept();
     advance();
   }
-  ///@}
+  /// \brief Are the lhs variables of all internal cells finite and valid
+  /// (see the physics' valid_variables)?
+  bool valid_solution() const noexcept {
+    for (auto cIdx : internal_cells()) {
+      if (!Q<lhs_tag>(cIdx).allFinite()
+          || !valid_variables_(cIdx, physics())) {
+        return false;
+      }
+    }
+    return true;
+  }
 
-  // Following members are public but not part of the solver interface
+  ///@}
 
   /// \name Input
   ///@{
@@ -279,6 +494,29 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
                                  firstGC_ : cells().last());
   }
 
+  /// \brief Sparse Jacobian of the increments of the part \p Part of the
+  /// physics over the current time-step w.r.t. the variables of the internal
+  /// cells (ordered cell by cell), evaluated at the current lhs
+  ///
+  /// See jacobian and implicit::Settings::jacobianStencilRadius.
+  template<class Part = flux_part::all>
+  implicit::SparseMatrix increments_jacobian(Part = Part()) noexcept {
+    std::vector<CellIdx> ids;
+    for (auto cIdx : internal_cells()) { ids.push_back(cIdx); }
+    return jacobian(ids, dt(), Part());
+  }
+
+  /// \brief Number of internal cells in uniform spans (see
+  /// find_uniform_spans)
+  inline Ind no_uniform_cells() const noexcept {
+    return no_internal_cells() - irregularCells_.size();
+  }
+
+  /// \brief Number of internal cells
+  inline Ind no_internal_cells() const noexcept {
+    return (is_valid(firstGC_) ? firstGC_ : cells().last())();
+  }
+
   /// \brief Range of global ids
   inline auto node_ids() const
   RETURNS(cell_ids() | cell_to_node() | grid().valid());
@@ -374,6 +612,18 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
 
     solver.physics()->template physics_output(out);
   }
+
+  /// \brief Samples the probe sets of \p solver that are due at the current
+  /// solution step
+  friend void write_probes(Solver& solver) noexcept {
+    bool bcsApplied = false;
+    for (auto& probes : solver.probes_) {
+      if (!probes.sample_at(solver.step())) { continue; }
+      if (!bcsApplied) { solver.apply_bcs(lhs); bcsApplied = true; }
+      write_sample(probes, solver.step(), solver.time(),
+                   solver.interpolate(probes.points, probes.variables));
+    }
+  }
   ///@}
 
  private:
@@ -390,6 +640,55 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
   CellContainer cells_;
   /// Boundary conditions
   Boundaries boundaryConditions_;
+  /// Probe sets
+  ProbeSets probes_;
+
+  /// \brief Interface between cells at different refinement levels
+  ///
+  /// The cell bndryIdx has a same-level ghost cell ghostIdx at the position
+  /// ghostPos, whose value is the average of the source cells:
+  /// - coarse side: the children of the refined neighbor node,
+  /// - fine side: the coarse leaf neighboring the parent node.
+  struct LevelInterface {
+    CellIdx ghostIdx;              ///< Ghost cell index
+    CellIdx bndryIdx;              ///< Index of the cell at the interface
+    SInd ghostPos;                 ///< Ghost cell position wrt bndryIdx
+    bool coarseSide;               ///< Is bndryIdx the coarse cell?
+    std::vector<CellIdx> sources;  ///< Cells that fill the ghost cell
+  };
+  /// Level interfaces (sorted by ghost cell index)
+  std::vector<LevelInterface> levelInterfaces_;
+
+  /// \brief Run of consecutive internal cells [first, last) whose neighbors
+  /// along each direction d are the cells at the offsets -/+ strides[d]
+  /// (strides[0] = 1), as in a lexicographically ordered uniform block
+  struct UniformSpan {
+    CellIdx first;
+    CellIdx last;
+    std::array<Ind, nd> strides;
+  };
+  /// Uniform spans of the internal cells (see find_uniform_spans)
+  std::vector<UniformSpan> uniformSpans_;
+  /// Internal cells that are not in a uniform span
+  std::vector<CellIdx> irregularCells_;
+
+  /// \brief Tile of time_integration::tiled_runge_kutta_2 (see build_tiles)
+  struct Tile {
+    std::vector<CellIdx> cells;     ///< Cells updated in place
+    std::vector<CellIdx> halo;      ///< Neighbor layers of the tile
+    Ind firstDeferred;              ///< Cells [first, last) of deferredCells_
+    Ind lastDeferred;               ///< are updated at the end of the step
+  };
+  /// Tiles of the internal cells
+  std::vector<Tile> tiles_;
+  /// Cells read by the halos of later tiles (updated at the end of the step)
+  std::vector<CellIdx> deferredCells_;
+  /// Updated solution of the deferred cells
+  NumM<nvars> deferredQ_;
+  /// Solution at the beginning of the step (SSP Runge-Kutta methods)
+  NumM<nvars> initialQ_;
+  /// Internal cells read by the boundary conditions
+  std::vector<CellIdx> boundarySources_;
 
   Boundaries& boundary_conditions() noexcept { return boundaryConditions_; }
   const Boundaries& boundary_conditions() const noexcept
@@ -397,6 +696,15 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
   const Boundary& boundary_condition(const SInd bcIdx) const noexcept {
     return boundaryConditions_[bcIdx];
   }
+  /// \brief bcIdx of the ghost cells at level interfaces
+  SInd level_interface_bc_idx() const noexcept
+  { return boundary_conditions().size(); }
+  /// \brief Level interface of the ghost cell \p ghostIdx
+  const LevelInterface& level_interface(const CellIdx ghostIdx) const noexcept {
+    ASSERT(cells().bc_idx(ghostIdx) == level_interface_bc_idx(),
+           "not a level interface ghost cell!");
+    return levelInterfaces_[ghostIdx() - levelInterfaces_.front().ghostIdx()];
+  }
 
   ///@}
 
@@ -414,6 +722,34 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
   Num forced_dt_;
   /// Step at which the dt is to be forced to equal forced_dt_
   Ind forced_dt_step_;
+  /// Settings of implicit time integration methods
+  const implicit::Settings implicitSettings_;
+  /// CFL controller
+  cfl_control::Controller cflController_;
+  /// Time-step of the next step computed by the last update pass (NaN if
+  /// the lhs has been modified since)
+  Num nextDt_;
+  /// Solution at the beginning of the previous step (multi-step methods)
+  NumV previousQ_;
+  /// Previous time-step (multi-step methods)
+  Num previousDt_;
+  /// Solution, previousQ_ and previousDt_ at the beginning of the step (see
+  /// save_step)
+  NumV stepQ_;
+  NumV stepPreviousQ_;
+  Num stepPreviousDt_;
+  /// Norm of the steady residual (pseudo-time stepping)
+  Num residualNorm_;
+  /// #of conjugate gradient iterations of the last step (linear implicit)
+  Ind linearIterations_;
+  /// Multigrid preconditioner of the linear implicit methods, and the
+  /// implicit time-step and #of adaptations it has been built for (see
+  /// linear_multigrid)
+  std::shared_ptr<multigrid::Multigrid> multigrid_;
+  Num multigridDt_;
+  Ind multigridAdaptations_;
+  /// #of calls to adapt
+  Ind noAdaptations_;
 
   ///@}
 
@@ -437,7 +773,29 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
 
   /// \brief Computes the numerical flux
   template<class T>
-  inline NumA<nvars> num_flux(const CellIdx cIdx) const noexcept {
+  inline NumA<nvars> num_flux(const CellIdx cIdx) const noexcept
+  { return num_flux<T>(cIdx, dt()); }
+
+  /// \brief Computes the numerical flux for the time-step \p timeStep
+  template<class T>
+  inline NumA<nvars> num_flux(const CellIdx cIdx,
+                              const Num timeStep) const noexcept
+  { return num_flux<T>(cIdx, timeStep, flux_part::all()); }
+
+  /// \brief Computes the part \p Part of the numerical flux for the time-step
+  /// \p timeStep (see flux_part)
+  template<class T, class Part>
+  inline NumA<nvars> num_flux(const CellIdx cIdx, const Num timeStep,
+                              Part) const noexcept {
+    return num_flux<T>(cIdx, timeStep, Part(), table_neighbors{cells()});
+  }
+
+  /// \brief Computes the part \p Part of the numerical flux for the time-step
+  /// \p timeStep, with the neighbors of \p cIdx given by \p nghbrs
+  /// (table_neighbors or implicit_neighbors)
+  template<class T, class Part, class Neighbors>
+  inline NumA<nvars> num_flux(const CellIdx cIdx, const Num timeStep, Part,
+                              const Neighbors& nghbrs) const noexcept {
     DBG("first term in rhs:");
     DBGV((cIdx));
     NumA<nvars> result = NumA<nvars>::Zero();
@@ -445,18 +803,161 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
     for (auto d : grid().dimensions()) {
       const SInd nghbrM = d * 2;
       const SInd nghbrP = nghbrM + 1;
-      const auto nghbrMId = cells().neighbors(cIdx, nghbrM);
-      const auto nghbrPId = cells().neighbors(cIdx, nghbrP);
-      const auto flux_m = physics()->template
-                          compute_num_flux<T>(nghbrMId, cIdx, d, dx, dt());
-      const auto flux_p = physics()->template
-                          compute_num_flux<T>(cIdx, nghbrPId, d, dx, dt());
+      const auto nghbrMId = nghbrs(cIdx, nghbrM);
+      const auto nghbrPId = nghbrs(cIdx, nghbrP);
+      ASSERT(nghbrMId == cells().neighbors(cIdx, nghbrM)
+             && nghbrPId == cells().neighbors(cIdx, nghbrP),
+             "wrong neighbors of cell " << cIdx);
+      const auto flux_m
+        = face_num_flux<T>(nghbrMId, cIdx, d, dx, timeStep, Part());
+      const auto flux_p
+        = face_num_flux<T>(cIdx, nghbrPId, d, dx, timeStep, Part());
       result += (flux_m - flux_p);
-      DBGV((cIdx)(d)(dx)(dt())(nghbrMId)(nghbrPId)(flux_m)(flux_p)(result)
+      DBGV((cIdx)(d)(dx)(timeStep)(nghbrMId)(nghbrPId)(flux_m)(flux_p)(result)
            (Q<T>(nghbrMId))(Q<T>(cIdx))(Q<T>(nghbrPId)));
     }
     // return dt() / V * A * result.array();
-    return dt() / dx * result.array();
+    return timeStep / dx * result.array();
+  }
+
+  /// \brief Neighbors of a cell read from the neighbor table
+  struct table_neighbors {
+    const CellContainer& cells;
+    CellIdx operator()(const CellIdx cIdx, const SInd nghbrPos) const noexcept
+    { return cells.neighbors(cIdx, nghbrPos); }
+  };
+
+  /// \brief Neighbors of a cell of a uniform span, computed from its index
+  struct implicit_neighbors {
+    const std::array<Ind, nd>& strides;
+    CellIdx operator()(const CellIdx cIdx, const SInd nghbrPos) const noexcept {
+      const Ind stride = strides[nghbrPos / 2];
+      return CellIdx{nghbrPos % 2 ? cIdx() + stride : cIdx() - stride};
+    }
+  };
+
+  /// \brief Numerical flux of the physics between \p lIdx and \p rIdx
+  template<class T>
+  inline NumA<nvars> physics_num_flux
+  (const CellIdx lIdx, const CellIdx rIdx, const SInd d, const Num dx,
+   const Num timeStep, flux_part::all) const noexcept {
+    return physics()->template compute_num_flux<T>(lIdx, rIdx, d, dx, timeStep);
+  }
+
+  /// \brief Numerical flux across the face between \p lIdx and \p rIdx,
+  /// one of which has the cell length \p dx
+  ///
+  /// At level interfaces the ghost cell is replaced by the cells it stands
+  /// for:
+  /// - fine side: the ghost cell holds the value of the coarse cell, whose
+  ///   center is at the distance 1.5 dx,
+  /// - coarse side: the flux is the average of the fluxes across the fine
+  ///   faces, such that the fluxes across both sides of the interface are
+  ///   the same (conservative). Local time stepping corrects the coarse-side
+  ///   fluxes itself (see advance_level) and uses the ghost cell instead.
+  template<class T, class Part>
+  inline NumA<nvars> face_num_flux
+  (const CellIdx lIdx, const CellIdx rIdx, const SInd d, const Num dx,
+   const Num timeStep, Part) const noexcept {
+    if (is_level_interface_ghost(lIdx) || is_level_interface_ghost(rIdx)) {
+      return level_interface_flux<T>(lIdx, rIdx, d, dx, timeStep, Part());
+    }
+    return physics_num_flux<T>(lIdx, rIdx, d, dx, timeStep, Part());
+  }
+
+  /// \brief Is \p cIdx a ghost cell at a level interface?
+  inline bool is_level_interface_ghost(const CellIdx cIdx) const noexcept {
+    return !levelInterfaces_.empty() && is_valid(cIdx)
+           && cIdx >= levelInterfaces_.front().ghostIdx;
+  }
+
+  /// \brief Numerical flux across the level interface face between \p lIdx
+  /// and \p rIdx, one of which is a level interface ghost cell (see
+  /// face_num_flux)
+  template<class T, class Part>
+  NumA<nvars> level_interface_flux
+  (const CellIdx lIdx, const CellIdx rIdx, const SInd d, const Num dx,
+   const Num timeStep, Part) const noexcept {
+    using namespace container::hierarchical;
+    const bool ghostIsRight = is_level_interface_ghost(rIdx);
+    const auto& li = level_interface(ghostIsRight ? rIdx : lIdx);
+    if (!li.coarseSide) {
+      return physics_num_flux<T>(lIdx, rIdx, d, 1.5 * dx, timeStep, Part());
+    }
+    if (std::is_same<TimeIntegration,
+                     time_integration::local_time_stepping>::value) {
+      return physics_num_flux<T>(lIdx, rIdx, d, dx, timeStep, Part());
+    }
+    // position of the coarse cell with respect to the fine cells
+    const auto coarsePos = ghostIsRight ? neighbor_position(d, neg_dir)
+                                        : neighbor_position(d, pos_dir);
+    const Num fineDx = 0.5 * dx;
+    NumA<nvars> result = NumA<nvars>::Zero();
+    for (auto sIdx : li.sources) {
+      const auto fineGhostIdx = cells().neighbors(sIdx, coarsePos);
+      if (!is_level_interface_ghost(fineGhostIdx)) { continue; }  // not at face
+      result += ghostIsRight
+          ? physics_num_flux<T>(fineGhostIdx, sIdx, d, 1.5 * fineDx, timeStep,
+                                Part())
+          : physics_num_flux<T>(sIdx, fineGhostIdx, d, 1.5 * fineDx, timeStep,
+                                Part());
+    }
+    // ratio between the areas of a fine and a coarse face
+    return std::ldexp(1., 1 - nd) * result;
+  }
+
+  /// \brief Part \p Part of the numerical flux of the physics between \p
+  /// lIdx and \p rIdx (requires the Physics to split its flux into parts)
+  template<class T, class Part>
+  inline NumA<nvars> physics_num_flux
+  (const CellIdx lIdx, const CellIdx rIdx, const SInd d, const Num dx,
+   const Num timeStep, Part) const noexcept {
+    return physics()->template compute_num_flux<T>(lIdx, rIdx, d, dx, timeStep,
+                                                   Part());
+  }
+
+  /// \brief Increment of the conservative variables of cell \p cIdx over
+  /// the time-step \p timeStep due to the part \p Part of the physics, i.e.
+  /// the numerical flux, plus the source term (which belongs to the
+  /// convective part)
+  template<class T>
+  inline NumA<nvars> increment(const CellIdx cIdx, const Num timeStep,
+                               flux_part::all) const noexcept {
+    return num_flux<T>(cIdx, timeStep) + source_term(T(), cIdx);
+  }
+  template<class T>
+  inline NumA<nvars> increment(const CellIdx cIdx, const Num timeStep,
+                               flux_part::convective) const noexcept {
+    return num_flux<T>(cIdx, timeStep, flux_part::convective())
+           + source_term(T(), cIdx);
+  }
+  template<class T>
+  inline NumA<nvars> increment(const CellIdx cIdx, const Num timeStep,
+                               flux_part::diffusive) const noexcept {
+    return num_flux<T>(cIdx, timeStep, flux_part::diffusive());
+  }
+
+  /// \brief Computes the numerical flux across the face of cell \p cIdx at
+  /// the neighbor position \p nghbrPos (positive in the direction of the
+  /// face normal axis)
+  template<class T>
+  inline NumA<nvars> face_flux(const CellIdx cIdx, const SInd nghbrPos,
+                               const Num timeStep) const noexcept {
+    using namespace container::hierarchical;
+    const auto d = neighbor_direction(nghbrPos);
+    const auto nghbrIdx = cells().neighbors(cIdx, nghbrPos);
+    const auto dx = cells().length(cIdx);
+    return nghbrPos == neighbor_position(d, neg_dir)
+        ? face_num_flux<T>(nghbrIdx, cIdx, d, dx, timeStep, flux_part::all())
+        : face_num_flux<T>(cIdx, nghbrIdx, d, dx, timeStep, flux_part::all());
+  }
+
+  /// \brief Sign of the contribution of the flux across the face at the
+  /// neighbor position \p nghbrPos to the cell (see num_flux)
+  static inline Num face_sign(const SInd nghbrPos) noexcept {
+    using namespace container::hierarchical;
+    return nghbrPos == neighbor_position(neighbor_direction(nghbrPos), neg_dir)
+        ? 1. : -1.;
   }
 
   template<class T>
@@ -464,40 +965,789 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
     return physics()->template compute_source_term(T(), cIdx);
   }
 
+  /// \brief Lets the physics precompute the cell quantities that its
+  /// numerical flux reads from the \p T variables of all cells (e.g. see
+  /// euler::flux::cached)
+  ///
+  /// The \p T variables, including those of the ghost cells, must be up to
+  /// date, and those read by the numerical fluxes must not change until
+  /// release_num_fluxes(T). Physics without cached quantities need not
+  /// implement these hooks.
+  template<class T> inline void prepare_num_fluxes(T) noexcept
+  { prepare_num_fluxes_(T(), physics()); }
+  template<class T> inline void release_num_fluxes(T) noexcept
+  { release_num_fluxes_(T(), physics()); }
+
+  template<class T, class P>
+  inline auto prepare_num_fluxes_(T, P* p) noexcept
+  -> decltype(p->template prepare_num_fluxes<T>())
+  { p->template prepare_num_fluxes<T>(); }
+  template<class T> inline void prepare_num_fluxes_(T, ...) noexcept {}
+  template<class T, class P>
+  inline auto release_num_fluxes_(T, P* p) noexcept
+  -> decltype(p->template release_num_fluxes<T>())
+  { p->template release_num_fluxes<T>(); }
+  template<class T> inline void release_num_fluxes_(T, ...) noexcept {}
+
+  /// \brief Is \p cells the range of all internal cells?
+  template<class CellIdxRange>
+  inline bool are_internal_cells(CellIdxRange&&) const noexcept
+  { return false; }
+  inline bool are_internal_cells(const Range<CellIdx> cells) const noexcept {
+    return boost::begin(cells) == boost::begin(internal_cells())
+        && boost::end(cells) == boost::end(internal_cells());
+  }
+
+  /// \brief Caches the time-step \p nextDt of the next solution step, i.e.
+  /// the minimum cell time-step of the updated cells \p cells, if they are
+  /// all the internal cells (see min_dt)
+  template<class CellIdxRange>
+  inline void cache_dt(CellIdxRange&& cells, const Num nextDt) noexcept {
+    if (are_internal_cells(cells)) { nextDt_ = nextDt; }
+  }
+
+  /// \brief Applies \p f(cIdx, nghbrs) to each cell in range \p cells
+  ///
+  /// If \p cells are the internal cells, the cells of the uniform spans are
+  /// visited first with implicit_neighbors, then the remaining cells with
+  /// table_neighbors.
+  template<class CellIdxRange, class F>
+  inline void for_each_cell(CellIdxRange&& cells, F&& f) noexcept {
+    for_each_cell_(std::forward<CellIdxRange>(cells), f,
+                   std::is_same<std::decay_t<CellIdxRange>, Range<CellIdx>>{});
+  }
+  template<class CellIdxRange, class F>
+  inline void for_each_cell_(CellIdxRange&& cells, F& f,
+                             std::false_type) noexcept {
+    const table_neighbors nghbrs{this->cells()};
+    for (auto&& cIdx : cells) { f(cIdx, nghbrs); }
+  }
+  template<class F>
+  inline void for_each_cell_(const Range<CellIdx> cells, F& f,
+                             std::true_type) noexcept {
+    if (!are_internal_cells(cells)) {
+      for_each_cell_(cells, f, std::false_type{});
+      return;
+    }
+    for (const auto& span : uniformSpans_) {
+      const implicit_neighbors nghbrs{span.strides};
+      for (auto cIdx = span.first; cIdx != span.last; ++cIdx) {
+        f(cIdx, nghbrs);
+      }
+    }
+    const table_neighbors nghbrs{this->cells()};
+    for (const auto cIdx : irregularCells_) { f(cIdx, nghbrs); }
+  }
+
   /// \brief Performs an 1st-order Euler-Forward step for all cells in range \p
   /// cells
   template<class CellIdxRange>
   inline void evolve(CellIdxRange&& cells,
                      time_integration::euler_forward) noexcept {
-    for (auto&& cIdx : cells) {
-      Q(rhs, cIdx) = Q(lhs, cIdx) + num_flux<lhs_tag>(cIdx).transpose()
+    prepare_num_fluxes(lhs);
+    for_each_cell(cells, [&](const CellIdx cIdx, const auto& nghbrs) {
+      Q(rhs, cIdx) = Q(lhs, cIdx)
+                     + num_flux<lhs_tag>(cIdx, dt(), flux_part::all(), nghbrs)
+                       .transpose()
                      + source_term(lhs, cIdx).transpose();
-    }
+    });
+    release_num_fluxes(lhs);
+    Num nextDt = std::numeric_limits<Num>::max();
     for (auto&& cIdx : cells) {
       Q(lhs, cIdx) = Q(rhs, cIdx);
+      nextDt = std::min(nextDt, physics()->template compute_dt<lhs_tag>(cIdx));
     }
+    cache_dt(cells, nextDt);
   }
 
   /// \brief Performs a 2nd-order RK2 step for all cells in range \p cells
   template<class CellIdxRange>
   inline void evolve(CellIdxRange&& cells,
                      time_integration::runge_kutta_2) noexcept {
-    for (auto&& cIdx : cells) {
-      Q(rhs, cIdx) = Q(lhs, cIdx) + num_flux<lhs_tag>(cIdx).transpose();
+    prepare_num_fluxes(lhs);
+    for_each_cell(cells, [&](const CellIdx cIdx, const auto& nghbrs) {
+      Q(rhs, cIdx) = Q(lhs, cIdx)
+                     + num_flux<lhs_tag>(cIdx, dt(), flux_part::all(), nghbrs)
+                       .transpose();
+    });
+    release_num_fluxes(lhs);
+
+    apply_bcs(rhs);
+    prepare_num_fluxes(rhs);
+    Num nextDt = std::numeric_limits<Num>::max();
+    for_each_cell(cells, [&](const CellIdx cIdx, const auto& nghbrs) {
+      Q(lhs, cIdx) = 0.5 * (Q(lhs, cIdx) + Q<rhs_tag>(cIdx)
+                           + num_flux<rhs_tag>(cIdx, dt(), flux_part::all(),
+                                                nghbrs).transpose());
+      nextDt = std::min(nextDt, physics()->template compute_dt<lhs_tag>(cIdx));
+    });
+    release_num_fluxes(rhs);
+    cache_dt(cells, nextDt);
+  }
+
+  /// \brief Performs a tiled RK2 step for all cells in range \p cells (see
+  /// time_integration::tiled_runge_kutta_2)
+  ///
+  /// The first stage of the cells read by the boundary conditions is computed
+  /// upfront, such that the ghost cells can be updated once. Then each tile
+  /// computes the first stage in its cells and its halo, and the second stage
+  /// in its cells. The cells that the halos of later tiles read keep their
+  /// lhs until all tiles are done, so the result is that of runge_kutta_2.
+  ///
+  /// The flux cache of the lhs variables is filled once before the first
+  /// stage: the lhs variables that the first stage reads do not change until
+  /// the tiles are done. The rhs variables are computed tile by tile, so the
+  /// second stage evaluates its fluxes from the cell variables.
+  template<class CellIdxRange>
+  void evolve(CellIdxRange&& cells,
+              time_integration::tiled_runge_kutta_2) noexcept {
+    if (!are_internal_cells(cells)) {
+      evolve(cells, time_integration::runge_kutta_2{});
+      return;
     }
+    auto first_stage = [&](const CellIdx cIdx) {
+      Q(rhs, cIdx) = Q(lhs, cIdx) + num_flux<lhs_tag>(cIdx).transpose();
+    };
+    auto second_stage = [&](const CellIdx cIdx) -> NumA<nvars> {
+      return 0.5 * (Q(lhs, cIdx) + Q(rhs, cIdx)
+                    + num_flux<rhs_tag>(cIdx).transpose()).transpose();
+    };
+
+    Num nextDt = std::numeric_limits<Num>::max();
+    auto cell_dt = [&](const CellIdx cIdx) {
+      nextDt = std::min(nextDt, physics()->template compute_dt<lhs_tag>(cIdx));
+    };
 
+    prepare_num_fluxes(lhs);
+    for (auto cIdx : boundarySources_) { first_stage(cIdx); }
     apply_bcs(rhs);
+    for (const auto& tile : tiles_) {
+      for (auto cIdx : tile.cells) { first_stage(cIdx); }
+      for (Ind i = tile.firstDeferred; i != tile.lastDeferred; ++i) {
+        first_stage(deferredCells_[i]);
+      }
+      for (auto cIdx : tile.halo) { first_stage(cIdx); }
+
+      for (Ind i = tile.firstDeferred; i != tile.lastDeferred; ++i) {
+        deferredQ_.row(i) = second_stage(deferredCells_[i]).transpose();
+      }
+      for (auto cIdx : tile.cells) {
+        Q(lhs, cIdx) = second_stage(cIdx).transpose();
+        cell_dt(cIdx);
+      }
+    }
+    release_num_fluxes(lhs);
+    for (Ind i = 0, e = deferredCells_.size(); i != e; ++i) {
+      Q(lhs, deferredCells_[i]) = deferredQ_.row(i);
+      cell_dt(deferredCells_[i]);
+    }
+    cache_dt(cells, nextDt);
+  }
+
+  /// \brief Performs a step of the 2N-storage Runge-Kutta method \p TI for
+  /// all cells in range \p cells
+  ///
+  /// The rhs variables store the stage increment dq, no extra copies of the
+  /// solution are needed (see time_integration::low_storage_runge_kutta).
+  template<class CellIdxRange, class TI,
+           EnableIf<time_integration::is_low_storage<TI>> = traits::dummy>
+  inline void evolve(CellIdxRange&& cells, TI) noexcept {
+    Num nextDt = std::numeric_limits<Num>::max();
+    for (SInd stage = 0; stage != TI::no_stages(); ++stage) {
+      if (stage != 0) { apply_bcs(lhs); }
+      const Num a = TI::A(stage);
+      const Num b = TI::B(stage);
+      prepare_num_fluxes(lhs);
+      for_each_cell(cells, [&](const CellIdx cIdx, const auto& nghbrs) {
+        const NumA<nvars> dq
+          = num_flux<lhs_tag>(cIdx, dt(), flux_part::all(), nghbrs)
+            + source_term(lhs, cIdx);
+        if (stage == 0) {  // A(0) = 0: don't read the uninitialized dq
+          Q(rhs, cIdx) = dq.transpose();
+        } else {
+          Q(rhs, cIdx) = a * Q<rhs_tag>(cIdx) + dq.transpose();
+        }
+      });
+      release_num_fluxes(lhs);
+      const bool lastStage = stage + 1 == TI::no_stages();
+      for (auto&& cIdx : cells) {
+        Q(lhs, cIdx) += b * Q<rhs_tag>(cIdx);
+        if (lastStage) {
+          nextDt
+            = std::min(nextDt, physics()->template compute_dt<lhs_tag>(cIdx));
+        }
+      }
+    }
+    cache_dt(cells, nextDt);
+  }
+
+  /// \brief Performs a step of the SSP Runge-Kutta method \p TI for all
+  /// cells in range \p cells
+  ///
+  /// The rhs variables store the stage increment dq and initialQ_ the
+  /// solution at the beginning of the step (see
+  /// time_integration::ssp_runge_kutta).
+  template<class CellIdxRange, class TI,
+           EnableIf<time_integration::is_ssp<TI>> = traits::dummy>
+  inline void evolve(CellIdxRange&& cells, TI) noexcept {
+    initialQ_.resize(this->cells().size(), nvars);  // no-op if same size
+    for (auto&& cIdx : cells) { initialQ_.row(cIdx()) = Q(lhs, cIdx); }
+    Num nextDt = std::numeric_limits<Num>::max();
+    for (SInd stage = 0; stage != TI::no_stages(); ++stage) {
+      if (stage != 0) { apply_bcs(lhs); }
+      const Num alpha = TI::alpha(stage);
+      const Num beta = TI::beta(stage);
+      prepare_num_fluxes(lhs);
+      for_each_cell(cells, [&](const CellIdx cIdx, const auto& nghbrs) {
+        Q(rhs, cIdx)
+          = (num_flux<lhs_tag>(cIdx, dt(), flux_part::all(), nghbrs)
+             + source_term(lhs, cIdx)).transpose();
+      });
+      release_num_fluxes(lhs);
+      const bool lastStage = stage + 1 == TI::no_stages();
+      for (auto&& cIdx : cells) {
+        Q(lhs, cIdx) = alpha * initialQ_.row(cIdx())
+                       + (1. - alpha) * Q<lhs_tag>(cIdx)
+                       + beta * Q<rhs_tag>(cIdx);
+        if (lastStage) {
+          nextDt
+            = std::min(nextDt, physics()->template compute_dt<lhs_tag>(cIdx));
+        }
+      }
+    }
+    cache_dt(cells, nextDt);
+  }
+
+  /// \brief Performs a step of the implicit method \p TI for all cells in
+  /// range \p cells
+  ///
+  /// The nonlinear system R(q) = q - a1 q^n + a2 q^{n-1} - beta dt L(q) = 0
+  /// is solved with Newton's method, in which each linear system J dq = -R is
+  /// solved with GMRES: the Jacobian-vector products are approximated by
+  /// finite differences of the residual, and the preconditioner is the inverse
+  /// of the block-diagonal of J (computed once per step).
+  template<class CellIdxRange, class TI,
+           EnableIf<time_integration::is_implicit<TI>> = traits::dummy>
+  void evolve(CellIdxRange&& cells, TI) noexcept {
+    std::vector<CellIdx> ids;
+    for (auto&& cIdx : cells) { ids.push_back(cIdx); }
+    const Ind n = ids.size() * nvars;
+
+    const SInd order = previousQ_.size() == n && previousDt_ > 0.
+                       ? TI::order() : 1;
+    const auto c = implicit::bdf_coefficients(order, dt(), previousDt_);
+
+    NumV q(n), b(n);
+    gather(ids, q);
+    b = c.a1 * q;
+    if (order == 2) { b -= c.a2 * previousQ_; }
+    previousQ_ = q;
+    previousDt_ = dt();
+
+    newton_krylov(ids, b, c.beta, q, flux_part::all());
+    scatter(ids, q);
+  }
+
+  /// \brief Performs a step of the IMEX Runge-Kutta method \p TI for all
+  /// cells in range \p cells
+  ///
+  /// The convective part of the physics is integrated explicitly and its
+  /// diffusive part implicitly (see time_integration::imex_runge_kutta_2):
+  /// each implicit stage is solved with newton_krylov.
+  template<class CellIdxRange, class TI,
+           EnableIf<time_integration::is_imex<TI>> = traits::dummy>
+  void evolve(CellIdxRange&& cells, TI) noexcept {
+    std::vector<CellIdx> ids;
+    for (auto&& cIdx : cells) { ids.push_back(cIdx); }
+    const Ind n = ids.size() * nvars;
+    const Num gamma = TI::gamma();
+    const Num delta = TI::delta();
+
+    NumV q0(n), q(n), b(n), convective0(n), convective1(n), diffusive1(n);
+    gather(ids, q0);
+    increments(ids, q0, dt(), convective0, flux_part::convective());
+
+    // stage 1: q1 - gamma dt D(q1) = q0 + gamma dt C(q0)
+    q = q0;
+    b = q0 + gamma * convective0;
+    newton_krylov(ids, b, gamma, q, flux_part::diffusive());
+    increments(ids, q, dt(), convective1, flux_part::convective());
+    increments(ids, q, dt(), diffusive1, flux_part::diffusive());
+
+    // stage 2: q2 - gamma dt D(q2) = q0 + dt [delta C(q0) + (1 - delta) C(q1)
+    //                                        + (1 - gamma) D(q1)]
+    b = q0 + delta * convective0 + (1. - delta) * convective1
+        + (1. - gamma) * diffusive1;
+    newton_krylov(ids, b, gamma, q, flux_part::diffusive());
+    scatter(ids, q);  // the method is stiffly accurate: q^{n+1} = q2
+  }
+
+  /// \brief Solves R(q) = q - b - beta dt L_Part(q) = 0 at the cells \p ids
+  /// starting from the initial guess \p q
+  ///
+  /// Newton's method, in which each linear system J dq = -R is solved with
+  /// GMRES: the Jacobian-vector products are approximated by finite
+  /// differences of the residual, and the preconditioner (see
+  /// newton_krylov_preconditioner) is computed once at the initial guess.
+  template<class Part>
+  void newton_krylov(const std::vector<CellIdx>& ids, const NumV& b,
+                     const Num beta, NumV& q, Part) noexcept {
+    const Ind n = q.size();
+    const auto& settings = implicitSettings_;
+    NumV r(n), rPerturbed(n), dq(n);
+
+    scatter(ids, q);
+    const auto apply_preconditioner
+      = newton_krylov_preconditioner(ids, beta, Part());
+
+    implicit_residual(ids, q, b, beta, r, Part());
+    const Num r0 = r.norm();
+    Ind it = 0;
+    for (; it != settings.newtonMaxIterations
+           && r.norm() > settings.newtonTolerance * r0; ++it) {
+      auto jacobian_times = [&](const NumV& v, NumV& result) {
+        const Num vNorm = v.norm();
+        if (vNorm == 0.) { result.setZero(); return; }
+        const Num eps
+          = std::sqrt((1. + q.norm()) * std::numeric_limits<Num>::epsilon())
+            / vNorm;
+        implicit_residual(ids, q + eps * v, b, beta, rPerturbed, Part());
+        result = (rPerturbed - r) / eps;
+      };
+      dq.setZero();
+      implicit::gmres(jacobian_times, apply_preconditioner, -r, dq,
+                      settings.krylovTolerance, settings.krylovRestart,
+                      settings.krylovMaxIterations);
+      q += dq;
+      implicit_residual(ids, q, b, beta, r, Part());
+    }
+    if (r0 > 0. && r.norm() > settings.newtonTolerance * r0) {
+      std::cerr << "implicit solver | Newton didn't converge in " << it
+                << " iterations | |R|/|R0|: " << r.norm() / r0 << "\n";
+    }
+  }
+
+  /// \brief Performs a step of the linear implicit method \p TI for all cells
+  /// in range \p cells (see time_integration::linear_implicit_time_integration)
+  template<class CellIdxRange, class TI,
+           EnableIf<time_integration::is_linear_implicit<TI>> = traits::dummy>
+  void evolve(CellIdxRange&& cells, TI) noexcept {
+    std::vector<CellIdx> ids;
+    for (auto&& cIdx : cells) { ids.push_back(cIdx); }
+    const Ind n = ids.size() * nvars;
+    const Num theta = TI::theta();
+    const Num implicitDt = theta * dt();
+
+    NumV q(n), b(n), g(n), explicitPart(n);
+    gather(ids, q);
+    // the boundary values are the increments of the zero state
+    increments(ids, NumV::Zero(n), implicitDt, g, flux_part::all());
+    b = q + g;
+    if (theta < 1.) {
+      increments(ids, q, (1. - theta) * dt(), explicitPart, flux_part::all());
+      b += explicitPart;
+    }
+
+    scatter(ids, q);
+    auto apply_operator = [&](const NumV& v, NumV& result) {
+      increments(ids, v, implicitDt, result, flux_part::all());
+      result = v - (result - g);
+    };
+
+    NumV x = q;
+    const auto& settings = implicitSettings_;
+    if (settings.linearPreconditioner == "multigrid") {
+      linearIterations_
+        = implicit::conjugate_gradient(apply_operator,
+                                       linear_multigrid(implicitDt), b, x,
+                                       settings.linearTolerance,
+                                       settings.linearMaxIterations);
+    } else {
+      const auto preconditioner
+        = block_jacobi_preconditioner(ids, theta, flux_part::all());
+      auto apply_preconditioner = [&](const NumV& v, NumV& result) {
+        apply_block_jacobi(preconditioner, v, result);
+      };
+      linearIterations_
+        = implicit::conjugate_gradient(apply_operator, apply_preconditioner,
+                                       b, x, settings.linearTolerance,
+                                       settings.linearMaxIterations);
+    }
+    scatter(ids, x);
+    if (linearIterations_ == settings.linearMaxIterations) {
+      std::cerr << "implicit solver | CG didn't converge in "
+                << linearIterations_ << " iterations\n";
+    }
+  }
+
+  /// \brief Multigrid preconditioner of the linear implicit methods with the
+  /// implicit time-step \p implicitDt (see
+  /// implicit::Settings::linearPreconditioner)
+  ///
+  /// It is rebuilt when the time-step or the cells change.
+  multigrid::Multigrid& linear_multigrid(const Num implicitDt) {
+    ASSERT(nvars == 1, "the multigrid preconditioner requires a scalar "
+                       "diffusion physics!");
+    if (!multigrid_ || multigridDt_ != implicitDt
+        || multigridAdaptations_ != noAdaptations_) {
+      const multigrid::Operator op {
+        1., implicitDt, implicitSettings_.multigridDirichlet
+      };
+      const multigrid::Settings settings{properties_};
+      multigrid_ = std::make_shared<multigrid::Multigrid>
+                   (multigrid::make_multigrid(*this, op, settings));
+      multigridDt_ = implicitDt;
+      multigridAdaptations_ = noAdaptations_;
+    }
+    return *multigrid_;
+  }
+
+  /// \brief Evaluates the increments \p dq of the part \p Part of the
+  /// physics over the time-step \p timeStep of the state \p q at the cells
+  /// \p ids (see increment)
+  template<class Part>
+  void increments(const std::vector<CellIdx>& ids, const NumV& q,
+                  const Num timeStep, NumV& dq, Part) noexcept {
+    scatter(ids, q);
+    apply_bcs(lhs);
+    for (Ind i = 0, e = ids.size(); i != e; ++i) {
+      dq.segment(i * nvars, nvars)
+        = increment<lhs_tag>(ids[i], timeStep, Part());
+    }
+  }
+
+  /// \brief Applies the block-Jacobi \p preconditioner (see
+  /// block_jacobi_preconditioner) to \p v
+  void apply_block_jacobi(const NumM<nvars>& preconditioner, const NumV& v,
+                          NumV& result) const noexcept {
+    for (Ind i = 0, e = v.size() / nvars; i != e; ++i) {
+      result.segment(i * nvars, nvars)
+        = preconditioner.block(i * nvars, 0, nvars, nvars)
+          * v.segment(i * nvars, nvars);
+    }
+  }
+
+  /// \brief Copies the lhs of the cells \p ids into the vector \p q
+  void gather(const std::vector<CellIdx>& ids, NumV& q) const noexcept {
+    for (Ind i = 0, e = ids.size(); i != e; ++i) {
+      q.segment(i * nvars, nvars) = Q<lhs_tag>(ids[i]);
+    }
+  }
+
+  /// \brief Copies the vector \p q into the lhs of the cells \p ids
+  void scatter(const std::vector<CellIdx>& ids, const NumV& q) noexcept {
+    for (Ind i = 0, e = ids.size(); i != e; ++i) {
+      Q(lhs, ids[i]) = q.segment(i * nvars, nvars).transpose();
+    }
+  }
+
+  /// \brief Evaluates the residual \p r = q - b - beta dt L_Part(q) of an
+  /// implicit step at the cells \p ids
+  template<class Part>
+  void implicit_residual(const std::vector<CellIdx>& ids, const NumV& q,
+                         const NumV& b, const Num beta, NumV& r,
+                         Part) noexcept {
+    increments(ids, q, dt(), r, Part());
+    r = q - b - beta * r;
+  }
+
+  /// \brief Inverses of the diagonal blocks of the Jacobian of the implicit
+  /// residual (stacked row-wise), evaluated at the current lhs
+  ///
+  /// The derivatives of the cell fluxes w.r.t. the cell's own variables are
+  /// approximated by one-sided finite differences (the ghost cells are kept
+  /// frozen).
+  template<class Part>
+  NumM<nvars> block_jacobi_preconditioner(const std::vector<CellIdx>& ids,
+                                          const Num beta, Part) noexcept {
+    NumM<nvars> result(ids.size() * nvars, Ind{nvars});
+    const Num sqrtEps = std::sqrt(std::numeric_limits<Num>::epsilon());
+    apply_bcs(lhs);
+    for (Ind i = 0, e = ids.size(); i != e; ++i) {
+      const auto cIdx = ids[i];
+      const NumA<nvars> dq = increment<lhs_tag>(cIdx, dt(), Part());
+      NumAM<nvars, nvars> block = NumAM<nvars, nvars>::Identity();
+      for (auto v : variables()) {
+        const Num q = Q(lhs, cIdx, v);
+        const Num h = sqrtEps * std::max(std::abs(q), Num{1});
+        Q(lhs, cIdx, v) = q + h;
+        block.col(v)
+          -= beta * (increment<lhs_tag>(cIdx, dt(), Part()) - dq) / h;
+        Q(lhs, cIdx, v) = q;
+      }
+      result.block(i * nvars, 0, nvars, nvars) = block.inverse();
+    }
+    return result;
+  }
+
+  /// \brief Preconditioner of the linear systems of newton_krylov, computed
+  /// at the current lhs (see implicit::Settings::preconditioner)
+  ///
+  /// If the (incomplete) LU factorization of the sparse Jacobian fails, e.g.
+  /// because it is singular, the block-Jacobi preconditioner is used instead.
+  template<class Part>
+  std::function<void(const NumV&, NumV&)>
+  newton_krylov_preconditioner(const std::vector<CellIdx>& ids,
+                               const Num beta, Part) noexcept {
+    const auto& type = implicitSettings_.preconditioner;
+    if (type != "blockJacobi") {
+      const implicit::SparseMatrix J = residual_jacobian(ids, beta, Part());
+      if (type == "ilu") {
+        const auto ilu = std::make_shared<Eigen::IncompleteLUT<Num>>(J);
+        if (ilu->info() == Eigen::Success) {
+          return [ilu](const NumV& v, NumV& result) { result = ilu->solve(v); };
+        }
+      } else {
+        ASSERT(type == "lu", "unknown preconditioner: " + type);
+        const auto lu
+          = std::make_shared<Eigen::SparseLU<implicit::SparseMatrix>>(J);
+        if (lu->info() == Eigen::Success) {
+          return [lu](const NumV& v, NumV& result) { result = lu->solve(v); };
+        }
+      }
+      std::cerr << "implicit solver | " << type << " factorization failed"
+                << " | using the blockJacobi preconditioner\n";
+    }
+    const auto blocks = block_jacobi_preconditioner(ids, beta, Part());
+    return [this, blocks](const NumV& v, NumV& result) {
+      apply_block_jacobi(blocks, v, result);
+    };
+  }
+
+  /// \brief Sparse Jacobian of the implicit residual (see implicit_residual)
+  /// at the cells \p ids, evaluated at the current lhs
+  template<class Part>
+  implicit::SparseMatrix residual_jacobian(const std::vector<CellIdx>& ids,
+                                           const Num beta, Part) noexcept {
+    const Ind n = ids.size() * nvars;
+    implicit::SparseMatrix identity(n, n);
+    identity.setIdentity();
+    implicit::SparseMatrix result
+      = identity - beta * jacobian(ids, dt(), Part());
+    return result;
+  }
+
+  /// \brief Sparse Jacobian of the increments of the part \p Part of the
+  /// physics over the time-step \p timeStep (see increments) w.r.t. the lhs
+  /// of the cells \p ids, evaluated at the current lhs
+  ///
+  /// The rows of a cell have nvars x nvars nonzero blocks at the cells of its
+  /// stencil (see jacobian_stencils). The cells whose stencils are disjoint
+  /// get the same colour and are perturbed together: the columns are
+  /// approximated by one-sided finite differences at the cost of
+  /// #of colours x nvars evaluations of the increments.
+  template<class Part>
+  implicit::SparseMatrix jacobian(const std::vector<CellIdx>& ids,
+                                  const Num timeStep, Part) noexcept {
+    const Ind noCells = ids.size();
+    const Ind n = noCells * nvars;
+    const auto columns
+      = jacobian_stencils(ids, implicitSettings_.jacobianStencilRadius);
+    std::vector<std::vector<Ind>> rows(noCells);
+    Ind noBlocks = 0;
+    for (Ind i = 0; i != noCells; ++i) {
+      for (auto j : columns[i]) { rows[j].push_back(i); }
+      noBlocks += columns[i].size();
+    }
+    std::vector<std::vector<Ind>> colorCells;
+    const auto colors = implicit::greedy_coloring(rows, columns);
+    for (Ind j = 0; j != noCells; ++j) {
+      if (colors[j] >= static_cast<Ind>(colorCells.size())) {
+        colorCells.resize(colors[j] + 1);
+      }
+      colorCells[colors[j]].push_back(j);
+    }
+
+    const Num sqrtEps = std::sqrt(std::numeric_limits<Num>::epsilon());
+    NumV q(n), qPerturbed(n), dq0(n), dq(n), h(noCells);
+    gather(ids, q);
+    increments(ids, q, timeStep, dq0, Part());
+    std::vector<Eigen::Triplet<Num>> entries;
+    entries.reserve(noBlocks * nvars * nvars);
+    for (const auto& colorCell : colorCells) {
+      for (auto v : variables()) {
+        qPerturbed = q;
+        for (auto j : colorCell) {
+          h(j) = sqrtEps * std::max(std::abs(q(j * nvars + v)), Num{1});
+          qPerturbed(j * nvars + v) += h(j);
+        }
+        increments(ids, qPerturbed, timeStep, dq, Part());
+        for (auto j : colorCell) {
+          for (auto i : rows[j]) {
+            for (auto w : variables()) {
+              const Ind k = i * nvars + w;
+              entries.emplace_back(k, j * nvars + v, (dq(k) - dq0(k)) / h(j));
+            }
+          }
+        }
+      }
+    }
+    scatter(ids, q);
+    apply_bcs(lhs);
+
+    implicit::SparseMatrix result(n, n);
+    result.setFromTriplets(entries.begin(), entries.end());
+    return result;
+  }
+
+  /// \brief Indices in \p ids of the cells within \p radius neighbor layers
+  /// of each of the cells \p ids (including the cell itself)
+  ///
+  /// Ghost cells count as a layer, and those at level interfaces bring their
+  /// source cells into it.
+  std::vector<std::vector<Ind>> jacobian_stencils
+  (const std::vector<CellIdx>& ids, const SInd radius) const noexcept {
+    const Ind noCells = ids.size();
+    std::vector<Ind> localIdx(cells().size(), invalid<Ind>());
+    for (Ind i = 0; i != noCells; ++i) { localIdx[ids[i]()] = i; }
+
+    std::vector<std::vector<Ind>> stencils(noCells);
+    std::vector<Ind> visitedBy(cells().size(), invalid<Ind>());
+    std::vector<CellIdx> layer, nextLayer;
+    for (Ind i = 0; i != noCells; ++i) {
+      auto visit = [&](const CellIdx cIdx) {
+        if (visitedBy[cIdx()] == i) { return; }
+        visitedBy[cIdx()] = i;
+        nextLayer.push_back(cIdx);
+        if (is_valid(localIdx[cIdx()])) {
+          stencils[i].push_back(localIdx[cIdx()]);
+        }
+      };
+      nextLayer.clear();
+      visit(ids[i]);
+      for (SInd l = 0; l != radius; ++l) {
+        std::swap(layer, nextLayer);
+        nextLayer.clear();
+        for (auto cIdx : layer) {
+          for (auto nghbrIdx : neighbors(cIdx)) {
+            visit(nghbrIdx);
+            if (is_ghost_cell(nghbrIdx)
+                && cells().bc_idx(nghbrIdx) == level_interface_bc_idx()) {
+              for (auto sIdx : level_interface(nghbrIdx).sources) {
+                visit(sIdx);
+              }
+            }
+          }
+        }
+      }
+    }
+    return stencils;
+  }
+
+  /// \brief Performs a pseudo-time step for all cells in range \p cells (see
+  /// time_integration::pseudo_time_stepping)
+  ///
+  /// The numerical fluxes are computed with the solver time-step dt, such
+  /// that the flux across each face (e.g. its dissipation) is the same for
+  /// the cells at both sides of the face. Only the update of each cell is
+  /// scaled by its own time-step.
+  template<class CellIdxRange>
+  inline void evolve(CellIdxRange&& cells,
+                     time_integration::pseudo_time_stepping) noexcept {
+    Num residual = 0.;
+    Ind noCells = 0;
+    prepare_num_fluxes(lhs);
     for (auto&& cIdx : cells) {
-      Q(lhs, cIdx) = 0.5 * (Q(lhs, cIdx) + Q<rhs_tag>(cIdx)
-                           + num_flux<rhs_tag>(cIdx).transpose());
+      const Num cellDt = physics()->template compute_dt<lhs_tag>(cIdx);
+      const NumA<nvars> dq = cellDt / dt() * num_flux<lhs_tag>(cIdx, dt())
+                             + source_term(lhs, cIdx);
+      Q(rhs, cIdx) = Q(lhs, cIdx) + dq.transpose();
+      residual += dq.squaredNorm() / std::pow(cellDt, 2);
+      ++noCells;
+    }
+    release_num_fluxes(lhs);
+    for (auto&& cIdx : cells) {
+      Q(lhs, cIdx) = Q(rhs, cIdx);
+    }
+    residualNorm_ = noCells > 0 ? std::sqrt(residual / noCells) : 0.;
+  }
+
+  /// \brief Cells and level interfaces grouped by refinement level
+  struct Levels {
+    std::vector<std::vector<CellIdx>> cells;
+    std::vector<std::vector<const LevelInterface*>> interfaces;
+    SInd coarsest;
+  };
+
+  /// \brief Performs a step of level-based local time stepping for all cells
+  /// in range \p cells (see time_integration::local_time_stepping)
+  template<class CellIdxRange>
+  inline void evolve(CellIdxRange&& cells,
+                     time_integration::local_time_stepping) noexcept {
+    Levels levels;
+    levels.coarsest = std::numeric_limits<SInd>::max();
+    for (auto&& cIdx : cells) {
+      const SInd l = cell_level(cIdx);
+      if (l >= static_cast<SInd>(levels.cells.size())) {
+        levels.cells.resize(l + 1);
+        levels.interfaces.resize(l + 1);
+      }
+      levels.cells[l].push_back(cIdx);
+      levels.coarsest = std::min(levels.coarsest, l);
+    }
+    if (levels.cells.empty()) { return; }
+    for (const auto& li : levelInterfaces_) {
+      levels.interfaces[cell_level(li.bndryIdx)].push_back(&li);
+    }
+    advance_level(levels, levels.coarsest, dt());
+  }
+
+  /// \brief Advances the cells at level \p l (and recursively those at finer
+  /// levels) by the time-step \p levelDt
+  ///
+  /// The ghost cells must be up to date. The fluxes across the coarse side of
+  /// level interfaces are replaced by the fluxes across the fine side, which
+  /// are accumulated in the rhs of the coarse cells during the fine substeps.
+  /// Meanwhile the coarse cells keep their values at the beginning of the step.
+  void advance_level(const Levels& levels, const SInd l,
+                     const Num levelDt) noexcept {
+    // ratio between the areas of a fine and a coarse face
+    const Num fineFaceRatio = std::ldexp(1., 1 - nd);
+    for (auto cIdx : levels.cells[l]) {
+      Q(rhs, cIdx) = Q(lhs, cIdx) + num_flux<lhs_tag>(cIdx, levelDt).transpose()
+                     + source_term(lhs, cIdx).transpose();
+    }
+    for (auto li : levels.interfaces[l]) {
+      const auto flux = face_flux<lhs_tag>(li->bndryIdx, li->ghostPos, levelDt);
+      const Num sign = face_sign(li->ghostPos);
+      if (li->coarseSide) {
+        Q(rhs, li->bndryIdx)
+          -= sign * levelDt / cells().length(li->bndryIdx) * flux.transpose();
+      } else {  // the coarse cell is at the opposite side of the face
+        const auto coarseIdx = li->sources.front();
+        Q(rhs, coarseIdx) -= sign * fineFaceRatio * levelDt
+                             / cells().length(coarseIdx) * flux.transpose();
+      }
+    }
+    if (l + 1 < static_cast<SInd>(levels.cells.size())) {
+      for (SInd substep = 0; substep != 2; ++substep) {
+        if (substep != 0) { apply_bcs(lhs); }
+        advance_level(levels, l + 1, 0.5 * levelDt);
+      }
+    }
+    for (auto cIdx : levels.cells[l]) {
+      Q(lhs, cIdx) = Q(rhs, cIdx);
     }
   }
 
   /// \brief Integrates the solution in time
+  ///
+  /// The explicit methods compute the cell time-steps of the updated
+  /// solution in their last update pass (see min_dt).
   inline void evolve() noexcept {
+    invalidate_dt();
     evolve(internal_cells(), TimeIntegration());
   }
 
+  /// \brief Are the lhs variables of the cell \p cIdx valid according to
+  /// the physics (physics without valid_variables accept any variables)?
+  template<class P>
+  inline auto valid_variables_(const CellIdx cIdx, const P* p) const noexcept
+  -> decltype(p->template valid_variables<lhs_tag>(cIdx))
+  { return p->template valid_variables<lhs_tag>(cIdx); }
+  inline bool valid_variables_(const CellIdx, ...) const noexcept
+  { return true; }
+
   /// \brief Advances the solution to the next time-step
   inline void advance() noexcept {
     time_ += dt();
@@ -505,10 +1755,12 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
   }
 
   /// \brief Computes the time-step
-  ///
-  /// Computes the time-step dt as the minimum cell time-step over all internal
-  /// cells
-  inline Num compute_dt() const noexcept {
+  inline Num compute_dt() const noexcept
+  { return compute_dt(TimeIntegration()); }
+
+  /// \brief Computes the time-step dt as the minimum cell time-step over all
+  /// internal cells
+  template<class TI> inline Num compute_dt(TI) const noexcept {
     auto dt = std::numeric_limits<Num>::max();
     for (auto&& cIdx : internal_cells())  {
       dt = std::min(dt, physics()->template compute_dt<lhs_tag>(cIdx));
@@ -516,6 +1768,22 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
     return dt;
   }
 
+  /// \brief Computes the time-step dt of the coarsest level: the cells at
+  /// level l advance with dt / 2^(l - l0) which must not exceed their cell
+  /// time-step
+  inline Num compute_dt(time_integration::local_time_stepping) const noexcept {
+    auto coarsest = std::numeric_limits<SInd>::max();
+    for (auto&& cIdx : internal_cells()) {
+      coarsest = std::min(coarsest, cell_level(cIdx));
+    }
+    auto dt = std::numeric_limits<Num>::max();
+    for (auto&& cIdx : internal_cells()) {
+      const Num cellDt = physics()->template compute_dt<lhs_tag>(cIdx);
+      dt = std::min(dt, std::ldexp(cellDt, cell_level(cIdx) - coarsest));
+    }
+    return dt;
+  }
+
   /// \brief Use the time-step \p dtForce for the current solution step
   ///
   /// Note: the current solution step is the result of step()
@@ -535,61 +1803,91 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
 
   /// \brief Sets the solver time-step
   ///
-  /// Note: when the solution is close to final_time
-  /// the time-step dt is adjusted to arrive
-  /// exactly at final_time
+  /// Note: the time-step dt is clipped to arrive
+  /// exactly at final_time (except in pseudo-time)
   inline void set_dt() noexcept {
-    if (time_ + dt() < tEnd_) {
-      if (step() == forced_dt_step()) {
-        dt_ = forced_dt_;
-      } else {
-        dt_ = compute_dt();
-      }
+    if (step() == forced_dt_step()) {
+      dt_ = forced_dt_;
     } else {
-      dt_ = tEnd_ - time_;
+      dt_ = min_dt();
+    }
+    if (!std::is_same<TimeIntegration,
+                      time_integration::pseudo_time_stepping>::value) {
+      dt_ = std::min(dt_, tEnd_ - time_);
     }
   }
 
-  /// \brief Applies all boundary conditions
-  // better: sort ghost cells by bcIdx
-  // then get a [fromGhostCell,toGhostCell) range
-  // apply bcIdx kernel to range
+  /// \brief Applies all boundary conditions and updates the ghost cells at
+  /// level interfaces
+  ///
+  /// The ghost cells are sorted by bcIdx: each boundary condition is applied
+  /// to its [fromGhostCell,toGhostCell) range.
   //
   // unsolved: kernel needs to access the boudnary cell
   // this access is random access
   // it would be nice to eliminate this random access
   template<class _> void apply_bcs(_) noexcept {
     namespace csa = container::sequential::algorithm;
-    auto firstBndryCell
-      = csa::find_if(cells(), [&](const CellIdx i) {
-          return cells().bc_idx(i) != invalid<SInd>();
-    });
-    // this should check the #of bndry conditions for the solver,
-    // if it is indeed 0 nothing should happen, but if its not, ASSERT is fine
-    ASSERT(firstBndryCell != cells().last(), "no boundary cells found!");
-    SInd bcIdx = cells().bc_idx(firstBndryCell);  // first bcIdx
-    auto eql_bcIdx = [&](const CellIdx i) {
-      return cells().bc_idx(i) == bcIdx;
-    };
-    auto firstGhostCell = csa::find_if(cells(), eql_bcIdx);
-    auto lastGhostCell = firstGhostCell;
-    // DBGV((bcIdx)(firstGhostCell));
-    for (auto& boundaryCondition : boundary_conditions()) {
-      ++bcIdx;
-      firstGhostCell = lastGhostCell;
-      lastGhostCell = csa::find_if(firstGhostCell, cells().last(), eql_bcIdx);
-      // DBGV((physics()->physics_name())(bcIdx)
-      // (firstGhostCell)(lastGhostCell));
-      auto GCRange = Range<CellIdx>{firstGhostCell, lastGhostCell};
-      boundaryCondition.apply(_(), GCRange);
+    // e.g. fully periodic domains have neither boundaries nor ghost cells
+    if (!boundary_conditions().empty()) {
+      auto firstGhostCell
+        = csa::find_if(cells(), [&](const CellIdx i) {
+            return cells().bc_idx(i) != invalid<SInd>();
+      });
+      // there are boundary conditions: if no ghost cells have been created the
+      // boundaries don't cut the domain and it is an error
+      ASSERT(firstGhostCell != cells().last(), "no boundary cells found!");
+      for (SInd bcIdx = 0, e = boundary_conditions().size(); bcIdx != e;
+           ++bcIdx) {
+        const auto lastGhostCell
+          = csa::find_if(firstGhostCell, cells().last(), [&](const CellIdx i) {
+              return cells().bc_idx(i) != bcIdx;
+          });
+        // DBGV((physics()->physics_name())(bcIdx)
+        // (firstGhostCell)(lastGhostCell));
+        auto GCRange = Range<CellIdx>{firstGhostCell, lastGhostCell};
+        boundary_conditions()[bcIdx].apply(_(), GCRange);
+        firstGhostCell = lastGhostCell;
+      }
+    }
+    apply_level_interfaces(_());
+  }
+
+  /// \brief Sets the ghost cells at level interfaces to the average of their
+  /// source cells
+  template<class _> void apply_level_interfaces(_) noexcept {
+    for (const auto& li : levelInterfaces_) {
+      NumA<nvars> average = NumA<nvars>::Zero();
+      for (auto sIdx : li.sources) {
+        average += Q(_(), sIdx).transpose();
+      }
+      Q(_(), li.ghostIdx)
+        = (average / static_cast<Num>(li.sources.size())).transpose();
     }
   }
 
  public:
   /// \brief Distance between cell centers of \p a and \p b
-  auto cell_dx(CellIdx a, CellIdx b)
-  RETURNS(geometry::algorithm::distance(cells().x_center.row(a).transpose(),
-                                        cells().x_center.row(b).transpose()));
+  ///
+  /// Note: across periodic boundaries this is the distance to the closest
+  /// periodic image of \p b.
+  Num cell_dx(CellIdx a, CellIdx b) const noexcept {
+    return grid().displacement(cells().x_center.row(a).transpose(),
+                               cells().x_center.row(b).transpose()).norm();
+  }
+
+  /// \brief Distance between the centers of the neighbors \p lIdx and \p rIdx
+  /// along their face normal (1.5 times the fine cell length across the fine
+  /// side of level interfaces, see face_num_flux)
+  inline Num center_distance(const CellIdx lIdx,
+                             const CellIdx rIdx) const noexcept {
+    const auto ghostIdx = is_level_interface_ghost(rIdx) ? rIdx : lIdx;
+    if (is_level_interface_ghost(ghostIdx)
+        && !level_interface(ghostIdx).coarseSide) {
+      return 1.5 * cells().length(ghostIdx);
+    }
+    return cells().length(rIdx);
+  }
 
   /// \brief Computes the slope of the variable \p v at the center of cell \p
   /// cIdx in direction \p dir
@@ -616,12 +1914,77 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
              "ghost cell with no neighbors?");
       ASSERT(is_ghost_cell(cIdx), "cIdx is not a ghostCell ?!?!");
 
-      const auto bndryIdx = boundary_info(cIdx).bndryIdx;
       const auto bcIdx = cells().bc_idx(cIdx);
+      if (bcIdx == level_interface_bc_idx()) {
+        return level_interface_slope<_>(cIdx, v, dir);
+      }
+      const auto bndryIdx = boundary_info(cIdx).bndryIdx;
       return boundary_condition(bcIdx).slope(_(), bndryIdx, v, dir);
     }
   }
 
+  /// \brief Slope of the variable \p v in direction \p dir at the level
+  /// interface ghost cell \p ghostIdx: average of the central slopes of its
+  /// source cells (zero if a source cell lacks a neighbor in direction \p dir)
+  template<class _>
+  Num level_interface_slope(const CellIdx ghostIdx, const SInd v,
+                            const SInd dir) const noexcept {
+    using namespace container::hierarchical;
+    const auto& sources = level_interface(ghostIdx).sources;
+    Num result = 0.;
+    for (auto sIdx : sources) {
+      const auto nghbrNegIdx
+        = cells().neighbors(sIdx, neighbor_position(dir, neg_dir));
+      const auto nghbrPosIdx
+        = cells().neighbors(sIdx, neighbor_position(dir, pos_dir));
+      if (!is_valid(nghbrNegIdx) || !is_valid(nghbrPosIdx)) { continue; }
+      result += (Q(_(), nghbrPosIdx, v) - Q(_(), nghbrNegIdx, v))
+                / (2. * cells().length(sIdx));
+    }
+    return result / sources.size();
+  }
+
+  /// \brief Interpolates the variables \p vars at the points \p xs
+  ///
+  /// The points are first located in the grid and then the variables are
+  /// reconstructed linearly from the values and the slopes of the cells
+  /// containing them. The result is a (#of points, #of variables) matrix,
+  /// in which points lying outside of the solver domain are NaN.
+  ///
+  /// \warning The slopes of cells at the boundaries use the ghost cells,
+  /// which must be up to date (i.e. after apply_bcs(lhs)).
+  template<class Points>
+  EigenDynColMajor<Num> interpolate(const Points& xs,
+                                    const std::vector<SInd>& vars) const {
+    std::vector<CellIdx> cellIds;
+    for (const auto& x : xs) {
+      const auto nIdx = grid().find_leaf(x);
+      cellIds.push_back(is_valid(nIdx) ? grid().cell_idx(nIdx, solver_idx())
+                                       : invalid<CellIdx>());
+    }
+
+    EigenDynColMajor<Num> values(cellIds.size(), vars.size());
+    Ind p = 0;
+    for (const auto& x : xs) {
+      const auto cIdx = cellIds[p];
+      if (!is_valid(cIdx)) {
+        values.row(p++).fill(std::numeric_limits<Num>::quiet_NaN());
+        continue;
+      }
+      const NumA<nd> dx
+        = grid().displacement(cells().x_center.row(cIdx).transpose(), x);
+      for (SInd i = 0, e = vars.size(); i != e; ++i) {
+        Num value = Q(lhs, cIdx, vars[i]);
+        for (auto d : grid().dimensions()) {
+          value += slope<lhs_tag>(cIdx, vars[i], d) * dx(d);
+        }
+        values(p, i) = value;
+      }
+      ++p;
+    }
+    return values;
+  }
+
   /// \brief Returns the position of \p nghbrIdx w.r.t. \p cIdx and returns
   /// an invalid position if they are not neighbors.
   SInd which_neighbor(const CellIdx cIdx,
@@ -662,15 +2025,16 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
            + " and rIdx = " + to_string(rIdx) + " are not neighbors!");
 
     const auto nghbrDir = neighbor_direction(rIdxPosWrtLIdx);
-    ASSERT(cells().x_center(rIdx, nghbrDir) > cells().x_center(lIdx, nghbrDir),
-           "cells are in the wrong order!");
+    ASSERT(grid().displacement(cells().x_center.row(lIdx).transpose(),
+                               cells().x_center.row(rIdx).transpose())
+           (nghbrDir) > 0., "cells are in the wrong order!");
 
     if (nghbrDir == slopeDir) {
       // if they are neighbors in the same direction as slopeDir then use a
       // central difference:
-      auto dx = cells().length(rIdx);
-      ASSERT(math::approx(dx, cells().length(lIdx)), "different cell lengths!");
-      return (Q(_(), rIdx, v) - Q(_(), lIdx, v)) / dx;
+      ASSERT(math::approx(cells().length(rIdx), cells().length(lIdx)),
+             "different cell lengths!");
+      return (Q(_(), rIdx, v) - Q(_(), lIdx, v)) / center_distance(lIdx, rIdx);
     } else {
       // otherwise: average the slopes
       return 0.5 * (slope<_>(rIdx, v, slopeDir) + slope<_>(lIdx, v, slopeDir));
@@ -757,6 +2121,10 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
     return noNghbrs;
   }
 
+  /// \brief Refinement level of the internal cell \p cIdx
+  SInd cell_level(const CellIdx cIdx) const noexcept
+  { return grid().level(node_idx(cIdx)); }
+
   /// \brief Lazy range of all cell vertices
   auto cell_vertices(const CellIdx cIdx) const noexcept
   -> typename Grid::CellVertices {
@@ -801,9 +2169,8 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
     ASSERT(is_valid(pos_wrt_boundary), "cells are not neighbors!");
 
     auto length = cells().length(bndryCellIdx);
-    auto x_gc = cells().x_center.row(bndryCellIdx).transpose() + length
-                * grid().nghbr_rel_pos(pos_wrt_boundary).template cast<Num>();
-    return x_gc;
+    return cells().x_center.row(bndryCellIdx).transpose() + length
+           * grid().nghbr_rel_pos(pos_wrt_boundary).template cast<Num>();
   }
 
   /// \brief Sorts ghost cells by boundary condition id and returns the id of
@@ -871,6 +2238,12 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
     step_ = 0;
     forced_dt_ = 0;
     forced_dt_step_ = invalid<Ind>();
+    previousQ_.resize(0);
+    previousDt_ = 0;
+    residualNorm_ = std::numeric_limits<Num>::quiet_NaN();
+    linearIterations_ = 0;
+    multigrid_.reset();
+    invalidate_dt();
   }
 
   void create_local_cells() noexcept {
@@ -878,16 +2251,37 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
     //    set the nodeIdx in the local cells
     //    set the cIdx in the grid cells
     //    set the cell coordinates
+    // The cells are ordered by level and then lexicographically (x fastest),
+    // such that uniform regions become uniform spans (see
+    // find_uniform_spans).
     {
       auto initialDomain
           = io::read<InitialDomain>(properties_, "initialDomain");
+      using Key = std::array<Ind, nd + 1>;
+      std::vector<std::pair<Key, NodeIdx>> leafs;
+      const NumA<nd> xMin = grid().root_cell().x_min();
       for (auto nIdx : grid().leaf_nodes()) {
         auto xc = grid().cell_coordinates(nIdx);
         if (!initialDomain(xc)) { continue; }
+        const auto length = grid().cell_length(nIdx);
+        Key key;
+        key[0] = grid().level(nIdx);
+        for (auto d : grid().dimensions()) {
+          key[nd - d] = std::floor((xc(d) - xMin(d)) / length);
+        }
+        leafs.emplace_back(key, nIdx);
+      }
+      std::sort(std::begin(leafs), std::end(leafs),
+                [](const std::pair<Key, NodeIdx>& a,
+                   const std::pair<Key, NodeIdx>& b) {
+                  return a.first < b.first;
+      });
+      for (const auto& leaf : leafs) {
+        const auto nIdx = leaf.second;
         auto cIdx = cells().push_cell();
         cells().node_idx(cIdx) = nIdx;
         grid().cell_idx(nIdx, solver_idx()) = cIdx;
-        cells().x_center.row(cIdx) = xc;
+        cells().x_center.row(cIdx) = grid().cell_coordinates(nIdx);
         cells().length(cIdx) = grid().cell_length(nIdx);
       }
     }
@@ -910,10 +2304,20 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
     firstGC_ = CellIdx{cells().size()};
 
     create_ghost_cells();
+    create_level_interface_ghosts();
 
     /// sort ghost cells by boundary id
     sort_gc();
 
+    /// link level interfaces to their (sorted) ghost cells
+    for (auto& li : levelInterfaces_) {
+      li.ghostIdx = cells().neighbors(li.bndryIdx, li.ghostPos);
+    }
+    std::sort(std::begin(levelInterfaces_), std::end(levelInterfaces_),
+              [](const LevelInterface& a, const LevelInterface& b) {
+                return a.ghostIdx < b.ghostIdx;
+    });
+
     /// set distances to nghbrs
     {
       for (auto cIdx : cell_ids()) {
@@ -927,53 +2331,314 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
       }
     }
     ASSERT(check_all_nghbrs(), "internal cell nghbrIds don't agree with grid!");
+
+    find_uniform_spans();
+    if (std::is_same<TimeIntegration,
+                     time_integration::tiled_runge_kutta_2>::value) {
+      build_tiles();
+    }
+  }
+
+  /// \brief Splits the internal cells into uniform spans and irregular cells
+  ///
+  /// A cell is regular if its neighbors along each direction d are the cells
+  /// at the offsets -/+ stride(d), with stride(0) = 1. Consecutive regular
+  /// cells with the same strides form a span, whose fluxes are computed
+  /// without reading the neighbor table (see for_each_cell). The cells at
+  /// the boundaries, the level interfaces and the periodic faces are
+  /// irregular.
+  void find_uniform_spans() noexcept {
+    uniformSpans_.clear();
+    irregularCells_.clear();
+    auto regular = [&](const CellIdx cIdx, std::array<Ind, nd>& strides) {
+      for (auto d : grid().dimensions()) {
+        const auto nghbrM = cells().neighbors(cIdx, 2 * d);
+        const auto nghbrP = cells().neighbors(cIdx, 2 * d + 1);
+        if (!is_valid(nghbrM) || !is_valid(nghbrP)) { return false; }
+        strides[d] = nghbrP() - cIdx();
+        if (strides[d] <= 0 || cIdx() - nghbrM() != strides[d]) {
+          return false;
+        }
+      }
+      return strides[0] == 1;
+    };
+    for (auto cIdx : internal_cells()) {
+      std::array<Ind, nd> strides;
+      if (!regular(cIdx, strides)) {
+        irregularCells_.push_back(cIdx);
+      } else if (!uniformSpans_.empty() && uniformSpans_.back().last == cIdx
+                 && uniformSpans_.back().strides == strides) {
+        uniformSpans_.back().last = CellIdx{cIdx() + 1};
+      } else {
+        uniformSpans_.push_back({cIdx, CellIdx{cIdx() + 1}, strides});
+      }
+    }
+  }
+
+  /// \brief Groups the internal cells into the tiles of
+  /// time_integration::tiled_runge_kutta_2
+  ///
+  /// The tiles are cubes of 2^e cells of the finest level per direction,
+  /// with 2^(e nd) <= tileSize, ordered lexicographically. A cell belongs to
+  /// the tile containing its center. Let r be the stencil radius:
+  /// - the halo of a tile are the internal cells within r neighbor layers of
+  ///   its cells,
+  /// - the halo's first stage reads the lhs within 2r layers of the tile, so
+  ///   the cells there that belong to earlier tiles are deferred, and
+  /// - the boundary conditions read the rhs of the cells within max(r, 2)
+  ///   layers of the ghost cells (boundary cells and their tangential slopes)
+  ///   and of the sources of the level interfaces.
+  void build_tiles() {
+    tiles_.clear();
+    deferredCells_.clear();
+    boundarySources_.clear();
+    const Ind tileSize = io::read_or<Ind>(properties_, "tileSize", 4096);
+    const SInd radius = io::read_or<SInd>(properties_, "tileStencilRadius", 2);
+    ASSERT(tileSize > 0, "the tile size must be positive!");
+    ASSERT(radius > 0, "the stencil radius must be positive!");
+    if (no_internal_cells() == 0) { return; }
+
+    SInd exponent = 0;
+    while ((Ind{1} << (nd * (exponent + 1))) <= tileSize) { ++exponent; }
+    Num minLength = std::numeric_limits<Num>::max();
+    for (auto cIdx : internal_cells()) {
+      minLength = std::min(minLength, cells().length(cIdx));
+    }
+    const Num tileLength = std::ldexp(minLength, exponent);
+    const NumA<nd> xMin = grid().root_cell().x_min();
+    using Key = std::array<Ind, nd>;
+    std::vector<std::pair<Key, CellIdx>> keys;
+    for (auto cIdx : internal_cells()) {
+      Key key;
+      for (auto d : grid().dimensions()) {
+        key[nd - 1 - d]
+          = std::floor((cells().x_center(cIdx, d) - xMin(d)) / tileLength);
+      }
+      keys.emplace_back(key, cIdx);
+    }
+    std::sort(std::begin(keys), std::end(keys));
+
+    std::vector<Ind> tileOf(cells().size(), invalid<Ind>());
+    for (Ind i = 0, e = keys.size(); i != e; ++i) {
+      if (i == 0 || keys[i].first != keys[i - 1].first) {
+        tiles_.emplace_back();
+      }
+      tiles_.back().cells.push_back(keys[i].second);
+      tileOf[keys[i].second()] = tiles_.size() - 1;
+    }
+
+    // visits the internal cells within noLayers of the cells [first, last)
+    // with f(cIdx, layer)
+    std::vector<Ind> visitedBy(cells().size(), invalid<Ind>());
+    std::vector<CellIdx> layer, nextLayer;
+    Ind noVisits = 0;
+    auto visit_layers = [&](const auto first, const auto last,
+                            const SInd noLayers, auto&& f) {
+      ++noVisits;
+      nextLayer.clear();
+      for (auto it = first; it != last; ++it) {
+        visitedBy[(*it)()] = noVisits;
+        nextLayer.push_back(*it);
+      }
+      for (SInd l = 1; l <= noLayers; ++l) {
+        std::swap(layer, nextLayer);
+        nextLayer.clear();
+        for (auto cIdx : layer) {
+          for (auto nghbrIdx : neighbors(cIdx)) {
+            if (is_ghost_cell(nghbrIdx) || visitedBy[nghbrIdx()] == noVisits) {
+              continue;
+            }
+            visitedBy[nghbrIdx()] = noVisits;
+            nextLayer.push_back(nghbrIdx);
+            f(nghbrIdx, l);
+          }
+        }
+      }
+    };
+
+    std::vector<bool> deferred(cells().size(), false);
+    for (Ind t = 0, nt = tiles_.size(); t != nt; ++t) {
+      auto& tile = tiles_[t];
+      visit_layers(std::begin(tile.cells), std::end(tile.cells), 2 * radius,
+                   [&](const CellIdx cIdx, const SInd l) {
+        if (l <= radius) { tile.halo.push_back(cIdx); }
+        if (tileOf[cIdx()] < t) { deferred[cIdx()] = true; }
+      });
+    }
+    for (auto& tile : tiles_) {
+      tile.firstDeferred = deferredCells_.size();
+      tile.cells.erase(std::remove_if(std::begin(tile.cells),
+                                      std::end(tile.cells),
+                                      [&](const CellIdx cIdx) {
+        if (!deferred[cIdx()]) { return false; }
+        deferredCells_.push_back(cIdx);
+        return true;
+      }), std::end(tile.cells));
+      tile.lastDeferred = deferredCells_.size();
+    }
+    deferredQ_.resize(deferredCells_.size(), nvars);
+
+    std::vector<CellIdx> ghostCells;
+    for (auto gIdx : ghost_cells()) { ghostCells.push_back(gIdx); }
+    visit_layers(std::begin(ghostCells), std::end(ghostCells),
+                 std::max(radius, SInd{2}), [&](const CellIdx cIdx, SInd) {
+      boundarySources_.push_back(cIdx);
+    });
+    for (const auto& li : levelInterfaces_) {
+      for (auto sIdx : li.sources) { boundarySources_.push_back(sIdx); }
+    }
+    std::sort(std::begin(boundarySources_), std::end(boundarySources_));
+    boundarySources_.erase(std::unique(std::begin(boundarySources_),
+                                       std::end(boundarySources_)),
+                           std::end(boundarySources_));
   }
 
   /// Create Ghost Cells:
   ///
+  /// A ghost cell is created at each missing neighbor position of the cells
+  /// cut by the solver boundaries that lies outside of the domain. Each ghost
+  /// cell is assigned to the closest of the boundaries that cut its cell
+  /// (which lie within the narrow band, see Grid::signed_distance), and only
+  /// if none of them has the ghost cell outside, to the closest of all
+  /// boundaries. The boundaries are evaluated at all missing neighbors of a
+  /// cell in a single pass. Neighbors across periodic faces of the grid are
+  /// linked directly by create_local_cells and don't need ghost cells.
+  ///
   /// \warning this only works for cutoff right now
   void create_ghost_cells() noexcept {
-    memory::stack::arena<SInd, 6 + 2> stackMemory;  // 6nghbrs + 2 alignment
     auto noLeafCells = cells().size();
-    SInd ghostCellBoundaryIdx = 0;
-    for (auto boundary : boundary_conditions()) {
-      for (auto bndryNodeIdx : node_ids() | grid().cut_by_boundary(boundary)) {
-        const auto bndryCellIdx
-          = grid().cell_idx(bndryNodeIdx, solver_idx());
-        ASSERT(is_valid(bndryCellIdx), "invalid bndryCellIdx!");
-        ASSERT(node_idx(bndryCellIdx) == bndryNodeIdx,
-               "solver and grid are not synchronized");
-        ASSERT(is_valid(node_idx(bndryCellIdx)),
-               "the global id has to be valid!");
-
-        // find missing neighbor positions
-        auto missingNghbrPositions
-            = memory::stack::make<std::vector>(stackMemory);
-        for (const auto nghbrPos : grid().neighbor_positions()) {
-          if (cells().neighbors(bndryCellIdx, nghbrPos) == invalid<CellIdx>()) {
-            missingNghbrPositions.emplace_back(nghbrPos);
-          }
+    grid().update_distance_field();
+    const auto gridBoundaryIds = grid().boundary_ids(solver_idx());
+    ASSERT(gridBoundaryIds.size() == boundary_conditions().size(),
+           "solver and grid boundaries are not synchronized");
+
+    using ClosestBoundary = typename Grid::ClosestBoundary;
+    // closest boundary of the cutting boundaries, and of all boundaries:
+    using Closest = std::pair<ClosestBoundary, ClosestBoundary>;
+    std::vector<SInd> cuttingIds;  // grid ids of the cutting boundaries
+    std::vector<SInd> cuttingBcs;  // their positions in gridBoundaryIds
+    std::vector<SInd> missingNghbrPositions;
+    NumAV<nd> x_missingNghbrs;
+    std::vector<std::pair<SInd, Closest>> sampledNghbrs;
+    for (auto bndryNodeIdx : node_ids()) {
+      cuttingIds.clear();
+      cuttingBcs.clear();
+      for (SInd i = 0, e = gridBoundaryIds.size(); i != e; ++i) {
+        if (grid().is_cut_by_boundary(bndryNodeIdx, gridBoundaryIds[i])) {
+          cuttingIds.push_back(gridBoundaryIds[i]);
+          cuttingBcs.push_back(i);
+        }
+      }
+      if (cuttingIds.empty()) { continue; }
+      const auto bndryCellIdx
+        = grid().cell_idx(bndryNodeIdx, solver_idx());
+      ASSERT(is_valid(bndryCellIdx), "invalid bndryCellIdx!");
+      ASSERT(node_idx(bndryCellIdx) == bndryNodeIdx,
+             "solver and grid are not synchronized");
+      ASSERT(is_valid(node_idx(bndryCellIdx)),
+             "the global id has to be valid!");
+
+      // find missing neighbor positions: if the neighbor node exists in the
+      // grid (e.g. it belongs to another solver) its distance to the
+      // boundaries is already sampled, otherwise its centroid is computed
+      missingNghbrPositions.clear();
+      sampledNghbrs.clear();
+      x_missingNghbrs.clear();
+      for (const auto nghbrPos : grid().neighbor_positions()) {
+        if (is_valid(cells().neighbors(bndryCellIdx, nghbrPos))) { continue; }
+        const auto nghbrNodeIdx
+          = grid().find_samelvl_neighbor(bndryNodeIdx, nghbrPos);
+        if (is_valid(nghbrNodeIdx)) {
+          sampledNghbrs.emplace_back
+            (nghbrPos,
+             Closest{grid().closest_boundary(nghbrNodeIdx, cuttingIds),
+                     grid().closest_boundary(nghbrNodeIdx, gridBoundaryIds)});
+          continue;
         }
+        missingNghbrPositions.emplace_back(nghbrPos);
+        x_missingNghbrs.emplace_back
+          (cells().x_center.row(bndryCellIdx).transpose()
+           + grid().nghbr_rel_pos(nghbrPos).template cast<Num>()
+             * cells().length(bndryCellIdx));
+      }
 
-        auto neg_distance = [&](const SInd pos) {
-          return boundary.signed_distance
-          (grid().neighbor_coordinates(bndryNodeIdx, pos)) < 0.;
-        };
+      // evaluate all boundaries at the missing neighbors in a single pass
+      const auto closestCutting
+        = grid().closest_boundary(x_missingNghbrs, cuttingIds);
+      const auto closest
+        = grid().closest_boundary(x_missingNghbrs, gridBoundaryIds);
+      for (SInd i = 0, e = missingNghbrPositions.size(); i != e; ++i) {
+        sampledNghbrs.emplace_back(missingNghbrPositions[i],
+                                   Closest{closestCutting[i], closest[i]});
+      }
 
-        using boost::adaptors::filtered;
-        for (auto nghbrPos : missingNghbrPositions | filtered(neg_distance)) {
-          auto ghostCellIdx = create_ghost_cell(bndryCellIdx, nghbrPos);
-          cells().bc_idx(ghostCellIdx) = ghostCellBoundaryIdx;
-        }
+      for (const auto& nghbr : sampledNghbrs) {
+        const auto& cutting = nghbr.second.first;
+        const auto& all = nghbr.second.second;
+        if (all.distance >= 0.) { continue; }
+        auto ghostCellIdx = create_ghost_cell(bndryCellIdx, nghbr.first);
+        cells().bc_idx(ghostCellIdx) = cutting.distance < 0.
+            ? cuttingBcs[cutting.boundaryIdx] : all.boundaryIdx;
       }
-      ++ghostCellBoundaryIdx;
     }
 
     auto newTotalNoCells = cells().size();
     std::cerr << "fv container | #of leafs: " << noLeafCells
               << " | #of ghosts: " << newTotalNoCells - noLeafCells
               << " | #of cells: " << newTotalNoCells << "\n";
-    ASSERT(newTotalNoCells - noLeafCells > 0, "#of ghost cells is 0!");
+    ASSERT(boundary_conditions().empty() || newTotalNoCells - noLeafCells > 0,
+           "#of ghost cells is 0!");
+  }
+
+  /// Create Level Interface Ghost Cells:
+  ///
+  /// A same-level ghost cell is created at each missing neighbor position of
+  /// the internal cells whose neighbor is at a different refinement level
+  /// (the grid is assumed to be 2:1 balanced):
+  /// - coarse side: the neighbor node is refined and the ghost cell holds the
+  ///   average of its children,
+  /// - fine side: the neighbor node doesn't exist and the ghost cell holds the
+  ///   value of the coarse leaf neighboring the parent node.
+  ///
+  /// The ghost cells get the bcIdx level_interface_bc_idx(), i.e. they are
+  /// sorted after the boundary ghost cells, and are updated by apply_bcs.
+  /// The fluxes across the level interfaces are conservative (see
+  /// face_num_flux).
+  void create_level_interface_ghosts() noexcept {
+    levelInterfaces_.clear();
+    for (auto cIdx : internal_cells()) {
+      const auto nIdx = node_idx(cIdx);
+      for (const auto nghbrPos : grid().neighbor_positions()) {
+        if (is_valid(cells().neighbors(cIdx, nghbrPos))) { continue; }
+        LevelInterface li{invalid<CellIdx>(), cIdx, nghbrPos, false, {}};
+        const auto nghbrIdx = grid().find_samelvl_neighbor(nIdx, nghbrPos);
+        if (is_valid(nghbrIdx)) {
+          if (grid().is_leaf(nghbrIdx)) { continue; }  // not in this solver
+          li.coarseSide = true;
+          for (auto childIdx : grid().childs(nghbrIdx)) {
+            ASSERT(grid().is_leaf(childIdx), "the grid is not 2:1 balanced!");
+            if (grid().has_solver(childIdx, solver_idx())) {
+              li.sources.push_back(grid().cell_idx(childIdx, solver_idx()));
+            }
+          }
+        } else if (!grid().is_root(nIdx)) {
+          const auto coarseIdx
+            = grid().find_samelvl_neighbor(grid().parent(nIdx), nghbrPos);
+          if (is_valid(coarseIdx) && grid().is_leaf(coarseIdx)
+              && grid().has_solver(coarseIdx, solver_idx())) {
+            li.sources.push_back(grid().cell_idx(coarseIdx, solver_idx()));
+          }
+        }
+        if (li.sources.empty()) { continue; }
+        const auto ghostCellIdx = create_ghost_cell(cIdx, nghbrPos);
+        cells().bc_idx(ghostCellIdx) = level_interface_bc_idx();
+        levelInterfaces_.push_back(std::move(li));
+      }
+    }
+    if (!levelInterfaces_.empty()) {
+      std::cerr << "fv container | #of level interface ghosts: "
+                << levelInterfaces_.size() << "\n";
+    }
   }
 
   /// \brief Imposes the initial condition on the lhs
@@ -983,12 +2648,13 @@ struct Solver : PhysicsTT<Solver<PhysicsTT, TimeIntegration>> {
     for (auto cIdx : internal_cells()) {
       const auto length = grid().cell_length(node_idx(cIdx));
       const auto x_c = cells().x_center.row(cIdx).transpose();
-      const auto average
+      const NumA<nvars> average
         = quadrature::integrate<nd>(initialCondition, x_c, length)
           / geometry::cell::cartesian::volume<nd>(length);
 
       cells().lhs.row(cIdx) = average;
     }
+    invalidate_dt();
   }
   ///@}
 };
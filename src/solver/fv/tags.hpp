@@ -3,6 +3,11 @@
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief This file collects the finite volume solver tags
 ////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <cmath>
+#include <type_traits>
+#include "globals.hpp"
+////////////////////////////////////////////////////////////////////////////////
 namespace hom3 { namespace solver { namespace fv {
 
 /// \name Tags for rhs and lhs variables
@@ -17,6 +22,16 @@ namespace bc {
 
 }  // namespace bc
 
+/// \brief Tags for the parts of the numerical flux of a physics
+///
+/// Used by the IMEX time integration methods to integrate the convective
+/// and the diffusive parts of the physics separately.
+namespace flux_part {
+struct all {};         ///< Complete numerical flux
+struct convective {};  ///< Convective (inviscid) part of the numerical flux
+struct diffusive {};   ///< Diffusive (viscous) part of the numerical flux
+}  // namespace flux_part
+
 namespace time_integration {
 
 /// \name Tags for time integration
@@ -25,6 +40,192 @@ struct euler_forward {};
 struct runge_kutta_2 {};
 ///@}
 
+/// \brief Temporally blocked 2nd-order Runge-Kutta method
+///
+/// Same scheme as runge_kutta_2, but the internal cells are grouped into
+/// compact cache-sized tiles that go through both stages before the next
+/// tile is visited, such that the cells stream from memory once per step
+/// instead of once per stage. The first stage of a tile is also computed
+/// (redundantly) in a halo around the tile, which the second stage reads.
+///
+/// Optional properties:
+/// - tileSize: maximum #of cells of the finest level per tile (4096)
+/// - tileStencilRadius: #of neighbor layers the flux of a cell depends on,
+///   i.e. 1 for first order and 2 for linear reconstruction (2)
+struct tiled_runge_kutta_2 {};
+
+/// \brief 2N-storage (Williamson) explicit Runge-Kutta methods
+///
+/// Only two registers are needed: the solution q (lhs) and the stage
+/// increment dq (rhs). Each stage i = 0, ..., no_stages() - 1 performs:
+///
+///   dq = A(i) dq + dt L(q),    q = q + B(i) dq,
+///
+/// with A(0) = 0.
+struct low_storage_runge_kutta {};
+
+/// \brief Is \p T a 2N-storage Runge-Kutta method?
+template<class T> using is_low_storage
+= std::is_base_of<low_storage_runge_kutta, T>;
+
+/// \brief Strong-stability-preserving (SSP) explicit Runge-Kutta methods
+///
+/// Shu-Osher form in which each stage only combines the solution q^n at the
+/// beginning of the step and the last stage q. Each stage i = 0, ...,
+/// no_stages() - 1 performs:
+///
+///   dq = dt L(q),    q = alpha(i) q^n + (1 - alpha(i)) q + beta(i) dq,
+///
+/// where dq is stored in the rhs variables and q^n in a copy of the lhs.
+struct ssp_runge_kutta {};
+
+/// \brief Is \p T an SSP Runge-Kutta method in Shu-Osher form?
+template<class T> using is_ssp = std::is_base_of<ssp_runge_kutta, T>;
+
+/// \brief Third-order, 4-stage SSP Runge-Kutta method SSPRK(4,3)
+///
+/// Ketcheson, Highly efficient strong stability-preserving Runge-Kutta
+/// methods with low-storage implementations, SIAM J. Sci. Comput. 30 (2008).
+/// The SSP coefficient is C = 2, i.e. C / no_stages() = 0.5 per stage, so it
+/// preserves the bounds of Euler forward up to twice its time-step.
+struct ssp_runge_kutta_3 : ssp_runge_kutta {
+  static constexpr SInd no_stages() noexcept { return 4; }
+  static constexpr Num alpha(const SInd i) noexcept {
+    const Num a[] = {0., 0., 2. / 3., 0.};
+    return a[i];
+  }
+  static constexpr Num beta(const SInd i) noexcept {
+    const Num b[] = {0.5, 0.5, 1. / 6., 0.5};
+    return b[i];
+  }
+};
+
+/// \brief Fourth-order, 5-stage, 2N-storage Runge-Kutta method
+///
+/// Carpenter & Kennedy, Fourth-order 2N-storage Runge-Kutta schemes, NASA
+/// TM-109112 (1994), solution 3.
+struct runge_kutta_4 : low_storage_runge_kutta {
+  static constexpr SInd no_stages() noexcept { return 5; }
+  static constexpr Num A(const SInd i) noexcept {
+    const Num a[] = {
+      0.,
+      -567301805773. / 1357537059087.,
+      -2404267990393. / 2016746695238.,
+      -3550918686646. / 2091501179385.,
+      -1275806237668. / 842570457699.
+    };
+    return a[i];
+  }
+  static constexpr Num B(const SInd i) noexcept {
+    const Num b[] = {
+      1432997174477. / 9575080441755.,
+      5161836677717. / 13612068292357.,
+      1720146321549. / 2090206949498.,
+      3134564353537. / 4481467310338.,
+      2277821191437. / 14882151754819.
+    };
+    return b[i];
+  }
+};
+
+/// \brief Implicit time integration methods
+///
+/// Each step solves the nonlinear system of the method with a Jacobian-free
+/// Newton-Krylov method: GMRES with a block-Jacobi preconditioner built from
+/// the Jacobians of the cell fluxes w.r.t. the cell's own variables (see
+/// implicit::Settings).
+struct implicit_time_integration {};
+
+/// \brief Is \p T an implicit time integration method?
+template<class T> using is_implicit
+= std::is_base_of<implicit_time_integration, T>;
+
+/// \brief First-order backward Euler (BDF1)
+struct backward_euler : implicit_time_integration {
+  static constexpr SInd order() noexcept { return 1; }
+};
+
+/// \brief Second-order backward differentiation formula (variable step-size)
+///
+/// The first step, which lacks a previous solution, is a backward Euler step.
+struct bdf2 : implicit_time_integration {
+  static constexpr SInd order() noexcept { return 2; }
+};
+
+/// \brief Implicit theta-methods for linear physics, e.g. heat conduction
+///
+///   q^{n+1} - theta dt L(q^{n+1}) = q^n + (1 - theta) dt L(q^n)
+///
+/// The operator L must be affine, i.e. L(q) = A q + g, where g contains the
+/// boundary values (e.g. the Dirichlet and Neumann boundary conditions), and
+/// I - theta dt A must be symmetric positive definite. Each step solves a
+/// single linear system with the preconditioned conjugate gradient method
+/// in which the products with A are evaluated matrix-free as L(q) - L(0),
+/// and g is folded into the right-hand side.
+struct linear_implicit_time_integration {};
+
+/// \brief Is \p T an implicit method for linear physics?
+template<class T> using is_linear_implicit
+= std::is_base_of<linear_implicit_time_integration, T>;
+
+/// \brief First-order backward Euler method for linear physics
+struct linear_backward_euler : linear_implicit_time_integration {
+  static constexpr Num theta() noexcept { return 1.; }
+};
+
+/// \brief Second-order Crank-Nicolson method for linear physics
+///
+/// Note: stiff modes are barely damped (their amplification factor tends to
+/// -1 as dt grows).
+struct crank_nicolson : linear_implicit_time_integration {
+  static constexpr Num theta() noexcept { return 0.5; }
+};
+
+/// \brief Implicit-explicit (IMEX) Runge-Kutta methods
+///
+/// The convective part of the physics (and its source term) is integrated
+/// explicitly and its diffusive part implicitly, such that the time-step is
+/// only limited by the convective CFL condition. The implicit stages are
+/// solved with the Jacobian-free Newton-Krylov method of the implicit time
+/// integration methods (see implicit::Settings). The physics must split its
+/// numerical flux into parts (see flux_part).
+struct imex_time_integration {};
+
+/// \brief Is \p T an IMEX time integration method?
+template<class T> using is_imex = std::is_base_of<imex_time_integration, T>;
+
+/// \brief Second-order L-stable IMEX Runge-Kutta method ARS(2,2,2)
+///
+/// Ascher, Ruuth, Spiteri, Implicit-explicit Runge-Kutta methods for
+/// time-dependent partial differential equations, Appl. Numer. Math. 25, 1997.
+struct imex_runge_kutta_2 : imex_time_integration {
+  static Num gamma() noexcept { return 1. - 1. / std::sqrt(2.); }
+  static Num delta() noexcept { return 1. - 1. / (2. * gamma()); }
+};
+
+/// \brief Level-based local time stepping (1st-order Euler-Forward)
+///
+/// The solver time-step dt is that of the coarsest level l0: the cells at
+/// refinement level l take 2^(l - l0) substeps of dt / 2^(l - l0) per
+/// solution step (recursively, each level takes two substeps per step of the
+/// next coarser level). The fluxes across level interfaces are those of the
+/// fine cells, which are accumulated into the coarse cells during the fine
+/// substeps, such that the scheme is conservative.
+///
+/// Note: the grid is assumed to be 2:1 balanced.
+struct local_time_stepping {};
+
+/// \brief Pseudo-time stepping towards a steady state (1st-order Euler-Forward
+/// with local time-steps)
+///
+/// Every cell advances with its own time-step (see the physics' compute_dt)
+/// such that the solution is not time accurate: only its steady state is
+/// meaningful. The solver time-step dt is the minimum cell time-step, and
+/// the solver tracks the norm of the steady residual (see
+/// Solver::residual_norm). The numerical fluxes are computed with dt, such
+/// that both sides of a face see the same flux.
+struct pseudo_time_stepping {};
+
 }  // namespace time_integration
 
 ////////////////////////////////////////////////////////////////////////////////
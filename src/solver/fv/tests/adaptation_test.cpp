@@ -0,0 +1,200 @@
+/// \brief Tests for the error-estimator-driven grid adaptation
+/// Includes:
+#include <cmath>
+#include "solver/fv/advection.hpp"
+#include "solver/fv/utilities.hpp"
+#include "solver/fv/adaptation.hpp"
+/// External Includes:
+#include "misc/test.hpp"
+/// Options:
+#define ENABLE_DBG_ 0
+#include "misc/dbg.hpp"
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace hom3;
+namespace advection = solver::fv::advection;
+namespace adaptation = solver::fv::adaptation;
+
+static const SInd nd = 2;  ///< #of spatial dimensions
+static const SInd maxLevel = 6;  ///< Finest refinement level
+static const SInd minLevel = 3;  ///< Level of the initial uniform grid
+
+using Solver = advection::Solver<nd, advection::flux::upwind,
+                                 solver::fv::time_integration::euler_forward>;
+
+/// Root cell covering the domain [0,1] in each spatial dimension
+const auto rootCell = grid::RootCell<nd> {
+    NumA<nd>::Constant(0), NumA<nd>::Constant(1)
+};
+
+/// \brief Mesh generator that refines the grid uniformly up to minLevel (the
+/// grid capacity is that of a uniform grid at level)
+struct Coarse : grid::generation::Interface<Coarse> {
+  explicit Coarse(io::Properties) noexcept {}
+  template<class Grid> void generate_mesh(Grid& g) {
+    io::Properties uniform;
+    io::insert_property<Ind>(uniform, "level", minLevel);
+    grid::generation::MinLevel{uniform}(g);
+  }
+};
+
+grid::Grid<nd> coarse_grid() {
+  return grid::Grid<nd> {
+    grid::helpers::cube::properties<nd, Coarse>(rootCell, maxLevel)
+  };
+}
+
+/// \brief Gaussian pulse centered at (x0, 0.5) advected with unit velocity
+/// along x
+NumA<1> pulse(const NumA<nd> x, const Num x0) {
+  return NumA<1>::Constant
+      (1. + std::exp(-(x - NumA<nd>{x0, 0.5}).squaredNorm() / 0.005));
+}
+
+/// Integral of the pulse over the domain
+static const Num pulse_integral = 1. + math::pi * 0.005;
+
+/// \brief Creates an advection solver of the pulse on the grid \p g
+io::Properties properties(grid::Grid<nd>* g, const Num timeEnd) {
+  using InitialDomain = std::function<bool(const NumA<nd>)>;
+  using Velocity = std::function<NumA<nd>(NumA<nd>)>;
+  io::Properties p;
+  io::insert<grid::Grid<nd>*>(p, "grid", g);
+  io::insert<Ind>(p, "maxNoCells",
+                  grid::helpers::cube::no_solver_cells_with_gc<nd>(maxLevel));
+  io::insert<bool>(p, "restart", false);
+  io::insert<InitialDomain>(p, "initialDomain",
+                            [](const NumA<nd>) { return true; });
+  io::insert<Num>(p, "CFL", 0.5);
+  io::insert<Num>(p, "timeEnd", timeEnd);
+  io::insert<Velocity>(p, "velocity", [](const NumA<nd>) {
+    return NumA<nd>{1., 0.};
+  });
+  return p;
+}
+
+void setup(Solver& s) {
+  s.set_initial_condition([](const NumA<nd> x) { return pulse(x, 0.25); });
+  auto dBc = advection::bc::Dirichlet<Solver>{s, 1.0};
+  solver::fv::append_bcs(s, rootCell, std::make_tuple(dBc, dBc, dBc, dBc));
+}
+
+adaptation::Settings settings(const Ind maxNoCellsPerLevel
+                              = std::numeric_limits<Ind>::max()) {
+  io::Properties p;
+  io::insert<Ind>(p, "adaptationInterval", 4);
+  io::insert<Num>(p, "refineThreshold", 0.02);
+  io::insert<Num>(p, "coarsenThreshold", 0.005);
+  io::insert<SInd>(p, "minRefinementLevel", minLevel);
+  io::insert<SInd>(p, "maxRefinementLevel", maxLevel);
+  io::insert<Ind>(p, "maxNoCellsPerLevel", maxNoCellsPerLevel);
+  return adaptation::Settings{p};
+}
+
+/// \brief #of internal cells of the solver \p s at level \p l
+Ind no_cells_at_level(const Solver& s, const SInd l) {
+  Ind n = 0;
+  for (auto cIdx : s.internal_cells()) {
+    if (s.grid().level(s.node_idx(cIdx)) == l) { ++n; }
+  }
+  return n;
+}
+
+/// \brief Integral of the solution of the solver \p s
+Num total(const Solver& s) {
+  Num result = 0.;
+  for (auto cIdx : s.internal_cells()) {
+    result += s.Q<solver::fv::lhs_tag>(cIdx, 0)
+              * std::pow(s.cells().length(cIdx), nd);
+  }
+  return result;
+}
+
+/// \test the initial grid is refined around the pulse only
+TEST(adaptation, initial_grid) {
+  auto g = coarse_grid();
+  auto s = Solver{SolverIdx{0}, properties(&g, 0.1)};
+  setup(s);
+  solver::fv::initialize(g, s);
+  adaptation::adapt_initial_grid(s, adaptation::Lohner{}, settings());
+  EXPECT_EQ(g.level(g.find_leaf(NumA<nd>{0.25, 0.5})), maxLevel);
+  EXPECT_EQ(g.level(g.find_leaf(NumA<nd>{0.75, 0.5})), minLevel);
+  EXPECT_NEAR(total(s), pulse_integral, 1e-4);
+
+  // coarsening and refinement conserve the solution
+  const Num initialTotal = total(s);
+  const Ind noCells = s.no_internal_cells();
+  io::Properties p;
+  io::insert<Num>(p, "refineThreshold", 0.1);
+  io::insert<Num>(p, "coarsenThreshold", 0.05);
+  io::insert<SInd>(p, "maxRefinementLevel", maxLevel);
+  const auto result
+    = adaptation::adapt(s, adaptation::Lohner{}, adaptation::Settings{p});
+  EXPECT_GT(result.noCoarsened, 0);
+  EXPECT_LT(s.no_internal_cells(), noCells);
+  EXPECT_NEAR(total(s), initialTotal, 1e-12);
+}
+
+/// \test the grid follows the pulse: it is refined around the pulse and
+/// coarsened behind it, with far fewer cells than a uniform grid
+TEST(adaptation, tracks_advected_pulse) {
+  auto g = coarse_grid();
+  auto s = Solver{SolverIdx{0}, properties(&g, 0.4)};
+  setup(s);
+  solver::fv::run_solver(g, s, 10000, 10000, adaptation::Lohner{},
+                         settings());
+  EXPECT_EQ(g.level(g.find_leaf(NumA<nd>{0.65, 0.5})), maxLevel);
+  EXPECT_LT(g.level(g.find_leaf(NumA<nd>{0.25, 0.5})), maxLevel);
+  EXPECT_LT(s.no_internal_cells(),
+            grid::helpers::cube::no_leaf_nodes<nd>(maxLevel) / 3);
+  EXPECT_NEAR(total(s), pulse_integral, 1e-3);
+
+  // the pulse is resolved: its peak didn't decay much
+  Num peak = 0.;
+  for (auto cIdx : s.internal_cells()) {
+    peak = std::max(peak, s.Q<solver::fv::lhs_tag>(cIdx, 0));
+  }
+  EXPECT_GT(peak, 1.5);
+}
+
+/// \test the #of cells refined into each level is bounded by the budget
+TEST(adaptation, cell_budget) {
+  auto g = coarse_grid();
+  auto s = Solver{SolverIdx{0}, properties(&g, 0.1)};
+  setup(s);
+  solver::fv::initialize(g, s);
+  const Ind budget = 64;
+  adaptation::adapt_initial_grid(s, adaptation::GradientJump{},
+                                 settings(budget));
+  for (SInd l = minLevel + 1; l <= maxLevel; ++l) {
+    EXPECT_GT(no_cells_at_level(s, l), 0);
+    EXPECT_LE(no_cells_at_level(s, l), budget);
+  }
+}
+
+/// \test cells close to a geometry are refined to the finest level, combined
+/// with a solution estimator
+TEST(adaptation, geometry_proximity) {
+  auto g = coarse_grid();
+  auto s = Solver{SolverIdx{0}, properties(&g, 0.1)};
+  setup(s);
+  solver::fv::initialize(g, s);
+  auto circle = [](const NumA<nd>& x) {
+    return (x - NumA<nd>{0.7, 0.5}).matrix().norm() - 0.15;
+  };
+  const auto estimator = adaptation::max_of
+      (adaptation::GeometryProximity<nd>{1., circle}, adaptation::Lohner{});
+  adaptation::adapt_initial_grid(s, estimator, settings());
+  for (auto cIdx : s.internal_cells()) {
+    const NumA<nd> x = s.cells().x_center.row(cIdx).transpose();
+    if (std::abs(circle(x)) < 0.5 * s.cells().length(cIdx)) {
+      EXPECT_EQ(g.level(s.node_idx(cIdx)), maxLevel);
+    }
+  }
+  EXPECT_EQ(g.level(g.find_leaf(NumA<nd>{0.25, 0.5})), maxLevel);
+  EXPECT_EQ(g.level(g.find_leaf(NumA<nd>{0.5, 0.9})), minLevel);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+#undef ENABLE_DBG_
+////////////////////////////////////////////////////////////////////////////////
@@ -236,8 +236,7 @@ TEST(conjugate_heat_transfer_fv_solver, flow_past_solid_cube) {
     solver::fv::coupling::apply(Tr0, cnsSolver, heatSolver);
     write_timestep(cnsSolver, heatSolver);
 
-    cnsSolver.solve();
-    heatSolver.solve();
+    solver::fv::coupling::solve(cnsSolver, heatSolver);
 
     write_output(outputInterval, cnsSolver, heatSolver);
 
@@ -0,0 +1,51 @@
+#ifndef HOM3_SOLVERS_FV_TESTS_HELPERS_HPP_
+#define HOM3_SOLVERS_FV_TESTS_HELPERS_HPP_
+////////////////////////////////////////////////////////////////////////////////
+/// \file \brief Helpers for the finite volume solver unit-tests
+////////////////////////////////////////////////////////////////////////////////
+/// Includes:
+#include <vector>
+#include "grid/grid.hpp"
+/// Options:
+#define ENABLE_DBG_ 0
+#include "misc/dbg.hpp"
+////////////////////////////////////////////////////////////////////////////////
+namespace hom3 { namespace solver { namespace fv { namespace test {
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Mesh generator that refines the grid uniformly up to level - 1 and
+/// then once more in the half x < 0.5 of the domain, such that all level
+/// interfaces are normal to x
+struct LeftRefined : grid::generation::Interface<LeftRefined> {
+  const Ind level;
+  explicit LeftRefined(io::Properties input) noexcept
+  : level(io::read<Ind>(input, "level")) {}
+
+  template<class Grid> void generate_mesh(Grid& g) {
+    io::Properties coarse;
+    io::insert_property<Ind>(coarse, "level", level - 1);
+    grid::generation::MinLevel{coarse}(g);
+    std::vector<NodeIdx> leftLeafs;
+    for (auto nIdx : g.leaf_nodes()) {
+      if (g.cell_coordinates(nIdx)(0) < 0.5) { leftLeafs.push_back(nIdx); }
+    }
+    for (auto nIdx : leftLeafs) { g.refine_node(nIdx); }
+  }
+};
+
+/// \brief Leaf nodes of the grid \p g
+template<class Grid> std::vector<NodeIdx> leaf_nodes(const Grid& g) {
+  std::vector<NodeIdx> result;
+  for (auto nIdx : g.leaf_nodes()) { result.push_back(nIdx); }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+}  // namespace test
+}  // namespace fv
+}  // namespace solver
+}  // namespace hom3
+////////////////////////////////////////////////////////////////////////////////
+#undef ENABLE_DBG_
+////////////////////////////////////////////////////////////////////////////////
+#endif
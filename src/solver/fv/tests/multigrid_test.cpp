@@ -0,0 +1,157 @@
+/// \brief Tests for the geometric multigrid solver
+/// Includes:
+#include <cmath>
+#include "grid/grid.hpp"
+#include "grid/helpers.hpp"
+#include "solver/fv/implicit.hpp"
+#include "solver/fv/multigrid.hpp"
+#include "solver/fv/tests/helpers.hpp"
+/// External Includes:
+#include "misc/test.hpp"
+/// Options:
+#define ENABLE_DBG_ 0
+#include "misc/dbg.hpp"
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace hom3;
+using solver::fv::test::LeftRefined;
+using solver::fv::test::leaf_nodes;
+namespace multigrid = solver::fv::multigrid;
+
+static const SInd nd = 2;  ///< #of spatial dimensions
+
+/// Root cell covering the domain [0,1] in each spatial dimension
+const auto rootCell = grid::RootCell<nd> {
+    NumA<nd>::Constant(0), NumA<nd>::Constant(1)
+};
+
+/// \brief Solution of -div(grad(u)) = 2 pi^2 u with u = 0 at the boundaries
+Num sine(const NumA<nd> x) {
+  return std::sin(math::pi * x(0)) * std::sin(math::pi * x(1));
+}
+
+/// \brief Result of solve_poisson
+struct PoissonResult {
+  Ind cycles;   ///< #of cycles to reduce the residual by the tolerance
+  Num error;    ///< Maximum error of the solution
+  Num maxRate;  ///< Maximum residual reduction factor of a single cycle
+};
+
+/// \brief Solves the Poisson problem on \p g
+template<class Grid>
+PoissonResult solve_poisson(const Grid& g, const Ind cycleIndex) {
+  io::Properties properties;
+  io::insert_property<Ind>(properties, "cycleIndex", cycleIndex);
+  const auto nodes = leaf_nodes(g);
+  auto mg = multigrid::Multigrid {
+    g, nodes, multigrid::Operator{0., 1., true}, multigrid::Settings{properties}
+  };
+  NumV f(nodes.size()), u = NumV::Zero(nodes.size());
+  for (Ind i = 0, e = nodes.size(); i != e; ++i) {
+    f(i) = 2. * std::pow(math::pi, 2) * sine(g.cell_coordinates(nodes[i]));
+  }
+  PoissonResult result{mg.solve(f, u), 0., 0.};
+  for (Ind i = 0, e = nodes.size(); i != e; ++i) {
+    const Num error = std::abs(u(i) - sine(g.cell_coordinates(nodes[i])));
+    result.error = std::max(result.error, error);
+  }
+
+  NumV v = NumV::Zero(nodes.size());
+  Num residual = mg.residual_norm(f, v);
+  for (Ind c = 0; c != result.cycles; ++c) {
+    mg.cycle(f, v);
+    const Num newResidual = mg.residual_norm(f, v);
+    result.maxRate = std::max(result.maxRate, newResidual / residual);
+    residual = newResidual;
+  }
+  return result;
+}
+
+/// \test the #of cycles and the convergence rate per cycle are bounded
+/// independently of the resolution (11 V-cycles / 6 W-cycles with a rate of
+/// ~0.18 / ~0.11 at all levels, while with injection the rate grows as
+/// 0.26, 0.37, 0.55), and the solution converges with second order
+TEST(multigrid, poisson_dirichlet) {
+  const Ind maxCycles[] = {0, 12, 7};
+  const Num maxRate[] = {0., 0.25, 0.15};
+  Num previousError = 0.;
+  for (SInd level : {5, 6, 7}) {
+    auto g = grid::Grid<nd> {
+      grid::helpers::cube::properties<nd>(rootCell, level), grid::initialize
+    };
+    for (Ind cycleIndex : {1, 2}) {
+      const auto result = solve_poisson(g, cycleIndex);
+      EXPECT_LE(result.cycles, maxCycles[cycleIndex]);
+      EXPECT_LT(result.maxRate, maxRate[cycleIndex]);
+      if (cycleIndex == 1) {
+        if (previousError > 0.) {
+          EXPECT_LT(result.error, 0.3 * previousError);
+        }
+        previousError = result.error;
+      }
+    }
+  }
+}
+
+/// \test multigrid on grids with a refinement level interface converges
+/// independently of the resolution
+TEST(multigrid, poisson_refined) {
+  for (SInd level : {5, 6, 7}) {
+    auto g = grid::Grid<nd> {
+      grid::helpers::cube::properties<nd, LeftRefined>(rootCell, level),
+      grid::initialize
+    };
+    const auto result = solve_poisson(g, 1);
+    EXPECT_LE(result.cycles, 11);
+    EXPECT_LT(result.maxRate, 0.22);
+    EXPECT_LT(result.error, 1e-2);
+  }
+}
+
+/// \test full multigrid gets close to the solution in a single pass, and a
+/// cycle preconditions the conjugate gradient method for the implicit heat
+/// conduction system
+TEST(multigrid, fmg_and_preconditioner) {
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, 6), grid::initialize
+  };
+  const auto nodes = leaf_nodes(g);
+  const Ind n = nodes.size();
+  const Num dt = 0.01;
+  auto mg = multigrid::Multigrid {
+    g, nodes, multigrid::Operator{1., dt, false},
+    multigrid::Settings{io::Properties{}}
+  };
+
+  NumV b(n), u(n);
+  for (Ind i = 0; i != n; ++i) {
+    b(i) = 1. + sine(g.cell_coordinates(nodes[i]));
+  }
+  mg.fmg(b, u);
+  EXPECT_LT(mg.residual_norm(b, u), 0.1 * mg.residual_norm(b, NumV::Zero(n)));
+
+  auto A = [&](const NumV& v, NumV& result) { mg.apply(v, result); };
+  NumV diagonal(n), unit = NumV::Zero(n), column(n);
+  for (Ind i = 0; i != n; ++i) {
+    unit(i) = 1.;
+    mg.apply(unit, column);
+    diagonal(i) = column(i);
+    unit(i) = 0.;
+  }
+  auto jacobi = [&](const NumV& v, NumV& result) {
+    result = v.cwiseQuotient(diagonal);
+  };
+  NumV x = NumV::Zero(n);
+  const Ind jacobiIterations
+    = solver::fv::implicit::conjugate_gradient(A, jacobi, b, x, 1e-10, 1000);
+  NumV y = NumV::Zero(n);
+  const Ind multigridIterations
+    = solver::fv::implicit::conjugate_gradient(A, mg, b, y, 1e-10, 1000);
+  EXPECT_LT(multigridIterations, jacobiIterations);
+  EXPECT_LE(multigridIterations, 10);
+  EXPECT_LT((x - y).cwiseAbs().maxCoeff(), 1e-8);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+#undef ENABLE_DBG_
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,194 @@
+/// \brief Tests for the Parareal parallel-in-time integration
+/// Includes:
+#include <cmath>
+#include <memory>
+#include "solver/fv/heat.hpp"
+#include "solver/fv/advection.hpp"
+#include "solver/fv/utilities.hpp"
+#include "solver/fv/parareal.hpp"
+/// External Includes:
+#include "misc/test.hpp"
+/// Options:
+#define ENABLE_DBG_ 0
+#include "misc/dbg.hpp"
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace hom3;
+namespace ti = solver::fv::time_integration;
+namespace parareal = solver::fv::parareal;
+
+static const SInd noSlices = 8;  ///< #of time slices
+static const Num timeEnd = 0.08;
+
+/// \brief Times of the slice boundaries
+std::vector<Num> slice_times() {
+  std::vector<Num> times;
+  for (SInd n = 0; n <= noSlices; ++n) {
+    times.push_back(timeEnd * n / noSlices);
+  }
+  return times;
+}
+
+/// \brief Creates the properties of a solver on the \p grid
+template<SInd nd>
+io::Properties properties(grid::Grid<nd>* grid, const SInd level,
+                          const Num cfl) {
+  using InitialDomain = std::function<bool(const NumA<nd>)>;
+  io::Properties p;
+  io::insert<grid::Grid<nd>*>(p, "grid", grid);
+  io::insert<Ind>(p, "maxNoCells",
+                  grid::helpers::cube::no_solver_cells_with_gc<nd>(level));
+  io::insert<bool>(p, "restart", false);
+  io::insert<InitialDomain>(p, "initialDomain",
+                            [](const NumA<nd>) { return true; });
+  io::insert<Num>(p, "CFL", cfl);
+  io::insert<Num>(p, "timeEnd", timeEnd);
+  return p;
+}
+
+/// \brief Solves the Parareal iteration with the \p coarse solver (one step
+/// per slice) and the \p fine solvers up to the \p tolerance, and compares
+/// it with the serial fine solution
+///
+/// The iteration must stop by the tolerance, i.e. before the #of slices
+/// iterations after which it reproduces the serial solution anyway.
+///
+/// \returns the #of iterations
+template<class CoarseSolver, class FineSolver>
+Ind parareal_vs_serial(CoarseSolver& coarse,
+                       std::vector<std::unique_ptr<FineSolver>>& fine,
+                       const Num tolerance) {
+  const auto times = slice_times();
+  using Propagator = parareal::SolverPropagator<FineSolver>;
+  std::vector<Propagator> finePropagators;
+  for (auto& s : fine) { finePropagators.push_back(Propagator{*s}); }
+  auto coarsePropagator
+    = parareal::make_propagator(coarse, times[1] - times[0]);
+
+  const NumV u0 = fine.front()->state();
+  io::Properties settings;
+  io::insert<Num>(settings, "pararealTolerance", tolerance);
+  io::insert<Ind>(settings, "pararealMaxIterations", noSlices);
+  const auto result = parareal::solve(coarsePropagator, finePropagators, u0,
+                                      times, parareal::Settings{settings});
+  EXPECT_LT(result.iterations, noSlices);
+
+  NumV serial = u0;
+  for (SInd n = 0; n != noSlices; ++n) {
+    serial = finePropagators[n](serial, times[n], times[n + 1]);
+    EXPECT_LT((result.states[n + 1] - serial).cwiseAbs().maxCoeff(),
+              10. * tolerance);
+  }
+  // the coarse solution alone is far from the serial solution
+  NumV coarseOnly = u0;
+  for (SInd n = 0; n != noSlices; ++n) {
+    coarseOnly = coarsePropagator(coarseOnly, times[n], times[n + 1]);
+  }
+  EXPECT_GT((coarseOnly - serial).cwiseAbs().maxCoeff(), 1e-4);
+  return result.iterations;
+}
+
+/// \test Parareal with an implicit coarse propagator converges to the serial
+/// solution of the heat equation in fewer iterations than time slices (the
+/// error drops by about 4x per iteration)
+TEST(parareal, heat) {
+  static const SInd nd = 3;
+  namespace heat = solver::fv::heat;
+  using FineSolver = heat::Solver<nd, heat::flux::three_point,
+                                  ti::euler_forward>;
+  using CoarseSolver = heat::Solver<nd, heat::flux::three_point,
+                                    ti::linear_backward_euler>;
+  const SInd level = 4;
+  const auto rootCell = grid::RootCell<nd> {
+    NumA<nd>::Constant(0), NumA<nd>::Constant(1)
+  };
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, level, noSlices + 1)
+  };
+  auto heat_properties = [&]() {
+    using namespace quantity;
+    auto p = properties<nd>(&g, level, 0.5);
+    io::insert<Temperature>(p, "T_ref", 273.15 * unit::kelvin);
+    io::insert<ThermalDiffusivity>(p, "diffusivity", 1.0 * unit::meter
+                                   * unit::meter / unit::second);
+    return p;
+  };
+  auto setup = [&](auto& s) {
+    using Solver = std::remove_reference_t<decltype(s)>;
+    s.set_initial_condition([](const NumA<nd> x) {
+      const Num q = 1. + std::sin(math::pi * x(0))
+                    + 0.5 * std::sin(3. * math::pi * x(0));
+      return NumA<Solver::nvars>::Constant(q);
+    });
+    auto dBc = heat::bc::Dirichlet<Solver>{s, 1.0};
+    auto nBc = heat::bc::Neumann<Solver>{s, 0.0};
+    solver::fv::append_bcs(s, rootCell,
+                           std::make_tuple(dBc, dBc, nBc, nBc, nBc, nBc));
+  };
+
+  auto coarse = CoarseSolver{SolverIdx{0}, heat_properties()};
+  setup(coarse);
+  std::vector<std::unique_ptr<FineSolver>> fine;
+  for (SInd n = 0; n != noSlices; ++n) {
+    fine.emplace_back(std::make_unique<FineSolver>
+                      (SolverIdx{n + 1}, heat_properties()));
+    setup(*fine.back());
+  }
+  solver::fv::initialize(g, coarse);
+  for (auto& s : fine) { solver::fv::initialize(*s); }
+
+  EXPECT_LT(parareal_vs_serial(coarse, fine, 1e-4), noSlices);
+}
+
+/// \test Parareal converges to the serial solution of the advection equation
+/// in fewer iterations than time slices (6 of 8, the error dropping slowly
+/// for the hyperbolic equation)
+TEST(parareal, advection) {
+  static const SInd nd = 2;
+  namespace advection = solver::fv::advection;
+  using FineSolver = advection::Solver<nd, advection::flux::upwind,
+                                       ti::euler_forward>;
+  using CoarseSolver = advection::Solver<nd, advection::flux::upwind,
+                                         ti::backward_euler>;
+  using Velocity = std::function<NumA<nd>(NumA<nd>)>;
+  const SInd level = 5;
+  const auto rootCell = grid::RootCell<nd> {
+    NumA<nd>::Constant(0), NumA<nd>::Constant(1)
+  };
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, level, noSlices + 1)
+  };
+  auto advection_properties = [&]() {
+    auto p = properties<nd>(&g, level, 0.5);
+    io::insert<Velocity>(p, "velocity", [](const NumA<nd>) {
+      return NumA<nd>{1., 0.};
+    });
+    return p;
+  };
+  auto setup = [&](auto& s) {
+    using Solver = std::remove_reference_t<decltype(s)>;
+    s.set_initial_condition([](const NumA<nd> x) {
+      return NumA<Solver::nvars>::Constant
+          (1. + std::exp(-(x - NumA<nd>{0.3, 0.5}).squaredNorm() / 0.01));
+    });
+    auto dBc = advection::bc::Dirichlet<Solver>{s, 1.0};
+    solver::fv::append_bcs(s, rootCell, std::make_tuple(dBc, dBc, dBc, dBc));
+  };
+
+  auto coarse = CoarseSolver{SolverIdx{0}, advection_properties()};
+  setup(coarse);
+  std::vector<std::unique_ptr<FineSolver>> fine;
+  for (SInd n = 0; n != noSlices; ++n) {
+    fine.emplace_back(std::make_unique<FineSolver>
+                      (SolverIdx{n + 1}, advection_properties()));
+    setup(*fine.back());
+  }
+  solver::fv::initialize(g, coarse);
+  for (auto& s : fine) { solver::fv::initialize(*s); }
+
+  EXPECT_LT(parareal_vs_serial(coarse, fine, 1e-6), noSlices);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+#undef ENABLE_DBG_
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,167 @@
+/// \brief Tests for the block-structured leaf patches
+/// Includes:
+#include <cmath>
+#include "grid/grid.hpp"
+#include "grid/helpers.hpp"
+#include "solver/fv/patches.hpp"
+#include "solver/fv/tests/helpers.hpp"
+/// External Includes:
+#include "misc/test.hpp"
+/// Options:
+#define ENABLE_DBG_ 0
+#include "misc/dbg.hpp"
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace hom3;
+using solver::fv::test::LeftRefined;
+using solver::fv::test::leaf_nodes;
+namespace patches = solver::fv::patches;
+
+static const SInd nd = 2;  ///< #of spatial dimensions
+static const SInd k = 4;   ///< #of cells per patch along each direction
+
+using Patches = patches::Patches<nd, k, 1>;
+
+/// Root cell covering the domain [0,1] in each spatial dimension
+const auto rootCell = grid::RootCell<nd> {
+    NumA<nd>::Constant(0), NumA<nd>::Constant(1)
+};
+
+/// \brief Dirichlet boundary u = 0 at the boundary faces
+NumA<1> zero_boundary(const NumA<nd>&, const NumA<1>& qInside) {
+  return -qInside;
+}
+
+/// \test explicit diffusion with the regular patch stencil matches the same
+/// stencil on the equivalent uniform grid
+TEST(patches, uniform_diffusion) {
+  const SInd level = 3;
+  const Ind n = (1 << level) * k;  // #of cells along each direction
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd>(rootCell, level), grid::initialize
+  };
+  auto u = Patches{g, leaf_nodes(g)};
+  EXPECT_EQ(u.size() * Patches::no_cells(), n * n);
+
+  auto initial = [](const NumA<nd> x) {
+    return std::sin(math::pi * x(0)) * std::sin(2. * math::pi * x(1)) + x(0);
+  };
+  for (Ind p = 0; p != u.size(); ++p) {
+    for (SInd j = 0; j != k; ++j) {
+      for (SInd i = 0; i != k; ++i) {
+        const SIndA<nd> c{i, j};
+        u(p, 0, Patches::index(c)) = initial(u.x_center(p, c));
+      }
+    }
+  }
+  // reference: uniform array of n^2 cells with a ghost layer
+  const Num h = 1. / n;
+  EXPECT_NEAR(u.cell_length(0), h, 1e-15);
+  NumM<Eigen::Dynamic> ref(n + 2, n + 2);
+  for (Ind j = 0; j != n; ++j) {
+    for (Ind i = 0; i != n; ++i) {
+      ref(i + 1, j + 1) = initial(NumA<nd>{(i + 0.5) * h, (j + 0.5) * h});
+    }
+  }
+
+  const Num alpha = 0.2;  // diffusivity dt / h^2
+  for (Ind step = 0; step != 10; ++step) {
+    u.exchange_halos(zero_boundary);
+    auto next = u;
+    for (Ind p = 0; p != u.size(); ++p) {
+      const Num* q = u(p, 0);
+      Num* qn = next(p, 0);
+      Patches::for_each_row([&](const Ind first) {
+        for (Ind i = first; i != first + k; ++i) {
+          qn[i] = q[i] + alpha * (q[i - 1] + q[i + 1]
+                                  + q[i - Patches::stride(1)]
+                                  + q[i + Patches::stride(1)] - 4. * q[i]);
+        }
+      });
+    }
+    u = next;
+
+    for (Ind i = 1; i != n + 1; ++i) {
+      ref(0, i) = -ref(1, i);
+      ref(n + 1, i) = -ref(n, i);
+      ref(i, 0) = -ref(i, 1);
+      ref(i, n + 1) = -ref(i, n);
+    }
+    NumM<Eigen::Dynamic> refNext = ref;
+    for (Ind j = 1; j != n + 1; ++j) {
+      for (Ind i = 1; i != n + 1; ++i) {
+        refNext(i, j) = ref(i, j) + alpha * (ref(i - 1, j) + ref(i + 1, j)
+                                             + ref(i, j - 1) + ref(i, j + 1)
+                                             - 4. * ref(i, j));
+      }
+    }
+    ref = refNext;
+  }
+
+  for (Ind p = 0; p != u.size(); ++p) {
+    for (SInd j = 0; j != k; ++j) {
+      for (SInd i = 0; i != k; ++i) {
+        const SIndA<nd> c{i, j};
+        const NumA<nd> x = u.x_center(p, c);
+        const Ind ri = std::floor(x(0) / h) + 1, rj = std::floor(x(1) / h) + 1;
+        EXPECT_NEAR(u(p, 0, Patches::index(c)), ref(ri, rj), 1e-13);
+      }
+    }
+  }
+}
+
+/// \test halos across a refinement level interface: the fine halos contain
+/// the coarse cell values, and the coarse halos the average of the fine cells
+TEST(patches, level_interface_halos) {
+  const SInd level = 3;
+  auto g = grid::Grid<nd> {
+    grid::helpers::cube::properties<nd, LeftRefined>(rootCell, level),
+    grid::initialize
+  };
+  auto u = Patches{g, leaf_nodes(g)};
+  auto linear = [](const NumA<nd> x) { return 1. + 2. * x(0) - 3. * x(1); };
+  for (Ind p = 0; p != u.size(); ++p) {
+    for (SInd j = 0; j != k; ++j) {
+      for (SInd i = 0; i != k; ++i) {
+        const SIndA<nd> c{i, j};
+        u(p, 0, Patches::index(c)) = linear(u.x_center(p, c));
+      }
+    }
+  }
+  u.exchange_halos(zero_boundary);
+
+  Ind noCoarser = 0, noFiner = 0;
+  for (Ind p = 0; p != u.size(); ++p) {
+    for (SInd pos = 0; pos != 2 * nd; ++pos) {
+      const auto kind = u.neighbor(p, pos);
+      if (kind == patches::Neighbor::boundary) { continue; }
+      const SInd d = pos / 2;
+      for (SInd i = 0; i != k; ++i) {
+        SIndA<nd> c;
+        c(d) = pos % 2 ? k : -1;
+        c(1 - d) = i;
+        const NumA<nd> x = u.x_center(p, c);
+        Num expected = linear(x);
+        if (kind == patches::Neighbor::coarser) {
+          // center of the coarse cell containing the halo cell
+          const Num H = 2. * u.cell_length(p);
+          NumA<nd> xCoarse;
+          for (SInd dd = 0; dd != nd; ++dd) {
+            xCoarse(dd) = (std::floor(x(dd) / H) + 0.5) * H;
+          }
+          expected = linear(xCoarse);
+          ++noCoarser;
+        } else if (kind == patches::Neighbor::finer) {
+          ++noFiner;
+        }
+        EXPECT_NEAR(u(p, 0, Patches::index(c)), expected, 1e-13);
+      }
+    }
+  }
+  EXPECT_EQ(noCoarser, (1 << level) * k);
+  EXPECT_EQ(noFiner, (1 << (level - 1)) * k);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+#undef ENABLE_DBG_
+////////////////////////////////////////////////////////////////////////////////
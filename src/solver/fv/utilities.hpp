@@ -4,10 +4,14 @@
 /// \brief This file collects some finite volume utilitie functions that are
 /// helpful for creating, runing, and managing FV solvers.
 ////////////////////////////////////////////////////////////////////////////////
+#include <cmath>
+#include <type_traits>
 #include "globals.hpp"
 #include "grid/grid.hpp"
 #include "grid/helpers.hpp"
 #include "solver.hpp"
+#include "particles.hpp"
+#include "adaptation.hpp"
 ////////////////////////////////////////////////////////////////////////////////
 namespace hom3 { namespace solver { namespace fv {
 
@@ -94,16 +98,74 @@ inline void write_timestep(const Solver& solver,
   write_timestep(solvers...);
 }
 
+/// \brief Writes the residual information of \p solver, whose residual norm
+/// at the first step was \p initialResidual
+template<class Solver>
+inline void write_residual(const Solver& solver,
+                           const Num initialResidual) noexcept {
+  std::cerr << "Solver: " << solver.domain_name() << " | "
+            << "step: " << solver.step() << " | "
+            << "residual: " << solver.residual_norm() << " | "
+            << "drop: " << solver.residual_norm() / initialResidual << "\n";
+}
+
+/// \brief Advances the \p solver and the \p particles advected by its
+/// solution by a single step (the particles use the velocity field at the
+/// beginning and at the end of the step)
+template<class Solver, class Particles>
+inline void solve(Solver& solver, Particles& particles) noexcept {
+  particles.begin_step();
+  solver.solve();
+  particles.evolve(solver.dt());
+}
+
 /// \brief Runs solver \p solver on the grid \p grid.
+///
+/// The solver's probe sets (if any) are sampled at their own intervals.
 template<class Grid, class Solver> void run_solver
 (Grid& grid, Solver& solver, const Ind maxNoTimeSteps,
   const Ind outputInterval) noexcept {
   initialize(grid, solver);
   write_domains(grid, solver);
+  write_probes(solver);
+  while (!solver_finished(maxNoTimeSteps, solver)) {
+    write_timestep(solver);
+    solver.solve();
+    write_output(outputInterval, solver);
+    write_probes(solver);
+    if (solution_diverged(solver)) {
+      write_domains(solver);
+      TERMINATE("Solution diverged!");
+    }
+  }
+  write_domain(solver);
+}
+
+/// \brief Runs solver \p solver on the grid \p grid, adapting the grid to the
+/// \p estimator every settings.interval steps (see adaptation::adapt).
+///
+/// The initial grid is adapted to the initial condition before the first step.
+/// The solver must be the only one on the grid.
+template<class Grid, class Solver, class Estimator> void run_solver
+(Grid& grid, Solver& solver, const Ind maxNoTimeSteps,
+ const Ind outputInterval, Estimator&& estimator,
+ const adaptation::Settings& settings) noexcept {
+  initialize(grid, solver);
+  adaptation::adapt_initial_grid(solver, estimator, settings);
+  write_domains(grid, solver);
+  write_probes(solver);
   while (!solver_finished(maxNoTimeSteps, solver)) {
     write_timestep(solver);
     solver.solve();
+    if (solver.step() % settings.interval == 0) {
+      const auto result = adaptation::adapt(solver, estimator, settings);
+      std::cerr << "Solver: " << solver.domain_name() << " | "
+                << "refined: " << result.noRefined << " | "
+                << "coarsened: " << result.noCoarsened << " | "
+                << "#of cells: " << solver.no_internal_cells() << "\n";
+    }
     write_output(outputInterval, solver);
+    write_probes(solver);
     if (solution_diverged(solver)) {
       write_domains(solver);
       TERMINATE("Solution diverged!");
@@ -112,6 +174,41 @@ template<class Grid, class Solver> void run_solver
   write_domain(solver);
 }
 
+/// \brief Runs solver \p solver on the grid \p grid towards a steady state,
+/// until its residual norm drops by \p residualDrop w.r.t. that of the first
+/// step, or for at most \p maxNoSteps steps.
+///
+/// The solver must use pseudo-time stepping (see
+/// time_integration::pseudo_time_stepping).
+///
+/// \returns true if the solution converged
+template<class Grid, class Solver> bool run_steady
+(Grid& grid, Solver& solver, const Ind maxNoSteps, const Ind outputInterval,
+ const Num residualDrop) noexcept {
+  static_assert(std::is_same<typename Solver::time_integration_type,
+                             time_integration::pseudo_time_stepping>::value,
+                "steady runs require pseudo-time stepping!");
+  initialize(grid, solver);
+  write_domains(grid, solver);
+  write_probes(solver);
+  Num initialResidual = 0.;
+  bool converged = false;
+  while (!converged && solver.step() < maxNoSteps) {
+    solver.solve();
+    if (solver.step() == 1) { initialResidual = solver.residual_norm(); }
+    write_residual(solver, initialResidual);
+    write_output(outputInterval, solver);
+    write_probes(solver);
+    if (solution_diverged(solver) || std::isnan(solver.residual_norm())) {
+      write_domains(solver);
+      TERMINATE("Solution diverged!");
+    }
+    converged = solver.residual_norm() <= residualDrop * initialResidual;
+  }
+  write_domain(solver);
+  return converged;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 }  // namespace fv
 }  // namespace solver